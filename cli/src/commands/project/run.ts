@@ -23,7 +23,7 @@ class RunHandler extends CommandHandlerWithUpdateCheck {
     private globalKeypressHandler?: (str: string, key: any) => void;
     private ctrlDKeypressHandler?: (str: string, key: any) => void;
 
-    constructor(protected projectConfigHandler: ProjectConfigHandler, deviceName?: string) {
+    constructor(protected projectConfigHandler: ProjectConfigHandler, deviceName?: string, samplingFile?: string) {
         super();
 
         const boardName = this.projectConfigHandler.getBoardName();
@@ -38,6 +38,7 @@ class RunHandler extends CommandHandlerWithUpdateCheck {
                 logger.error("Disconnected.");
                 process.exit(1);
             },
+            samplingFile,
         );
     }
 
@@ -290,17 +291,17 @@ class RunWithNotebookHandler extends RunHandler {
 }
 
 export async function handleRunCommand(
-    options: {withRepl: boolean, withNotebook: boolean, deviceName?: string}
+    options: {withRepl: boolean, withNotebook: boolean, deviceName?: string, sampling?: string}
 ) {
     let handler: RunHandler | undefined;
     try {
         const projectConfigHandler = ProjectConfigHandler.load(cwd());
         if (options.withRepl) {
-            handler = new RunWithReplHandler(projectConfigHandler, options.deviceName);
+            handler = new RunWithReplHandler(projectConfigHandler, options.deviceName, options.sampling);
         } else if (options.withNotebook) {
-            handler = new RunWithNotebookHandler(projectConfigHandler, options.deviceName);
+            handler = new RunWithNotebookHandler(projectConfigHandler, options.deviceName, options.sampling);
         } else {
-            handler = new RunHandler(projectConfigHandler, options.deviceName);
+            handler = new RunHandler(projectConfigHandler, options.deviceName, options.sampling);
         }
 
         await handler.run();
@@ -326,6 +327,7 @@ export function registerRunCommand(program: Command) {
         .command('run')
         .description('run your project')
         .option('-d, --device-name <device-name>', `device name to connect to, the default is '${DEFAULT_DEVICE_NAME}'`)
+        .option('--sampling <file>', 'write a flat profile by the sampling profiler to the file (host board only)')
         .addOption(
             new Option('--with-repl', 'start REPL after main execution finished')
             .conflicts('withNotebook')
@@ -17,6 +17,10 @@ export const PROJECT_DEFAULT_PATHS = {
     PACKAGES_DIR: './packages',
 }
 
+// The directory of the libraries shipped with the runtime.  A program imports
+// the library in <runtime>/libs/<name> by its name without declaring a dependency.
+export const RUNTIME_LIBS_DIR = 'libs';
+
 const baseConfigSchema = z.object({
     projectName: z.string(),
     version: z.string().default(DEfAULT_PROJECT_VERSION),
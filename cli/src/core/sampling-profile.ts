@@ -0,0 +1,35 @@
+import { FunctionSamples } from "../services/host-protocol";
+import * as fs from "./fs";
+
+/**
+ * The samples taken by the sampling profiler of the host board.
+ * It is a flat profile since only the function running at each sample is recorded, not its callers.
+ * Every line is "entry;function count", where entry is the name of the entry point
+ * of a REPL cell or a project run, and count is the number of samples taken
+ * while the function was running during that entry.
+ */
+export class SamplingProfile {
+    private counts = new Map<string, number>();
+
+    add(entryName: string, samples: FunctionSamples[]) {
+        for (const s of samples) {
+            const key = `${entryName};${s.name}`;
+            this.counts.set(key, (this.counts.get(key) ?? 0) + s.count);
+        }
+    }
+
+    isEmpty() {
+        return this.counts.size === 0;
+    }
+
+    toFlatProfile(): string {
+        let text = '';
+        for (const [key, count] of this.counts)
+            text += `${key} ${count}\n`;
+        return text;
+    }
+
+    write(path: string) {
+        fs.writeFile(path, this.toFlatProfile());
+    }
+}
@@ -12,6 +12,7 @@ export abstract class HostEnv extends BoardEnv {
     get shellCFile() { return path.join(this.runtimeDir, 'ports/host/shell.c'); }
     get runtimeCFile() { return path.join(this.runtimeDir, 'core/src/c-runtime.c'); }
     get commCFile() { return path.join(this.runtimeDir, 'ports/host/comm.c'); }
+    get samplerCFile() { return path.join(this.runtimeDir, 'core/src/sampler.c'); }
 
     abstract get shellFile(): string;
     abstract buildHostRuntime(): Promise<void>;
@@ -56,7 +57,7 @@ export class HostUnixEnv extends HostEnv {
             await simpleExec(this.gccCommandName, [
                 '-DLINUX64', '-O2',
                 '-o', this.shellFile,
-                this.shellCFile, this.runtimeSoFile,
+                this.shellCFile, this.samplerCFile, this.runtimeSoFile,
                 '-lm', '-ldl',
             ]);
         } catch(error) {
@@ -1,5 +1,5 @@
 import { GlobalConfigHandler, Esp32BoardConfig } from "../../config/global-config";
-import { ProjectConfigHandler, PROJECT_DEFAULT_PATHS } from "../../config/project-config";
+import { ProjectConfigHandler, PROJECT_DEFAULT_PATHS, RUNTIME_LIBS_DIR } from "../../config/project-config";
 import { BoardName } from "../../config/board-utils";
 import {
     CompilerSession, MemoryImage, MemoryLayout,
@@ -7,6 +7,7 @@ import {
 } from "@bscript/lang";
 import { CompilerAdapter, CompileContext } from "./compiler-adapter";
 import * as path from 'path';
+import * as fs from '../../core/fs';
 
 
 const DUMMY_MEMORY_LAYOUT: MemoryLayout = {
@@ -41,11 +42,13 @@ export class Esp32CompilerAdapter implements CompilerAdapter {
         if (!memoryLayout) {
             throw new Error('Memory layout is required to build an ESP32 project.');
         }
+        const compilerConfig = this.getCompilerConfig();
         const project = Project.load<PackageForEsp32>(
             this.projectConfigHandler.getConfig().projectName,
             createEsp32PackageReader(this.boardName, this.projectConfigHandler),
+            createEsp32LibraryReader(compilerConfig.runtimeDir),
         );
-        const toolchain = new Esp32Toolchain(this.getCompilerConfig(), memoryLayout);
+        const toolchain = new Esp32Toolchain(compilerConfig, memoryLayout);
         this.compiler = new CompilerSession(toolchain);
         return this.compiler.buildProject(project);
     }
@@ -102,4 +105,26 @@ function createEsp32PackageReader(
             throw new Error(`Failed to read ${name}.`, { cause: error });
         }
     };
-}
\ No newline at end of file
+}
+
+function createEsp32LibraryReader(runtimeDir: string): (name: string) => PackageForEsp32 | undefined {
+    return (name: string) => {
+        const root = path.join(runtimeDir, RUNTIME_LIBS_DIR, name);
+        if (!fs.exists(path.join(root, PROJECT_DEFAULT_PATHS.ENTRY_FILE))) {
+            return undefined;
+        }
+        return new PackageForEsp32(
+            name,
+            {
+                rootDir: root,
+                entry: PROJECT_DEFAULT_PATHS.ENTRY_FILE,
+                sourceDir: PROJECT_DEFAULT_PATHS.SRC_DIR,
+                distDir: PROJECT_DEFAULT_PATHS.DIST_DIR,
+                buildDir: PROJECT_DEFAULT_PATHS.BUILD_DIR,
+                packageDir: PROJECT_DEFAULT_PATHS.PACKAGES_DIR,
+            },
+            [],
+            [],
+        );
+    };
+}
@@ -1,5 +1,5 @@
 import { GlobalConfigHandler, HostBoardConfig } from "../../config/global-config";
-import { ProjectConfigHandler, PROJECT_DEFAULT_PATHS } from "../../config/project-config";
+import { ProjectConfigHandler, PROJECT_DEFAULT_PATHS, RUNTIME_LIBS_DIR } from "../../config/project-config";
 import { BoardName } from "../../config/board-utils";
 import {
     CompilerSession, SharedLibrary,
@@ -8,6 +8,7 @@ import {
 import { CompilerAdapter, CompileContext } from "./compiler-adapter";
 import * as path from 'path';
 import * as os from 'os';
+import * as fs from '../../core/fs';
 
 
 type HostPackageClass = typeof PackageForHostUnix | typeof PackageForHostWindows;
@@ -43,6 +44,7 @@ export class HostCompilerAdapter implements CompilerAdapter {
             const project = Project.load<PackageForHostUnix>(
                 this.projectConfigHandler.getConfig().projectName,
                 createHostPackageReader(this.projectConfigHandler, PackageForHostUnix),
+                createHostLibraryReader(runtimeDir, PackageForHostUnix),
             );
             const toolchain = new HostUnixToolchain(compilerConfig);
             this.compiler = new CompilerSession(toolchain);
@@ -53,6 +55,7 @@ export class HostCompilerAdapter implements CompilerAdapter {
             const project = Project.load<PackageForHostWindows>(
                 this.projectConfigHandler.getConfig().projectName,
                 createHostPackageReader(this.projectConfigHandler, PackageForHostWindows),
+                createHostLibraryReader(runtimeDir, PackageForHostWindows),
             );
             const toolchain = new HostWindowsToolchain(compilerConfig);
             this.compiler = new CompilerSession(toolchain);
@@ -109,3 +112,27 @@ function createHostPackageReader<T extends HostPackageClass>(
         }
     };
 }
+
+function createHostLibraryReader<T extends HostPackageClass>(
+    runtimeDir: string,
+    PackageClass: T,
+): (name: string) => InstanceType<T> | undefined {
+    return (name: string) => {
+        const root = path.join(runtimeDir, RUNTIME_LIBS_DIR, name);
+        if (!fs.exists(path.join(root, PROJECT_DEFAULT_PATHS.ENTRY_FILE))) {
+            return undefined;
+        }
+        return new PackageClass(
+            name,
+            {
+                rootDir: root,
+                entry: PROJECT_DEFAULT_PATHS.ENTRY_FILE,
+                sourceDir: PROJECT_DEFAULT_PATHS.SRC_DIR,
+                distDir: PROJECT_DEFAULT_PATHS.DIST_DIR,
+                buildDir: PROJECT_DEFAULT_PATHS.BUILD_DIR,
+                packageDir: PROJECT_DEFAULT_PATHS.PACKAGES_DIR,
+            },
+            [],
+        ) as InstanceType<T>;
+    };
+}
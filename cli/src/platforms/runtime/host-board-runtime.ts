@@ -5,20 +5,29 @@ import { BoardRuntime } from "./board-runtime";
 import { CompileContext } from "../compiler/compiler-adapter";
 import { HostBoardConfig } from "../../config/global-config";
 import { HostService, ProcessConnection } from '../../services/process';
+import { SamplingProfile } from '../../core/sampling-profile';
+import { logger } from '../../core/logger';
+
+const SAMPLING_INTERVAL_US = 1000;
 
 
 export class HostBoardRuntime implements BoardRuntime<SharedLibrary> {
     private programOutput: ProgramOutput;
     private shellProcess: ProcessConnection;
     private hostService: HostService;
+    private samplingProfile?: SamplingProfile;
+    private entryName = '';     // the entry point being executed
 
+    // samplingFile: the file where the samples by the sampling profiler are written.
     constructor(
         private boardConfig: HostBoardConfig,
         programOutput: ProgramOutput,
         private onUnexpectedDisconnect?: () => void,
+        private samplingFile?: string,
     ) {
         this.programOutput = programOutput;
-        this.shellProcess = new ProcessConnection(this.getShellPath());
+        const env = samplingFile ? { BS_SAMPLING_INTERVAL: String(SAMPLING_INTERVAL_US) } : {};
+        this.shellProcess = new ProcessConnection(this.getShellPath(), env);
         this.shellProcess.on('disconnected', (code) => {
             if (code !== 0) {
                 this.onUnexpectedDisconnect?.();
@@ -35,10 +44,20 @@ export class HostBoardRuntime implements BoardRuntime<SharedLibrary> {
         this.hostService.on('error', (message) => {
             this.programOutput.writeError(message);
         });
+        if (this.samplingFile) {
+            const profile = this.samplingProfile = new SamplingProfile();
+            this.hostService.on('samples', (samples) => {
+                profile.add(this.entryName, samples);
+            });
+        }
     }
 
     async disconnect(): Promise<void> {
         await this.shellProcess.disconnect();
+        if (this.samplingFile && this.samplingProfile && !this.samplingProfile.isEmpty()) {
+            this.samplingProfile.write(this.samplingFile);
+            logger.info(`The samples were written to ${this.samplingFile}.`);
+        }
     }
 
     async prepare(): Promise<CompileContext> {
@@ -52,6 +71,7 @@ export class HostBoardRuntime implements BoardRuntime<SharedLibrary> {
     async execute(output: SharedLibrary): Promise<number> {
         let exectime = 0;
         for (const entry of output.entryNames) {
+            this.entryName = entry.name;
             exectime += await this.hostService.execute(entry.name);
         }
         return exectime;
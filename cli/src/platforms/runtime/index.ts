@@ -15,7 +15,11 @@ export function getBoardRuntime(
     programOutput: ProgramOutput,
     deviceName?: string,
     onUnexpectedDisconnect?: () => void,
+    samplingFile?: string,
 ): BoardRuntime {
+    if (samplingFile !== undefined && boardName !== 'host') {
+        throw new Error('The sampling profiler is available only on the host board.');
+    }
     if (boardName === 'esp32') {
         const _deviceName = deviceName ?? DEFAULT_DEVICE_NAME;
         return new Esp32BoardRuntime(_deviceName, programOutput, onUnexpectedDisconnect);
@@ -25,7 +29,7 @@ export function getBoardRuntime(
         if (!boardConfig) {
             throw new Error('The environment for host is not set up.');
         }
-        return new HostBoardRuntime(boardConfig, programOutput, onUnexpectedDisconnect);
+        return new HostBoardRuntime(boardConfig, programOutput, onUnexpectedDisconnect, samplingFile);
     }
     throw new Error(`Unsupported board name: ${boardName}`);
 }
@@ -11,12 +11,15 @@ const MTU = 495;
 export type DeviceServiceEvents = {
     log: (message: string) => void;
     error: (message: string) => void;
-    profile: (fid: number, paramtypes: string[]) => void;
+    profile: (fid: number, paramtypes: string[], returntype: string | undefined, megamorphic: boolean) => void;
+    versionhits: (fid: number, version: number, hits: number) => void;
     exectime: (id: number, time: number) => void;
     memory: (layout: MemoryLayout) => void;
 };
 
 export class DeviceService extends Service<DeviceServiceEvents, Buffer> {
+    private parser = new ProtocolParser();
+
     constructor(connection: BleConnection) {
         super("device", connection);
         this.connection.on("receiveData", (data) => {
@@ -67,7 +70,7 @@ export class DeviceService extends Service<DeviceServiceEvents, Buffer> {
     }
 
     private handleReceivedData(data: Buffer) {
-        const parseResult = new ProtocolParser().parse(data);
+        const parseResult = this.parser.parse(data);
         switch (parseResult.protocol) {
             case Protocol.Log:
                 this.handleMessage("log", [parseResult.log]);
@@ -76,12 +79,16 @@ export class DeviceService extends Service<DeviceServiceEvents, Buffer> {
                 this.handleMessage("error", [parseResult.error]);
                 break;
             case Protocol.Profile:
-                this.handleMessage("profile", [parseResult.fid, parseResult.paramtypes]);
+                for (const p of parseResult.profiles)
+                    this.handleMessage("profile", [p.fid, p.paramtypes, p.returntype, p.megamorphic]);
+                for (const h of parseResult.hits)
+                    this.handleMessage("versionhits", [h.fid, h.version, h.hits]);
                 break;
             case Protocol.Exectime:
                 this.handleMessage("exectime", [parseResult.id, parseResult.time]);
                 break;
             case Protocol.Memory:
+                this.parser.resetClassNames();
                 this.handleMessage("memory", [parseResult.layout]);
         }
     }
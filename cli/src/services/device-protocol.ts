@@ -168,9 +168,23 @@ type ProtocolPayloads = {
     [Protocol.Error]: { error: string };
     [Protocol.Memory]: { layout: MemoryLayout };
     [Protocol.Exectime]: { id: number; time: number };
-    [Protocol.Profile]: { fid: number; paramtypes: string[] };
+    [Protocol.Profile]: { profiles: FunctionProfile[]; hits: VersionHits[] };
 }
 
+export type FunctionProfile = { fid: number; paramtypes: string[]; returntype?: string; megamorphic: boolean };
+
+// the number of calls to a specialized version of a function.
+export type VersionHits = { fid: number; version: number; hits: number };
+
+// Profile records.  See microcontroller/core/src/profiler.c.
+const PROFILE_RECORD = 0;
+const CLASS_RECORD = 1;
+const HITS_RECORD = 2;
+const RECORD_MEGAMORPHIC = 1;
+const RECORD_RETURN = 2;
+const PRIMITIVE_TYPE_NAMES = ["integer", "float", "boolean", "undefined"];
+const TYPE_ID_ANY = 0xff;
+
 export type ParseResult<T extends Protocol = Protocol> = {
     [K in T]: { protocol: K } & ProtocolPayloads[K]
 }[T];
@@ -179,6 +193,7 @@ type ParserFunction<K extends Protocol> = (buffer: Buffer, offset: number) => Pr
 
 export class ProtocolParser {
     private readonly parsers: {[K in Protocol]?: ParserFunction<K>};
+    private classNames = new Map<number, string>();     // class ids in profile records
 
     constructor() {
         this.parsers = {
@@ -186,7 +201,7 @@ export class ProtocolParser {
             [Protocol.Error]: ProtocolParser.parseError,
             [Protocol.Memory]: ProtocolParser.parseMemory,
             [Protocol.Exectime]: ProtocolParser.parseExectime,
-            [Protocol.Profile]: ProtocolParser.parseProfile,
+            [Protocol.Profile]: (buffer, offset) => this.parseProfile(buffer, offset),
         }
     }
 
@@ -240,10 +255,56 @@ export class ProtocolParser {
         return { id, time };
     }
 
-    static parseProfile(buffer: Buffer, offset: number): {fid:number, paramtypes:string[]} {
-        const fid = buffer.readUInt8(offset); offset += 1;
-        const textDecoder = new TextDecoder();
-        const paramStr = textDecoder.decode(buffer.subarray(offset, buffer.length - 1));
-        return { fid, paramtypes: paramStr ? paramStr.split(", ") : [] };
+    // The class ids are reset when the device is reset.
+    public resetClassNames() {
+        this.classNames.clear();
+    }
+
+    // | PROFILE_RECORD | fid | n | flags | type id * n | return type id (if RECORD_RETURN) |
+    // | CLASS_RECORD | type id | length | class name (length bytes) |
+    // | HITS_RECORD | fid | version | hits (2 bytes) |
+    parseProfile(buffer: Buffer, offset: number): {profiles: FunctionProfile[], hits: VersionHits[]} {
+        const profiles: FunctionProfile[] = [];
+        const hits: VersionHits[] = [];
+        while (offset < buffer.length) {
+            const kind = buffer.readUInt8(offset);
+            if (kind === CLASS_RECORD) {
+                const id = buffer.readUInt8(offset + 1);
+                const len = buffer.readUInt8(offset + 2);
+                this.classNames.set(id, buffer.toString('utf-8', offset + 3, offset + 3 + len));
+                offset += 3 + len;
+            } else if (kind === PROFILE_RECORD) {
+                const fid = buffer.readUInt8(offset + 1);
+                const n = buffer.readUInt8(offset + 2);
+                const flags = buffer.readUInt8(offset + 3);
+                offset += 4;
+                const paramtypes: string[] = [];
+                for (let i = 0; i < n; i++)
+                    paramtypes.push(this.typeName(buffer.readUInt8(offset++)));
+
+                const returntype = flags & RECORD_RETURN ? this.typeName(buffer.readUInt8(offset++)) : undefined;
+                profiles.push({ fid, paramtypes, returntype, megamorphic: (flags & RECORD_MEGAMORPHIC) !== 0 });
+            } else if (kind === HITS_RECORD) {
+                const fid = buffer.readUInt8(offset + 1);
+                const version = buffer.readUInt8(offset + 2);
+                hits.push({ fid, version, hits: buffer.readUInt16LE(offset + 3) });
+                offset += 5;
+            } else {
+                throw new Error(`Failed to parse a profile record. Unknown record: ${kind}`);
+            }
+        }
+        return { profiles, hits };
+    }
+
+    private typeName(id: number) {
+        if (id < PRIMITIVE_TYPE_NAMES.length)
+            return PRIMITIVE_TYPE_NAMES[id];
+        else if (id === TYPE_ID_ANY)
+            return "any";
+
+        const name = this.classNames.get(id);
+        if (name === undefined)
+            throw new Error(`Failed to parse a profile record. Unknown class id: ${id}`);
+        return name;
     }
 }
\ No newline at end of file
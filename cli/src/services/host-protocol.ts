@@ -7,6 +7,7 @@ export enum HostProtocol {
     Error = 4,
     Exectime = 5,
     Loadtime = 6,
+    Samples = 7,
     Max
 }
 
@@ -33,9 +34,13 @@ type HostProtocolPayloads = {
     [HostProtocol.Error]: { error: string };
     [HostProtocol.Exectime]: { time: number };
     [HostProtocol.Loadtime]: { time: number };
+    [HostProtocol.Samples]: { samples: FunctionSamples[] };
     [HostProtocol.Max]: {};
 }
 
+// the number of the samples taken while a function is running.
+export type FunctionSamples = { name: string, count: number };
+
 export type HostParseResult<T extends HostProtocol = HostProtocol> = {
     [K in T]: { protocol: K } & HostProtocolPayloads[K]
 }[T];
@@ -51,6 +56,7 @@ export class HostProtocolParser {
             [HostProtocol.Error]: HostProtocolParser.parseError,
             [HostProtocol.Exectime]: HostProtocolParser.parseExectime,
             [HostProtocol.Loadtime]: HostProtocolParser.parseLoadtime,
+            [HostProtocol.Samples]: HostProtocolParser.parseSamples,
         }
     }
 
@@ -106,4 +112,13 @@ export class HostProtocolParser {
     static parseLoadtime(payload: string): { time: number } {
         return { time: Number(payload) };
     }
+
+    // The payload is "name:count,name:count,...".
+    static parseSamples(payload: string): { samples: FunctionSamples[] } {
+        const samples = payload.split(',').filter(e => e.length > 0).map(e => {
+            const i = e.lastIndexOf(':');
+            return { name: e.substring(0, i), count: Number(e.substring(i + 1)) };
+        });
+        return { samples };
+    }
 }
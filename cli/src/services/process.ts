@@ -1,6 +1,6 @@
 import { logger } from "../core/logger";
 import { Connection, ConnectionMessage, Service } from "./common";
-import { hostProtocolBuilder, HostProtocolParser, HostProtocol, HostParseResult } from "./host-protocol";
+import { hostProtocolBuilder, HostProtocolParser, HostProtocol, HostParseResult, FunctionSamples } from "./host-protocol";
 import { ChildProcessWithoutNullStreams, spawn } from 'node:child_process';
 
 
@@ -9,6 +9,7 @@ export type HostServiceEvents = {
     error: (message: string) => void;
     exectime: (time: number) => void;
     loadtime: (time: number) => void;
+    samples: (samples: FunctionSamples[]) => void;
 }
 
 export class HostService extends Service<HostServiceEvents, string> {
@@ -88,6 +89,9 @@ class HostMessageQueue {
                 case HostProtocol.Loadtime:
                     this.service.handleMessage('loadtime', [message.time]);
                     break;
+                case HostProtocol.Samples:
+                    this.service.handleMessage('samples', [message.samples]);
+                    break;
                 default:
                     throw new Error("Unexpected error.");
             }
@@ -108,13 +112,14 @@ export class ProcessConnection extends Connection<String> {
     private disconnecting = false;
 
 
-    constructor(shellFile: string) {
+    // env: the environment variables added when the shell process is spawned.
+    constructor(shellFile: string, private env: NodeJS.ProcessEnv = {}) {
         super();
         this.shellFile = shellFile;
     }
 
     public async connect(): Promise<void> {
-        this.shellProcess = spawn(this.shellFile);
+        this.shellProcess = spawn(this.shellFile, [], { env: { ...process.env, ...this.env } });
         this.shellProcess.on('exit', (code) => {
             if (this.disconnecting) {
                 return;
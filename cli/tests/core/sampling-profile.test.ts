@@ -0,0 +1,24 @@
+import { SamplingProfile } from '../../src/core/sampling-profile'
+
+
+describe('SamplingProfile', () => {
+    test('should be empty without samples', () => {
+        const profile = new SamplingProfile();
+        profile.add('bluescript_main6_', []);
+        expect(profile.isEmpty()).toBe(true);
+        expect(profile.toFlatProfile()).toBe('');
+    });
+
+    test('should write a line per entry and function', () => {
+        const profile = new SamplingProfile();
+        profile.add('bluescript_main6_', [{ name: 'fib', count: 30 }, { name: 'gc_run', count: 2 }]);
+        profile.add('bluescript_main7_', [{ name: 'fib', count: 5 }]);
+        profile.add('bluescript_main6_', [{ name: 'fib', count: 10 }]);
+        expect(profile.isEmpty()).toBe(false);
+        expect(profile.toFlatProfile()).toBe(
+            'bluescript_main6_;fib 40\n' +
+            'bluescript_main6_;gc_run 2\n' +
+            'bluescript_main7_;fib 5\n'
+        );
+    });
+});
@@ -1,4 +1,4 @@
-import { ProtocolPacketBuilder, Protocol } from '../../src/services/device-protocol'
+import { ProtocolPacketBuilder, ProtocolParser, Protocol } from '../../src/services/device-protocol'
 
 
 const BUFFER_SIZE =  17;
@@ -80,4 +80,40 @@ describe('ProtocolPacketBuilder', () => {
         ]);
         expect(builder.build()).toEqual([expectedBuffer1, expectedBuffer2]);
     })
-})
\ No newline at end of file
+})
+
+describe('ProtocolParser', () => {
+    test('should parse profile records', () => {
+        const parser = new ProtocolParser();
+        const buffer = Buffer.from([
+            Protocol.Profile,
+            0x01, 0x04, 0x06, ...Buffer.from('string'),    // class record
+            0x00, 0x03, 0x02, 0x02, 0x04, 0x00, 0xff,       // profile record with a return type
+            0x00, 0x05, 0x01, 0x00, 0x04,                   // profile record
+            0x00, 0x06, 0x00, 0x01,                         // megamorphic
+            0x02, 0x03, 0x01, 0x00, 0x04,                   // hits record
+        ]);
+        expect(parser.parse(buffer)).toEqual({
+            protocol: Protocol.Profile,
+            profiles: [
+                { fid: 3, paramtypes: ['string', 'integer'], returntype: 'any', megamorphic: false },
+                { fid: 5, paramtypes: ['string'], returntype: undefined, megamorphic: false },
+                { fid: 6, paramtypes: [], returntype: undefined, megamorphic: true },
+            ],
+            hits: [{ fid: 3, version: 1, hits: 1024 }],
+        });
+    });
+
+    test('should remember class ids until reset', () => {
+        const parser = new ProtocolParser();
+        parser.parse(Buffer.from([Protocol.Profile, 0x01, 0x04, 0x01, ...Buffer.from('A')]));
+        const profile = Buffer.from([Protocol.Profile, 0x00, 0x00, 0x01, 0x00, 0x04]);
+        expect(parser.parse(profile)).toEqual({
+            protocol: Protocol.Profile,
+            profiles: [{ fid: 0, paramtypes: ['A'], returntype: undefined, megamorphic: false }],
+            hits: [],
+        });
+        parser.resetClassNames();
+        expect(() => parser.parse(profile)).toThrow(/Unknown class id/);
+    });
+});
@@ -0,0 +1,42 @@
+import { HostProtocol, HostProtocolParser } from '../../src/services/host-protocol'
+
+
+describe('HostProtocolParser', () => {
+    test('should parse samples', () => {
+        const parser = new HostProtocolParser();
+        const message = '07 0059 bluescript_main6_:12,fib:30,(other functions):4,(dropped):2';
+        expect(parser.parse(message)).toEqual({
+            parsed: [{
+                protocol: HostProtocol.Samples,
+                samples: [
+                    { name: 'bluescript_main6_', count: 12 },
+                    { name: 'fib', count: 30 },
+                    { name: '(other functions)', count: 4 },
+                    { name: '(dropped)', count: 2 },
+                ],
+            }],
+            remain: '',
+        });
+    });
+
+    test('should parse samples sent in several messages', () => {
+        const parser = new HostProtocolParser();
+        const { parsed, remain } = parser.parse('07 0011 foo:1,bar:205 0003 1.507 0005 ba');
+        expect(parsed).toEqual([
+            { protocol: HostProtocol.Samples, samples: [{ name: 'foo', count: 1 }, { name: 'bar', count: 2 }] },
+            { protocol: HostProtocol.Exectime, time: 1.5 },
+        ]);
+        expect(remain).toBe('07 0005 ba');
+        expect(parser.parse(remain + 'z:3').parsed).toEqual([
+            { protocol: HostProtocol.Samples, samples: [{ name: 'baz', count: 3 }] },
+        ]);
+    });
+
+    test('should parse empty samples', () => {
+        expect(HostProtocolParser.parseSamples('')).toEqual({ samples: [] });
+    });
+
+    test('should parse a function name including a colon', () => {
+        expect(HostProtocolParser.parseSamples('a:b:4')).toEqual({ samples: [{ name: 'a:b', count: 4 }] });
+    });
+});
@@ -5,10 +5,13 @@ export class Project<P extends Package = Package> {
 	public readonly mainPackage: P;
 	public readonly dependencies: Map<string, P>;
     private usedDependenciesMap = new Map<string, P>();
+    private libraries = new Map<string, P>();
+    private libraryReader?: (name: string) => P | undefined;
     
-    protected constructor(mainPackage: P, dependencies: Map<string, P>) {
+    protected constructor(mainPackage: P, dependencies: Map<string, P>, libraryReader?: (name: string) => P | undefined) {
         this.mainPackage = mainPackage;
         this.dependencies = dependencies;
+        this.libraryReader = libraryReader;
     }
 
     get usedDependencies() {
@@ -17,7 +20,8 @@ export class Project<P extends Package = Package> {
 
     static load<P extends Package>(
         mainPackageName: string,
-        packageReader: (name: string) => P
+        packageReader: (name: string) => P,
+        libraryReader?: (name: string) => P | undefined
     ) {
         const mainPackage = packageReader(mainPackageName);
         const dependencies = new Map<string, P>();
@@ -37,7 +41,24 @@ export class Project<P extends Package = Package> {
             }
         }
 
-        return new Project<P>(mainPackage, dependencies);
+        return new Project<P>(mainPackage, dependencies, libraryReader);
+    }
+
+    // Finds the package imported by the given name.  When no dependency has that name,
+    // a library shipped with the runtime is read by libraryReader, if any.
+    // A library is read when it is imported for the first time.
+    findPackage(name: string): P | undefined {
+        const pkg = this.dependencies.get(name) ?? this.libraries.get(name);
+        if (pkg !== undefined || this.libraryReader === undefined) {
+            return pkg;
+        }
+
+        const lib = this.libraryReader(name);
+        if (lib !== undefined) {
+            lib.clean();
+            this.libraries.set(name, lib);
+        }
+        return lib;
     }
 
     clean() {
@@ -45,6 +66,9 @@ export class Project<P extends Package = Package> {
         for (const dep of this.dependencies.values()) {
             dep.clean();
         }
+        for (const lib of this.libraries.values()) {
+            lib.clean();
+        }
     }
 
     check() {
@@ -76,7 +76,7 @@ export class TranspilerSession {
 
     private makeImporter(currentPath: PathInPkg, entryPoints: string[], project: Project) {
         return (name: string): GlobalVariableNameTable => {
-            const newPath = this.resolveImport(currentPath, name, project.dependencies);
+            const newPath = this.resolveImport(currentPath, name, project);
             const mod = this.modules.get(newPath.absolutePath);
             project.addUsedDependency(newPath.pkg);
             if (mod)
@@ -98,14 +98,14 @@ export class TranspilerSession {
         }
     }
 
-    private resolveImport(currentPath: PathInPkg, importName: string, dependencies: Map<string, Package>): PathInPkg {
+    private resolveImport(currentPath: PathInPkg, importName: string, project: Project): PathInPkg {
         if (path.isAbsolute(importName)) {
             throw new Error("This module system does not support importing from absolute paths.");
         } else if (importName.startsWith('.')) { // move in package
             return currentPath.resolve(importName + '.bs');
         } else { // move to new package
             const [pkgName, ...remain] = importName.split('/');
-            const pkg = dependencies.get(pkgName);
+            const pkg = project.findPackage(pkgName);
             if (pkg === undefined) {
                 throw new Error(`Cannot fine package. Package name: ${pkgName}`);
             }
@@ -1,8 +1,8 @@
 import {CodeGenerator} from "../transpiler/code-generator/code-generator";
 import {
-  callCounterName,
-  FunctionProfile, maxParamNum, profileFunctionName,
-  Profiler, typeProfilerName
+  callCounterName, countHitsFunctionName,
+  FunctionProfile, maxParamNum, profileFunctionName, profileReturnFunctionName,
+  Profiler, SpecializedVersion, typeProfilerName, versionHitsName
 } from "./profiler";
 import {
   FunctionEnv,
@@ -27,7 +27,7 @@ import {FunctionDeclaration} from "@babel/types";
 import * as cr from "../transpiler/code-generator/c-runtime";
 import {getStaticType, NameInfo, NameTableMaker} from "../transpiler/names";
 import {jitTypecheck, JitTypeChecker} from "./jit-type-checker";
-import {getSpecializedNode, ProfileError} from "./utils";
+import {getSpecializedNodes, ProfileError, SpecializedNode} from "./utils";
 import {InstanceType} from "../transpiler/classes";
 import {classNameInC} from "../transpiler/code-generator/c-runtime";
 
@@ -61,12 +61,12 @@ function originalFunctionBodyName(name: string) {
   return `original_${cr.functionBodyName(name)}`;
 }
 
-function specializedFunctionName(name: string) {
-  return `specialized${name}`;
+function specializedFunctionName(name: string, version: number) {
+  return `specialized${version}${name}`;
 }
 
-function specializedFunctionBodyName(name: string) {
-  return `specialized_${cr.functionBodyName(name)}`;
+function specializedFunctionBodyName(name: string, version: number) {
+  return `specialized${version}_${cr.functionBodyName(name)}`;
 }
 
 
@@ -134,8 +134,6 @@ export class JitCodeGenerator extends CodeGenerator{
     }
     const originalFuncName = originalFunctionName(funcName)
     const originalFuncBodyName = originalFunctionBodyName(funcName)
-    const specializedFuncName = specializedFunctionName(funcName);
-    const specializedFuncBodyName = specializedFunctionBodyName(funcName);
 
     switch (funcProfile.state.state) {
       case 'profiling':
@@ -145,13 +143,12 @@ export class JitCodeGenerator extends CodeGenerator{
           this.wrapperFunctionBodyDeclaration(node, funcName, false, funcProfile, fenv)
         break
       case 'specializing': {
-        const specializedNode = getSpecializedNode(node);
-        if (specializedNode === undefined)
-          throw new ProfileError(`Cannot find specialized node. Node: ${node}`)
-        const specializedFenv = new FunctionEnv(getVariableNameTable(specializedNode), env)
-        this.functionBodyDeclaration2(specializedNode, specializedFuncName, specializedFuncBodyName, specializedFenv, false)
+        // only the new versions are compiled.  The wrapper is replaced with the one selecting a version.
+        for (const specialized of this.specializedNodes(node))
+          this.specializedFunctionBodyDeclaration(specialized, funcName, env, false)
         this.wrapperFunctionBodyDeclaration(node, funcName, true, funcProfile, fenv)
-        this.profiler.setFunctionState(name, {state: 'specialized', type: funcProfile.state.type})
+        funcProfile.versions.forEach(v => v.compiled = true)
+        this.profiler.setFunctionState(name, {state: 'specialized'})
         break
       }
       case 'undoing':
@@ -160,21 +157,31 @@ export class JitCodeGenerator extends CodeGenerator{
         this.result.nl().write(`${funcName}.${cr.functionPtr} = ${originalFuncBodyName};`).nl()
         this.profiler.setFunctionState(name, {state: 'unspecialized'})
         break
-      case 'specialized': {
-        const specializedNode = getSpecializedNode(node);
-        if (specializedNode === undefined)
-          throw new ProfileError(`Cannot find specialized node. Node: ${node}`)
-        const specializedFenv = new FunctionEnv(getVariableNameTable(specializedNode), env)
-        this.functionBodyDeclaration2(specializedNode, specializedFuncName, specializedFuncBodyName, specializedFenv, true)
+      case 'specialized':
+        for (const specialized of this.specializedNodes(node))
+          this.specializedFunctionBodyDeclaration(specialized, funcName, env, true)
         this.functionBodyDeclaration2(node, originalFuncName, originalFuncBodyName, fenv, true)
         break
-      }
       case 'unspecialized':
         this.functionBodyDeclaration2(node, funcName, cr.functionBodyName(funcName), fenv, true)
         break
     }
   }
 
+  private specializedNodes(node: AST.FunctionDeclaration) {
+    const specializedNodes = getSpecializedNodes(node);
+    if (specializedNodes === undefined)
+      throw new ProfileError(`Cannot find specialized node. Node: ${node}`)
+    return specializedNodes
+  }
+
+  private specializedFunctionBodyDeclaration(specialized: SpecializedNode, funcName: string, env: VariableEnv,
+                                             isFreeVariable: boolean) {
+    const specializedFenv = new FunctionEnv(getVariableNameTable(specialized.node), env)
+    this.functionBodyDeclaration2(specialized.node, specializedFunctionName(funcName, specialized.version),
+                                  specializedFunctionBodyName(funcName, specialized.version), specializedFenv, isFreeVariable)
+  }
+
   private functionBodyDeclaration2(node: AST.FunctionDeclaration, funcName: string, bodyName: string, fenv: FunctionEnv,
                            isFreeVariable: boolean) {
     fenv.allocateRootSet()
@@ -204,7 +211,7 @@ export class JitCodeGenerator extends CodeGenerator{
     if (funcProfile.state.state === 'profiling')
       this.wrapperFunctionBodyForProfiling(node, fenv, funcType, funcName, funcProfile.id)
     else if (funcProfile.state.state === 'specializing')
-      this.wrapperFunctionBodyForSpecializing(node, fenv, funcType, funcName, funcProfile.state.type)
+      this.wrapperFunctionBodyForSpecializing(node, fenv, funcType, funcName, funcProfile)
     this.result = prevResult
 
     this.signatures += this.makeFunctionStruct(wrapperFuncName, funcType, false)
@@ -219,51 +226,56 @@ export class JitCodeGenerator extends CodeGenerator{
                                           funcType: FunctionType, funcName: string, funcProfileId: number,
                                           modifier: string = 'static ') {
     const wrapperBodyName = cr.functionBodyName(funcName)
-    const originalFuncName = originalFunctionName(funcName)
     const bodyResult = this.result.copy()
     const sig = this.makeParameterList(funcType, node, fenv, bodyResult)
     this.result.write(`${modifier}${cr.typeToCType(funcType.returnType, wrapperBodyName)}${sig}`).write(' {')
     this.result.right().nl();
 
     this.functionProfiling(node, fenv, funcType, funcProfileId);
+    this.originalFunctionCall(node, fenv, funcType, funcName);
 
-    this.result.write('return ');
-    this.functionCall(node, fenv, originalFuncName, funcType, funcType.paramTypes, 'self')
     this.result.left().nl();
     this.result.write('}').nl();
   }
 
+  /* The wrapper selects a specialized version by checking the types of the arguments.
+     The versions called more often are checked earlier.  If no version is selected,
+     the original function is called and the argument types are profiled again
+     so that another version can be added, unless the function is megamorphic.
+  */
   private wrapperFunctionBodyForSpecializing(node: AST.FunctionDeclaration, fenv: FunctionEnv,
-                                             funcType: FunctionType, funcName: string, specializedType: FunctionType,
+                                             funcType: FunctionType, funcName: string, funcProfile: FunctionProfile,
                                              modifier: string = 'static ') {
     const wrapperBodyName = cr.functionBodyName(funcName)
     const originalFuncName = originalFunctionName(funcName)
-    const specializedFuncName = specializedFunctionName(funcName)
+    const versions = [...funcProfile.versions].sort((a, b) => b.hits - a.hits || a.version - b.version)
     const bodyResult = this.result.copy()
     const sig = this.makeParameterList(funcType, node, fenv, bodyResult)
     this.result.write(`${modifier}${cr.typeToCType(funcType.returnType, wrapperBodyName)}${sig}`).write(' {')
     this.result.right().nl();
 
-    this.result.write('if (')
-    this.parameterCheck(node, fenv, funcType.paramTypes, specializedType.paramTypes)
-    this.result.write(') {')
-    this.result.right().nl()
-
-    // For test
-    this.result.write(`#ifdef LINUX64`).nl().write('puts("Execute specialized function");').nl().write('#endif').nl()
-
-    this.result.write('return ');
-    this.functionCall(node, fenv, specializedFuncName, specializedType, funcType.paramTypes, 'self')
-
-    this.result.left().nl()
-    this.result.write('} else {')
+    this.result.write(`static uint16_t ${versionHitsName}[${versions.length}] = { 0 };`).nl()
+    versions.forEach((v, i) => {
+      this.result.write(i === 0 ? 'if (' : ' else if (')
+      this.parameterCheck(node, fenv, funcType.paramTypes, v.type.paramTypes)
+      this.result.write(') {')
+      this.result.right().nl()
+      this.specializedFunctionCall(node, fenv, funcType, funcName, funcProfile.id, v, i)
+      this.result.left().nl()
+      this.result.write('}')
+    })
+
+    this.result.write(' else {')
     this.result.right().nl()
 
     // For test
     this.result.write(`#ifdef LINUX64`).nl().write('puts("Execute original function");').nl().write('#endif').nl()
 
-    this.result.write('return ');
-    this.functionCall(node, fenv, originalFuncName, funcType, funcType.paramTypes, 'self')
+    const profiled = !funcProfile.megamorphic
+    if (profiled)
+      this.functionProfiling(node, fenv, funcType, funcProfile.id);
+
+    this.originalFunctionCall(node, fenv, funcType, funcName, profiled);
     this.signatures += this.makeFunctionStruct(originalFuncName, funcType, false)
 
     this.result.left().nl()
@@ -273,23 +285,48 @@ export class JitCodeGenerator extends CodeGenerator{
     this.result.write('}').nl();
   }
 
+  private specializedFunctionCall(node: AST.FunctionDeclaration, fenv: FunctionEnv, funcType: FunctionType,
+                                  funcName: string, funcProfileId: number, v: SpecializedVersion, index: number) {
+    const specializedFuncName = specializedFunctionName(funcName, v.version)
+
+    // For test
+    this.result.write(`#ifdef LINUX64`).nl().write('puts("Execute specialized function");').nl().write('#endif').nl()
+
+    this.result.write(`${countHitsFunctionName}(${funcProfileId}, ${v.version}, &${versionHitsName}[${index}]);`).nl()
+    this.result.write('return ');
+    this.functionCall(node, fenv, specializedFuncName, v.type, funcType.paramTypes, 'self')
+    this.signatures += this.makeFunctionStruct(specializedFuncName, v.type, false)
+  }
+
+  // calls the original function.  A returned value of the any type is profiled if profiled is true.
+  private originalFunctionCall(node: AST.FunctionDeclaration, fenv: FunctionEnv, funcType: FunctionType, funcName: string,
+                               profiled: boolean = true) {
+    const originalFuncName = originalFunctionName(funcName)
+    if (funcType.returnType === Any && profiled) {
+      this.result.write(`${cr.typeToCType(Any, 'result')} = `);
+      this.functionCall(node, fenv, originalFuncName, funcType, funcType.paramTypes, 'self')
+      this.result.nl().write(`${profileReturnFunctionName}(&${typeProfilerName}, result);`).nl()
+      this.result.write('return result;')
+    }
+    else {
+      this.result.write('return ');
+      this.functionCall(node, fenv, originalFuncName, funcType, funcType.paramTypes, 'self')
+    }
+  }
+
   private functionProfiling(node: FunctionDeclaration, fenv: FunctionEnv, funcType: FunctionType, funcProfilerId:number) {
-    this.result.write(`static uint8_t ${callCounterName} = 0;`).nl();
-    this.result.write(`static typeint_t* ${typeProfilerName} = 0;`).nl();
+    this.result.write(`static uint16_t ${callCounterName} = 0;`).nl();
+    this.result.write(`static bs_type_profile* ${typeProfilerName} = 0;`).nl();
     this.result.write(`${profileFunctionName}(`)
-    let profSig = `${funcProfilerId}, &${callCounterName}, &${typeProfilerName}`;
-    let c = 0;
-    for (let i = 0; i < funcType.paramTypes.length; i++) {
+    const params: string[] = []
+    for (let i = 0; i < funcType.paramTypes.length && params.length < maxParamNum; i++) {
       const paramName = (node.params[i] as AST.Identifier).name
       const info = fenv.table.lookup(paramName)
-      if (info !== undefined && funcType.paramTypes[i]==Any) {
-        c += 1;
-        profSig += ', '
-        const name = info.transpiledName(paramName)
-        profSig += name
-      }
+      if (info !== undefined && funcType.paramTypes[i]==Any)
+        params.push(info.transpiledName(paramName))
     }
-    profSig += `, VALUE_UNDEF`.repeat(maxParamNum - c);
+
+    const profSig = `${funcProfilerId}, &${callCounterName}, &${typeProfilerName}, ${params.length}, (value_t[]){ ${params.join(', ')} }`;
     this.result.write(profSig).write(');').nl();
   }
 
@@ -1,7 +1,7 @@
 import TypeChecker from "../transpiler/type-checker";
 import {NameInfo, NameTable, NameTableMaker} from "../transpiler/names";
 import * as AST from "@babel/types";
-import {getSpecializedNode} from "./utils";
+import {getSpecializedNodes} from "./utils";
 import {Any} from "../transpiler/types";
 
 
@@ -28,8 +28,7 @@ export function jitTypecheck<Info extends NameInfo>(ast: AST.Node, maker: NameTa
 export class JitTypeChecker<Info extends NameInfo> extends TypeChecker<NameInfo> {
   functionDeclaration(node: AST.FunctionDeclaration, names: NameTable<Info>): void {
     super.functionDeclaration(node, names)
-    const specializedNode = getSpecializedNode(node)
-    if (specializedNode !== undefined)
-      super.functionDeclaration(specializedNode, names)
+    for (const specialized of getSpecializedNodes(node) ?? [])
+      super.functionDeclaration(specialized.node, names)
   }
 }
\ No newline at end of file
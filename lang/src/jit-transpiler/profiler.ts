@@ -1,26 +1,47 @@
-import {Any, ArrayType, FunctionType, StaticType} from "../transpiler/types";
+import {Any, ArrayType, FunctionType, sameType, StaticType} from "../transpiler/types";
 import {ProfileError} from "./utils";
 
 
+// 'specializing' means that a new specialized version has been added but not compiled yet.
 export type FunctionState =
   {state: 'profiling'} |
-  {state: 'specializing', type: FunctionType} |
+  {state: 'specializing'} |
   {state: 'undoing'} |
-  {state: 'specialized', type: FunctionType} |
+  {state: 'specialized'} |
   {state: 'unspecialized'}
 
+export type SpecializedVersion = {
+  version: number,            // a number unique within the function.  It is used for the names in C.
+  type: FunctionType,
+  hits: number,               // the number of calls reported by the device
+  compiled: boolean,
+}
+
 export type FunctionProfile = {
   id: number,
   name: string,
   src: string,
   type: FunctionType,
   state: FunctionState,
+  versions: SpecializedVersion[],
+  nextVersion: number,
+  returnType?: StaticType,    // the profiled type of the returned values
+  megamorphic?: boolean,      // true if no more version is added
 }
 
 export const callCounterName =  "call_count";
 export const typeProfilerName = "type_profile";
 export const profileFunctionName = "bs_profiler_profile";
-export const maxParamNum = 4;
+export const profileReturnFunctionName = "bs_profiler_profile_return";
+export const countHitsFunctionName = "bs_profiler_count_hits";
+export const versionHitsName = "version_hits";
+
+// The maximum number of any-type parameters profiled per function.
+// It must be equal to BS_PROFILER_MAX_PARAMS in microcontroller/core/include/profiler.h.
+export const maxParamNum = 8;
+
+// The maximum number of specialized versions per function.
+export const maxVersionNum = 4;
 
 export class Profiler {
   private nextFuncId: number = 0;
@@ -29,7 +50,7 @@ export class Profiler {
 
   setFunctionProfile(name: string, src: string, type: FunctionType) {
     const id = this.nextFuncId++;
-    const profile:FunctionProfile = {id, name, src, type, state: {state: "profiling"}}
+    const profile:FunctionProfile = {id, name, src, type, state: {state: "profiling"}, versions: [], nextVersion: 0}
     this.profiles.set(name, profile);
     this.idToName.set(id, name);
     return profile;
@@ -50,15 +71,17 @@ export class Profiler {
       func.state = state;
   }
 
-  setFuncSpecializedType(id: number, paramTypes: StaticType[]) {
-    const funcName = this.idToName.get(id);
-    if (funcName === undefined)
-      throw new ProfileError(`Cannot find the target function. id: ${id}`);
-    const func = this.profiles.get(funcName);
-    if (func === undefined)
-      throw new ProfileError(`Cannot not find the target function. name: ${funcName}`);
+  // adds a specialized version for the profiled types.
+  // When the function already has specialized versions, the types are the ones
+  // the function was called with when no version was selected.
+  setFuncSpecializedType(id: number, paramTypes: StaticType[], returnType?: StaticType) {
+    const func = this.getProfiledFunction(id);
+    if (func.megamorphic)
+      return;
+
+    func.returnType = returnType;
     if (!Profiler.funcIsSpecializable(func, paramTypes)) {
-      func.state = {state: 'undoing'}
+      Profiler.stopSpecializing(func);
       return;
     }
 
@@ -70,7 +93,55 @@ export class Profiler {
       else
         specializedParamTypes.push(paramTypes[s++]);
     }
-    func.state = {state: 'specializing', type: new FunctionType(func.type.returnType, specializedParamTypes)};
+    const type = new FunctionType(func.type.returnType, specializedParamTypes);
+    // a version number is 1 byte in C.
+    if (func.versions.some(v => sameType(v.type, type)) || func.nextVersion > 0xff)
+      return;
+
+    if (func.versions.length >= maxVersionNum) {
+      // a version is replaced only when it has never been reported to be called.
+      const coldest = func.versions.reduce((a, b) => b.hits < a.hits ? b : a);
+      if (coldest.hits > 0)
+        return;
+
+      func.versions.splice(func.versions.indexOf(coldest), 1);
+    }
+
+    func.versions.push({version: func.nextVersion++, type, hits: 0, compiled: false});
+    func.state = {state: 'specializing'};
+  }
+
+  // the function was called with too many combinations of argument types.
+  setFuncMegamorphic(id: number) {
+    Profiler.stopSpecializing(this.getProfiledFunction(id));
+  }
+
+  // records the number of calls to a specialized version.
+  addVersionHits(id: number, version: number, hits: number) {
+    const v = this.getProfiledFunction(id).versions.find(v => v.version === version);
+    if (v !== undefined)
+      v.hits += hits;
+  }
+
+  // The specialized versions are kept if any.  Then the wrapper is compiled again
+  // so that it stops profiling the calls that no version accepts.
+  private static stopSpecializing(func: FunctionProfile) {
+    if (func.versions.length === 0)
+      func.state = {state: 'undoing'};
+    else if (!func.megamorphic) {
+      func.megamorphic = true;
+      func.state = {state: 'specializing'};
+    }
+  }
+
+  private getProfiledFunction(id: number) {
+    const funcName = this.idToName.get(id);
+    if (funcName === undefined)
+      throw new ProfileError(`Cannot find the target function. id: ${id}`);
+    const func = this.profiles.get(funcName);
+    if (func === undefined)
+      throw new ProfileError(`Cannot not find the target function. name: ${funcName}`);
+    return func;
   }
 
   static funcNeedsProfiling(funcType: FunctionType) {
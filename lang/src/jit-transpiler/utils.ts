@@ -12,6 +12,7 @@ import traverse from "@babel/traverse";
 import {Profiler} from "./profiler";
 import {InstanceType} from "../transpiler/classes";
 import {GlobalVariableNameTable} from "../transpiler/code-generator/variables";
+import {isTypedArray} from "../transpiler/type-checker";
 
 export const specializedFuncPrefix = "0";
 
@@ -31,7 +32,7 @@ export function typeStringToStaticType(typeString: string, gvnt: GlobalVariableN
     return new ArrayType('boolean')
   } else if (isArray(typeString)) {
     return getArrayType(typeString, gvnt)
-  } else if (typeString === 'Function') {
+  } else if (typeString === 'Function' || typeString === 'any') {
     return 'any'
   } else {
     const type = gvnt === undefined ? undefined : gvnt.lookup(typeString)?.type
@@ -103,12 +104,31 @@ function staticTypeToNode(type: StaticType):AST.TSTypeAnnotation {
   return tsTypeAnnotation(staticTypeToTSType(type));
 }
 
-function addSpecializedNode(node: AST.FunctionDeclaration, specializedNode: AST.FunctionDeclaration) {
-  ((node as unknown) as { specialized: AST.FunctionDeclaration }).specialized = specializedNode
+// the type of a parameter of a specialized version.
+// Since push() and pop() are not available on a typed-array parameter,
+// an integer[] or float[] parameter is any if the function calls push() or pop().
+function paramTypeToNode(func: AST.FunctionDeclaration, type: StaticType) {
+  return staticTypeToNode(isTypedArray(type) && callsPushOrPop(func) ? Any : type)
 }
 
-export function getSpecializedNode(node: AST.FunctionDeclaration) {
-  return ((node as unknown) as { specialized?: AST.FunctionDeclaration }).specialized
+function callsPushOrPop(func: AST.FunctionDeclaration) {
+  let found = false
+  AST.traverseFast(func.body, n => {
+    found ||= AST.isMemberExpression(n) && AST.isIdentifier(n.property)
+              && (n.property.name === ArrayType.pushMethod || n.property.name === ArrayType.popMethod)
+  })
+  return found
+}
+
+// a function declaration for a specialized version.
+export type SpecializedNode = { version: number, node: AST.FunctionDeclaration }
+
+function addSpecializedNodes(node: AST.FunctionDeclaration, specializedNodes: SpecializedNode[]) {
+  ((node as unknown) as { specialized: SpecializedNode[] }).specialized = specializedNodes
+}
+
+export function getSpecializedNodes(node: AST.FunctionDeclaration) {
+  return ((node as unknown) as { specialized?: SpecializedNode[] }).specialized
 }
 
 
@@ -122,18 +142,26 @@ export function convertAst(ast: AST.Node, profiler: Profiler) {
         const profile = name ? profiler.getFunctionProfileByName(name) : undefined;
         if (profile === undefined || (profile.state.state !== 'specializing' && profile.state.state !== 'specialized'))
           return;
-        const specializedType = profile.state.type
-        const clone = structuredClone(statement)
-        if (clone.id === null || clone.id === undefined)
-          return;
-        clone.id.name = specializedFuncPrefix + name
-        clone.params.forEach((p, i) => {
-          if (!AST.isVoidPattern(p)) {
-            p.typeAnnotation = staticTypeToNode(specializedType.paramTypes[i])
-          }
-        })
-        clone.returnType = staticTypeToNode(specializedType.returnType)
-        addSpecializedNode(statement, clone)
+
+        // while specializing, only the versions not compiled yet are needed.
+        const isSpecializing = profile.state.state === 'specializing'
+        const specializedNodes: SpecializedNode[] = []
+        for (const v of profile.versions) {
+          if (isSpecializing && v.compiled)
+            continue;
+          const clone = structuredClone(statement)
+          if (clone.id === null || clone.id === undefined)
+            return;
+          clone.id.name = `${specializedFuncPrefix}${v.version}${name}`
+          clone.params.forEach((p, i) => {
+            if (!AST.isVoidPattern(p)) {
+              p.typeAnnotation = paramTypeToNode(statement, v.type.paramTypes[i])
+            }
+          })
+          clone.returnType = staticTypeToNode(v.type.returnType)
+          specializedNodes.push({version: v.version, node: clone})
+        }
+        addSpecializedNodes(statement, specializedNodes)
       })
     }
   })
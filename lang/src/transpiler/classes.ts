@@ -2,7 +2,7 @@
 
 import { FunctionType, ObjectType, StaticType, isPrimitiveType, isSubtype,
          typeToString, encodeType,
-         ArrayType, StringType } from "./types"
+         ArrayType, StringType, StringBuilderType, MapType } from "./types"
 
 export type StaticPropertyInfo = {
   type: StaticType
@@ -286,6 +286,24 @@ const builtinPropertiesAndMethods: string[]
       ArrayType.popMethod,          // 5
       ArrayType.unshiftMethod,      // 6
       ArrayType.shiftMethod,        // 7
+      StringBuilderType.appendMethod,   // 8
+      StringBuilderType.toStringMethod, // 9
+      ArrayType.fillMethod,         // 10
+      ArrayType.setMethod,          // 11
+      ArrayType.addMethod,          // 12
+      ArrayType.scaleMethod,        // 13
+      ArrayType.dotMethod,          // 14
+      ArrayType.sumMethod,          // 15
+      ArrayType.minMethod,          // 16
+      ArrayType.maxMethod,          // 17
+      MapType.getMethod,            // 18
+      MapType.hasMethod,            // 19
+      MapType.deleteMethod,         // 20
+      MapType.clearMethod,          // 21
+      ArrayType.sortMethod,         // 22
+      ArrayType.binarySearchMethod, // 23
+      ArrayType.indexOfMethod,      // 24
+      ArrayType.reverseMethod,      // 25
     ]
 
 export class ClassTable {
@@ -359,6 +377,35 @@ export class ClassTable {
     })
 
     return { offset: offset, unboxed: unboxed,
-             props: props, unboxedTypes: unboxedTypes.join('')}
+             props: props, unboxedTypes: unboxedTypes.join(''),
+             all: this.allProperties(clazz, unboxed) }
+  }
+
+  // returns all the properties including inherited ones.  They are sorted by their names
+  // so that get_anyobj_property() in c-runtime.c can run a binary search.
+  private allProperties(clazz: InstanceType, unboxed: number) {
+    const all: { name: number, index: number, type: string }[] = []
+    const found = new Set<number>()
+    let c: ObjectType = clazz
+    while (c instanceof InstanceType) {
+      c.forEach((name: string, type: StaticType, index: number) => {
+        const code = this.encodeName(name)
+        if (code !== undefined && !found.has(code)) {
+          found.add(code)
+          all.push({ name: code, index: index, type: index < unboxed ? encodeType(type) : ' ' })
+        }
+      })
+
+      c = c.superclass()
+    }
+
+    return all.sort((a, b) => a.name - b.name)
+  }
+
+  // returns the indexes of the given methods sorted by the method names.
+  sortedMethods(table: { name: string }[]) {
+    const indexes = table.map((m, i) => i)
+    const code = (i: number) => this.encodeName(table[i].name) as number
+    return indexes.sort((i, j) => code(i) - code(j))
   }
 }
@@ -6,8 +6,8 @@ import { Integer, Int32, Float, BooleanT, StringT, Void, Null, Any,
     ObjectType, objectType, FunctionType,
     StaticType, isPrimitiveType, isIntegerLike, typeToString, ArrayType, sameType, encodeType, isSubtype,
     ByteArrayClass, UnionType, EnumType,
-    FixedArrayClass,
-    isIntegerType} from '../types'
+    FixedArrayClass, StringBuilderClass, Int8ArrayClass, Int16ArrayClass, Uint16ArrayClass, Uint32ArrayClass,
+    isIntegerType, isHashTableClass } from '../types'
 import { InstanceType, ClassTable, StaticPropertyInfo } from '../classes'
 import { VariableEnv } from './variables'
 
@@ -76,10 +76,36 @@ function typeConversionError(from: StaticType | undefined, to: StaticType | unde
   return new ErrorLog().push(`internal error: the current runtime cannot convert ${fromType} to ${toType}`, node)
 }
 
+/*
+  A conversion by safe_value_to_<kind>(nullable, [clazz, ] value), which checks the type
+  of an object.  clazz is a pointer to the class object when kind is 'value'.
+*/
+export interface ObjectConversion {
+  kind: 'string' | 'object' | 'intarray' | 'floatarray' | 'boolarray' | 'anyarray' | 'value'
+  nullable: boolean
+  clazz?: string
+}
+
 // returns '(' or '<conversion function>('
 // "from" or "to" is undefined when type conversion is unnecessary
 export function typeConversion(from: StaticType | undefined, to: StaticType | undefined,
                                env: VariableEnv, node: AST.Node) {
+  return conversionToC(typeConversionOf(from, to, env, node))
+}
+
+// returns the C code of the conversion, '(' or '<conversion function>('
+export function conversionToC(conversion: string | ObjectConversion) {
+  if (typeof conversion === 'string')
+    return conversion
+  else {
+    const clazz = conversion.clazz === undefined ? '' : `${conversion.clazz}, `
+    return `safe_value_to_${conversion.kind}(${conversion.nullable}, ${clazz}`
+  }
+}
+
+// returns '(', '<conversion function>(', or an ObjectConversion
+export function typeConversionOf(from: StaticType | undefined, to: StaticType | undefined,
+                                 env: VariableEnv, node: AST.Node): string | ObjectConversion {
   if (from === undefined || to === undefined)
     return '('
 
@@ -155,28 +181,28 @@ export function typeConversion(from: StaticType | undefined, to: StaticType | un
       }
       else if (from === Any || from instanceof ObjectType || from instanceof UnionType) {
         if (to === StringT)
-          return 'safe_value_to_string(false, '
+          return { kind: 'string', nullable: false }
         else if (to instanceof ObjectType) {
           if (to === objectType)
-            return 'safe_value_to_object(false, '
+            return { kind: 'object', nullable: false }
           else if (to instanceof ArrayType) {
             if (isIntegerLike(to.elementType))
-              return 'safe_value_to_intarray(false, '
+              return { kind: 'intarray', nullable: false }
             else if (to.elementType === Float)
-              return 'safe_value_to_floatarray(false, '
+              return { kind: 'floatarray', nullable: false }
             else if (to.elementType === BooleanT)
-              return 'safe_value_to_boolarray(false, '
+              return { kind: 'boolarray', nullable: false }
             else if (to.elementType === Any)
-              return 'safe_value_to_anyarray(false, '
+              return { kind: 'anyarray', nullable: false }
             else
-              return `safe_value_to_value(false, &${env.useArrayType(to)[0]}.clazz, `
+              return { kind: 'value', nullable: false, clazz: `&${env.useArrayType(to)[0]}.clazz` }
           }
           else if (to instanceof InstanceType)
             if (isSubtype(from, to))
               return '('
             else {
               const info = classObjectNameInC(to.name())
-              return `safe_value_to_value(false, &${info}, `
+              return { kind: 'value', nullable: false, clazz: `&${info}` }
             }
         }
         else if (to instanceof UnionType)
@@ -192,29 +218,58 @@ export function typeConversion(from: StaticType | undefined, to: StaticType | un
   throw typeConversionError(from, to, node)
 }
 
-function typeConversionToUnion(from: StaticType, to: UnionType, env: VariableEnv, node: AST.Node) {
+/*
+  returns a C expression testing whether the conversion succeeds without throwing an error.
+*/
+export function typeGuard(conversion: ObjectConversion, value: string) {
+  let test: string
+  switch (conversion.kind) {
+    case 'string':
+      test = `gc_is_string_object(${value})`
+      break
+    case 'object':
+      test = `(is_ptr_value(${value}) && !gc_is_string_object(${value}))`
+      break
+    case 'intarray':
+    case 'floatarray':
+    case 'boolarray':
+      test = `gc_is_${conversion.kind}(${value})`
+      break
+    case 'anyarray':
+      test = `gc_is_instance_of_array(${value})`
+      break
+    case 'value':
+      test = `gc_is_instance_of(${conversion.clazz}, ${value})`
+      break
+  }
+
+  return conversion.nullable ? `(${value} == VALUE_NULL || ${test})` : test
+}
+
+function typeConversionToUnion(from: StaticType, to: UnionType, env: VariableEnv,
+                               node: AST.Node): ObjectConversion {
   const objType = to.isNullable()
   if (objType !== undefined) {
     if (objType === StringT)
-      return 'safe_value_to_string(true, '
+      return { kind: 'string', nullable: true }
     else {
       if (objType === objectType)
-        return 'safe_value_to_object(true, '
+        return { kind: 'object', nullable: true }
       else if (objType instanceof ArrayType) {
         if (isIntegerLike(objType.elementType))
-          return 'safe_value_to_intarray(true, '
+          return { kind: 'intarray', nullable: true }
         else if (objType.elementType === Float)
-          return 'safe_value_to_floatarray(true, '
+          return { kind: 'floatarray', nullable: true }
         else if (objType.elementType === BooleanT)
-          return 'safe_value_to_boolarray(true, '
+          return { kind: 'boolarray', nullable: true }
         else if (objType.elementType === Any)
-          return 'safe_value_to_anyarray(true, '
+          return { kind: 'anyarray', nullable: true }
         else
-          return `safe_value_to_value(true, &${env.useArrayType(objType)[0]}.clazz, `
+          return { kind: 'value', nullable: true, clazz: `&${env.useArrayType(objType)[0]}.clazz` }
       }
       else if (objType instanceof InstanceType) {
         const info = classObjectNameInC(objType.name())
-        return `safe_value_to_value(true, &${info}, `
+        return { kind: 'value', nullable: true, clazz: `&${info}` }
       }
     }
   }
@@ -371,6 +426,9 @@ export function getObjectPrimitiveProperty(t: StaticType) {
     return '*get_obj_int_property('
 }
 
+// the index of the size of a Map or Set object.  See HT_SIZE in c-runtime.c.
+export const hashTableSizeIndex = 0
+
 export function makeBoxedValue(type: StaticType, value?: string) {
   if (isPrimitiveType(type))
     if (type === Float)
@@ -381,9 +439,24 @@ export function makeBoxedValue(type: StaticType, value?: string) {
     return  `gc_new_box(${value || 'VALUE_UNDEF'})`
 }
 
+// the compact array classes, the name of their runtime functions without gc_ and _get,
+// and the C type of their elements.  The elements of Uint32Array are accessed as int32_t.
+const compactArraysInC = new Map<string, [string, string]>([
+  [Int8ArrayClass, ['int8array', 'int8_t']],
+  [Int16ArrayClass, ['int16array', 'int16_t']],
+  [Uint16ArrayClass, ['uint16array', 'uint16_t']],
+  [Uint32ArrayClass, ['uint32array', 'int32_t']]])
+
+function compactArrayInC(arrayType: StaticType | undefined) {
+  return arrayType instanceof InstanceType ? compactArraysInC.get(arrayType.name()) : undefined
+}
+
 // a getter/setter function for arrays
 export function arrayElementGetter(t: StaticType | undefined, arrayType: StaticType | undefined, node: AST.Node) {
-  if (arrayType instanceof InstanceType && arrayType.name() === ByteArrayClass)
+  const compact = compactArrayInC(arrayType)
+  if (compact !== undefined)
+    return `(*gc_${compact[0]}_get(`
+  else if (arrayType instanceof InstanceType && arrayType.name() === ByteArrayClass)
     return '(*gc_bytearray_get('
   else if (arrayType instanceof InstanceType && arrayType.name() === FixedArrayClass)
     return '(gc_fixedarray_get('
@@ -399,6 +472,67 @@ export function arrayElementGetter(t: StaticType | undefined, arrayType: StaticT
     return `(gc_safe_array_get(`
 }
 
+// a getter function for arrays when the element is assigned a value.
+// If mayBeReadOnly is true, it throws an error when the array is a read-only array.
+export function arrayElementLvalue(t: StaticType | undefined, arrayType: StaticType | undefined,
+                                   mayBeReadOnly: boolean, node: AST.Node) {
+  if (mayBeReadOnly && arrayType instanceof ArrayType)
+    if (t === Integer || t === Int32 || t instanceof EnumType)
+      return '(*gc_intarray_lval('
+    else if (t === Float)
+      return '(*gc_floatarray_lval('
+
+  return arrayElementGetter(t, arrayType, node)
+}
+
+// the C function returning the address of the first element of a typed array,
+// the C function accessing an element through that address (lvalAccessor is used when the element
+// is assigned a value), the C type of the elements, the index of the length in the array object,
+// and whether the array may be a read-only array.
+// undefined if arrayType is not a typed array.
+export function arrayElementBase(arrayType: StaticType | undefined) {
+  const compact = compactArrayInC(arrayType)
+  if (compact !== undefined)
+    return { getter: `gc_${compact[0]}_base(`, accessor: `(*gc_${compact[0]}_elem(`,
+             lvalAccessor: `(*gc_${compact[0]}_elem(`, elementType: compact[1],
+             lengthIndex: getArrayLengthIndex(BooleanT), mayBeReadOnly: false }
+  else if (arrayType instanceof InstanceType && arrayType.name() === ByteArrayClass)
+    return { getter: 'gc_bytearray_base(', accessor: '(*gc_bytearray_elem(',
+             lvalAccessor: '(*gc_bytearray_elem(', elementType: 'uint8_t',
+             lengthIndex: getArrayLengthIndex(BooleanT), mayBeReadOnly: false }
+  else if (arrayType instanceof ArrayType) {
+    const t = arrayType.elementType
+    if (t === Integer || t === Int32 || t instanceof EnumType)
+      return { getter: 'gc_intarray_base(', accessor: '(*gc_intarray_elem(',
+               lvalAccessor: '(*gc_intarray_elem_lval(', elementType: 'int32_t',
+               lengthIndex: getArrayLengthIndex(t), mayBeReadOnly: true }
+    else if (t === Float)
+      return { getter: 'gc_floatarray_base(', accessor: '(*gc_floatarray_elem(',
+               lvalAccessor: '(*gc_floatarray_elem_lval(', elementType: 'float',
+               lengthIndex: getArrayLengthIndex(t), mayBeReadOnly: true }
+    else if (t === BooleanT)
+      return { getter: 'gc_bytearray_base(', accessor: '(*gc_bytearray_elem(',
+               lvalAccessor: '(*gc_bytearray_elem(', elementType: 'uint8_t',
+               lengthIndex: getArrayLengthIndex(t), mayBeReadOnly: false }
+  }
+
+  return undefined
+}
+
+export const arrayLengthOrZero = 'gc_length_or_zero('
+
+// the same as arrayLengthOrZero except that it is 0 when the array is a growable array.
+// A growable array may change its length and the address of its elements
+// when push() or pop() is called on it.
+export const fixedArrayLengthOrZero = 'gc_fixed_length_or_zero('
+
+// the same as fixedArrayLengthOrZero except that it is 0 also when the array is a read-only array.
+// It is used when the elements of the array are assigned values.
+export const writableArrayLengthOrZero = 'gc_writable_length_or_zero('
+
+// makes a growable array from an integer[], float[], or Uint8Array object.
+export const growableArray = 'gc_new_growable_array('
+
 export function arrayElementSetter(arrayType: StaticType | undefined) {
   if (arrayType === undefined)
     throw new Error('unknown array type')
@@ -427,6 +561,49 @@ export function arrayFromElements(arrayType: ArrayType, env: VariableEnv) {
     return `gc_make_array(&${env.useArrayType(arrayType)[0]}.clazz, `
 }
 
+// an array literal is compiled into arrayFromConstants() if it has this number of elements or more
+// and they are numeric literals.
+export const minConstantArrayLength = 4
+
+// makes an integer[] or float[] object from a C array holding the elements.
+// undefined if arrayType is not integer[] or float[].
+// staticMaker is the C macro declaring a read-only array and readOnlyClass is its class.
+export function arrayFromConstants(arrayType: ArrayType) {
+  const t = arrayType.elementType
+  if (isIntegerLike(t))
+    return { maker: 'gc_make_intarray_from(', elementType: 'int32_t',
+             staticMaker: 'STATIC_INTARRAY', readOnlyClass: 'readonly_intarray' }
+  else if (t === Float)
+    return { maker: 'gc_make_floatarray_from(', elementType: 'float',
+             staticMaker: 'STATIC_FLOATARRAY', readOnlyClass: 'readonly_floatarray' }
+  else
+    return undefined
+}
+
+export function constantArrayNameInC(index: number) {
+  return `constarr_${index}`
+}
+
+// declares a C array holding the elements of an array literal.
+// On microcontrollers, it is in the read-only data section.
+export function constantArrayDeclaration(name: string, elementType: string, elements: string[]) {
+  return `static const ${elementType} ${name}[] = { ${elements.join(', ')} };\n`
+}
+
+// declares a read-only array object.  On microcontrollers, it is in the read-only data section,
+// which is placed in the flash memory.
+export function staticArrayDeclaration(staticMaker: string, name: string, elements: string[]) {
+  return `${staticMaker}(${name}, ${elements.length}, ${elements.join(', ')});\n`
+}
+
+export function staticArrayValue(name: string) {
+  return `STATIC_ARRAY_VALUE(${name})`
+}
+
+export function readOnlyArrayClassDeclaration(className: string) {
+  return `extern CLASS_OBJECT(${className}, 1);\n`
+}
+
 export function arrayFromSize(arrayType: ArrayType, env: VariableEnv) {
   const t = arrayType.elementType
   if (isIntegerLike(t))
@@ -480,6 +657,31 @@ export function getArrayLengthIndex(t: StaticType) {
 export const isInstanceOfArray = `gc_is_instance_of_array(`
 
 export const stringMaker = 'gc_new_string'
+
+export function stringLiteralNameInC(index: number) {
+  return `strlit_${index}`
+}
+
+// declares a string literal object allocated outside of the heap memory.
+export function staticStringDeclaration(name: string, value: string) {
+  return `STATIC_STRING(${name}, ${JSON.stringify(value)}, 0x${stringHash(value).toString(16)});\n`
+}
+
+// FNV-1a.  It must be equivalent to string_hash() in c-runtime.c.
+export function stringHash(value: string) {
+  let h = 0x811c9dc5
+  for (const b of new TextEncoder().encode(value))
+    h = Math.imul(h ^ b, 0x01000193)
+
+  h >>>= 0
+  return h === 0 ? 1 : h
+}
+
+export function staticStringValue(name: string) {
+  return `STATIC_STRING_VALUE(${name})`
+}
+
+export const externStringLiteralClass = 'extern CLASS_OBJECT(string_literal, 1);\n'
 export const isStringType = 'gc_is_string_object('
 
 export const functionMaker = 'gc_new_function'
@@ -504,10 +706,18 @@ function methodSigListNameInC(name: string) {
   return `msigs_${name}`
 }
 
+function methodSortedListNameInC(name: string) {
+  return `msorted_${name}`
+}
+
 function propertyListNameInC(name: string) {
   return `plist_${name}`
 }
 
+function allPropertyListNameInC(name: string) {
+  return `pall_${name}`
+}
+
 export function classObjectNameInC(name: string) {
   return `class_${name}.clazz`
 }
@@ -582,28 +792,40 @@ export function classDeclaration(clazz: InstanceType, classTable: ClassTable) {
 
   methodNames += '};'
   methodSigs += '};'
-  const methodTable = `{ .size = ${table.length}, .names = ${methodListName}, .signatures = ${methodSigListName} }`
+  const methodSortedListName = methodSortedListNameInC(name)
+  const methodSorted = `static const uint16_t ${methodSortedListName}[] = { ${classTable.sortedMethods(table).join(', ')} };`
+  const methodTable = `{ .size = ${table.length}, .names = ${methodListName}, .signatures = ${methodSigListName}, .sorted = ${methodSortedListName} }`
 
   const size = clazz.objectSize()
   const start = clazz.unboxedProperties() || 0
 
   const ptable = classTable.propertyTable(clazz)
   const propListName = propertyListNameInC(name)
+  const allPropListName = allPropertyListNameInC(name)
   const propTable = `{ .size = ${ptable.props.length}, .offset = ${ptable.offset},
-    .unboxed = ${ptable.unboxed}, .prop_names = ${propListName}, .unboxed_types = "${ptable.unboxedTypes}" }`
+    .unboxed = ${ptable.unboxed}, .prop_names = ${propListName}, .unboxed_types = "${ptable.unboxedTypes}",
+    .all_size = ${ptable.all.length}, .all_props = ${allPropListName} }`
 
   const propList = `static const uint16_t ${propListName}[] = { ${ptable.props.join(', ')} };`
+  const allPropList = `static const struct property_entry ${allPropListName}[] = { ${ptable.all.map(p => `{ ${p.name}, ${p.index}, '${p.type}' }`).join(', ')} };`
 
-  return `${methodNames}\n${methodSigs}\n${propList}\nCLASS_OBJECT(${classNameInC(name)}, ${table.length}) = {
+  return `${methodNames}\n${methodSigs}\n${methodSorted}\n${propList}\n${allPropList}\nCLASS_OBJECT(${classNameInC(name)}, ${table.length}) = {
     .body = { .s = ${size}, .i = ${start}, .cn = "${name}", .sc = ${superAddr} , .an = (void*)0, .pt = ${propTable}, .mt = ${methodTable}, .vtbl = { ${tableArray} }}};`
 }
 
 export function makeInstance(clazz: InstanceType, func: () => string) {
   const name = clazz.name()
-  if (name === ByteArrayClass)
+  const compact = compactArraysInC.get(name)
+  if (compact !== undefined)
+    return `gc_new_${compact[0]}(`
+  else if (name === ByteArrayClass)
     return 'gc_new_bytearray(false'
   else if (name === FixedArrayClass)
     return 'gc_new_fixedarray('
+  else if (name === StringBuilderClass)
+    return 'gc_new_string_builder('
+  else if (isHashTableClass(name))
+    return `gc_new_hash_table(&${classObjectNameInC(name)}`
   else
     return `${constructorNameInC(name)}(${func()}gc_new_object(&${classObjectNameInC(name)})`
 }
@@ -612,6 +834,13 @@ export function methodLookup(method: [StaticType, number, (InstanceType | ArrayT
   return `((${funcTypeToCType(method[0])})gc_method_lookup(${func}, ${method[1]}))`
 }
 
+// a method lookup when the class of the receiver has been obtained by getClassOf.
+export function methodLookupInClass(method: [StaticType, number, (InstanceType | ArrayType)?], clazz: string) {
+  return `((${funcTypeToCType(method[0])})${clazz}->vtbl[${method[1]}])`
+}
+
+export const getClassOf = 'gc_get_class_of('
+
 export function isArrayObject(f: string) {
   return `safe_anyarray_to_anyarrayobj(${f})`
 }
@@ -627,11 +856,16 @@ export function arrayTypeDeclaration(type: ArrayType, name: string, is_declared:
   const arrayName = encodeType(type)
   if (is_declared) {
     const eType = encodeType(type.elementType)
-    const mt = `{ .size = 4,
-                  .names = (const uint16_t[]){ /* push */ 4, /* pop */ 5, /* unshift */ 6, /* shift */ 7, },
-                  .signatures = (const char* const[]){ "(${eType})i", "()|${eType}n", "(${eType})i", "()|${eType}n" }}`
-    const vtbl = `{ gc_array_push, gc_array_pop, gc_array_unshift, gc_array_shift }`
-    return `CLASS_OBJECT(${name}, 4) = { .body = { .s = 2, .i = 1, .cn = "${typeName}", .sc = &object_class.clazz, .an = "${arrayName}", .pt = { .size = 0, .offset = 0, .unboxed = 0, .prop_names = (void*)0, .unboxed_types = (void*)0 }, .mt = ${mt}, .vtbl = ${vtbl}}};\n`
+    const cmpType = `(${eType}${eType})i`
+    const mt = `{ .size = 8,
+                  .names = (const uint16_t[]){ /* push */ 4, /* pop */ 5, /* unshift */ 6, /* shift */ 7,
+                                               /* sort */ 22, /* binarySearch */ 23, /* indexOf */ 24, /* reverse */ 25 },
+                  .signatures = (const char* const[]){ "(${eType})i", "()|${eType}n", "(${eType})i", "()|${eType}n",
+                                                       "(${cmpType})${arrayName}", "(${eType}${cmpType})i", "(${eType})i", "()${arrayName}" },
+                  .sorted = (const uint16_t[]){ 0, 1, 2, 3, 4, 5, 6, 7 } }`
+    const vtbl = `{ gc_array_push, gc_array_pop, gc_array_unshift, gc_array_shift,
+                    gc_array_sort, gc_array_binary_search, gc_array_index_of, gc_array_reverse }`
+    return `CLASS_OBJECT(${name}, 8) = { .body = { .s = 3, .i = 2, .cn = "${typeName}", .sc = &object_class.clazz, .an = "${arrayName}", .pt = { .size = 0, .offset = 0, .unboxed = 0, .prop_names = (void*)0, .unboxed_types = (void*)0 }, .mt = ${mt}, .vtbl = ${vtbl}}};\n`
   }
   else
     return `extern CLASS_OBJECT(${name}, 0);\n`
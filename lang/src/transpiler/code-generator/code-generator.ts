@@ -3,15 +3,16 @@
 import * as AST from '@babel/types'
 import { runBabelParser, ErrorLog, CodeWriter } from '../utils'
 import { Integer, Int32, BooleanT, Void, Any, ObjectType, FunctionType,
-         StaticType, ByteArrayClass, isPrimitiveType, encodeType, sameType, typeToString, ArrayType, objectType,
+         StaticType, isIntegerArrayClass, isPrimitiveType, encodeType, sameType, typeToString, ArrayType, objectType,
          StringT,  UnionType, FixedArrayClass, StringType,
-         EnumType} from '../types'
+         EnumType, MapType, isHashTableClass } from '../types'
 import * as visitor from '../visitor'
-import { getCoercionFlag, getStaticType } from '../names'
+import { getCoercionFlag, getGrowableFlag, getStaticType } from '../names'
 import TypeChecker, { typecheck, codeTagFunction } from '../type-checker'
 import { VariableInfo, VariableEnv, GlobalEnv, FunctionEnv, VariableNameTableMaker,
          GlobalVariableNameTable, getVariableNameTable } from './variables'
 import * as cr from './c-runtime'
+import { CountedLoop, LoopBody, findCountedLoop, loopVariableOffset, scanLoop } from './loop-analysis'
 import { InstanceType, StaticPropertyInfo } from '../classes'
 import { ar } from 'zod/locales'
 
@@ -56,6 +57,11 @@ export class CodeGenerator extends visitor.NodeVisitor<VariableEnv> {
   protected result =  new CodeWriter()
   protected signatures = ''                   // function prototypes etc.
   protected classObjectDeclarations = ''      // class objects.
+  protected stringLiterals = new Map<string, string>()    // string literals and their names in C
+  protected stringLiteralDeclarations = ''    // string literal objects.
+  protected constantArrayDeclarations = ''    // C arrays holding the elements of array literals.
+  private constantArrayCounter = 0
+  private readOnlyArrayClasses = new Set<string>()   // the classes of read-only arrays declared in this file
   protected declarations = new CodeWriter()   // function declarations etc.
   private endWithReturn = false
   private initializerName: string           // the name of an initializer function
@@ -66,6 +72,15 @@ export class CodeGenerator extends visitor.NodeVisitor<VariableEnv> {
   private uniqueId = 0
   private uniqueIdCounter = 0
   private moduleId = ''                     // empty string or a sequnce of digits
+  // counted loops whose array accesses are not checked, and the names of the variables
+  // holding the element addresses of the arrays.
+  private uncheckedLoops: { loop: CountedLoop, bases: Map<string, string>, flag?: string }[] = []
+  // loops enclosing the current node, the declarations of the variables holding
+  // loop-invariant values, and the numbers identifying those variables.
+  private loopPreheaders: { body: LoopBody, declarations: string[], ids: Map<string, number> }[] = []
+  private loopTempCounter = 0
+  // true while visiting the left operand of an assignment.  See visitLvalue().
+  private lvalue = false
 
   constructor(initializerName: string, codeId: number, moduleId: string) {
     super()
@@ -77,7 +92,8 @@ export class CodeGenerator extends visitor.NodeVisitor<VariableEnv> {
   }
 
   getCode(header: string) {
-    return `${this.signatures}${header}${this.classObjectDeclarations}${this.declarations.getCode()}${this.result.getCode()}`
+    const literals = this.stringLiterals.size > 0 ? cr.externStringLiteralClass + this.stringLiteralDeclarations : ''
+    return `${this.signatures}${header}${literals}${this.constantArrayDeclarations}${this.classObjectDeclarations}${this.declarations.getCode()}${this.result.getCode()}`
   }
 
   file(node: AST.File, env: VariableEnv): void {
@@ -171,8 +187,17 @@ export class CodeGenerator extends visitor.NodeVisitor<VariableEnv> {
     this.makeStringLiteral(node.value)
   }
 
+  // a string literal is a constant object declared once.
+  // It is not allocated in the heap memory whenever the literal is evaluated.
   private makeStringLiteral(value: string) {
-    this.result.write(`${cr.stringMaker}(${JSON.stringify(value)})`)
+    let name = this.stringLiterals.get(value)
+    if (name === undefined) {
+      name = cr.stringLiteralNameInC(this.stringLiterals.size)
+      this.stringLiterals.set(value, name)
+      this.stringLiteralDeclarations += cr.staticStringDeclaration(name, value)
+    }
+
+    this.result.write(cr.staticStringValue(name))
   }
 
   booleanLiteral(node: AST.BooleanLiteral, env: VariableEnv): void {
@@ -261,37 +286,41 @@ export class CodeGenerator extends visitor.NodeVisitor<VariableEnv> {
   }
 
   whileStatement(node: AST.WhileStatement, env: VariableEnv): void {
-    this.result.nl()
-    this.result.write('while (')
-    this.testExpression(node.test, env)
-    this.result.write(') ')
-    if (node.body.type === 'BlockStatement')
-      this.visit(node.body, env)
-    else {
-      this.result.right()
-      this.visit(node.body, env)
-      this.result.left()
-    }
+    this.loopWithPreheader(node, () => {
+      this.result.nl()
+      this.result.write('while (')
+      this.testExpression(node.test, env)
+      this.result.write(') ')
+      if (node.body.type === 'BlockStatement')
+        this.visit(node.body, env)
+      else {
+        this.result.right()
+        this.visit(node.body, env)
+        this.result.left()
+      }
+    })
 
     this.endWithReturn = false
   }
 
   doWhileStatement(node: AST.DoWhileStatement, env: VariableEnv): void {
-    this.result.nl()
-    this.result.write('do ')
-    if (node.body.type === 'BlockStatement')
-      this.visit(node.body, env)
-    else {
-      this.result.write('{')
-      this.result.right()
-      this.visit(node.body, env)
-      this.result.left()
-      this.result.nl().write('}')
-    }
+    this.loopWithPreheader(node, () => {
+      this.result.nl()
+      this.result.write('do ')
+      if (node.body.type === 'BlockStatement')
+        this.visit(node.body, env)
+      else {
+        this.result.write('{')
+        this.result.right()
+        this.visit(node.body, env)
+        this.result.left()
+        this.result.nl().write('}')
+      }
 
-    this.result.write(' while (')
-    this.testExpression(node.test, env)
-    this.result.write(');')
+      this.result.write(' while (')
+      this.testExpression(node.test, env)
+      this.result.write(');')
+    })
 
     this.endWithReturn = false
   }
@@ -341,12 +370,189 @@ export class CodeGenerator extends visitor.NodeVisitor<VariableEnv> {
   forStatement(node: AST.ForStatement, env: VariableEnv): void {
     const env2 = new VariableEnv(getVariableNameTable(node), env)
     const num = env2.allocateRootSet()
-    this.result.nl()
+    this.loopWithPreheader(node, () => {
+      const loop = this.countedLoopOverArrays(node, env2)
+      if (loop === undefined) {
+        this.result.nl()
+        this.forStatementBody(node, true, env2)
+      }
+      else
+        this.uncheckedForStatement(node, loop, env2)
+    })
+
+    env2.deallocate(num)
+    this.endWithReturn = false
+  }
+
+  /*
+    Generates a loop by calling emit().  If the loop needs loop-invariant values,
+    they are computed before the loop:
+
+      { int32_t* elem_base0 = gc_intarray_base(_a); int32_t elem_len0 = gc_length_or_zero(_a, 0);
+        while (...) ... (*gc_intarray_elem(_a, elem_base0, elem_len0, _i)) ...
+      }
+
+    A value is loop-invariant if it depends only on variables that the loop does not
+    change.  A global variable may be changed if the loop calls a function.
+    See hoistedValue().
+  */
+  private loopWithPreheader(node: AST.Loop, emit: () => void) {
+    const body = scanLoop(node)
+    if (body === undefined) {
+      emit()
+      return
+    }
+
+    const preheader = { body, declarations: [] as string[], ids: new Map<string, number>() }
+    const outerResult = this.result
+    this.result = outerResult.copy()
+    this.loopPreheaders.push(preheader)
+    emit()
+    this.loopPreheaders.pop()
+    const loopCode = this.result.getCode()
+    this.result = outerResult
+    if (preheader.declarations.length > 0) {
+      this.result.nl().write('{')
+      for (const decl of preheader.declarations)
+        this.result.write(` ${decl}`)
+
+      this.result.write(loopCode)
+      this.result.nl().write('}')
+    }
+    else
+      this.result.write(loopCode)
+  }
+
+  /*
+    returns a number identifying a C variable that holds a value computed from the
+    given variable before the outermost loop not changing that variable.
+    declare() returns the declaration of that C variable.  kind distinguishes
+    values computed from the same variable.  It returns undefined if the innermost
+    loop may change the variable.  If isArray is true, the variable must not be
+    a receiver of method calls since the methods may change the length of the array.
+    declare() receives the body of the loop before which the value is computed.
+  */
+  private hoistedValue(name: string, kind: string, env: VariableEnv, isArray: boolean,
+                       declare: (info: VariableInfo, id: number, body: LoopBody) => string) {
+    const info = env.table.lookup(name)
+    if (info === undefined)
+      return undefined
+
+    let preheader
+    for (let i = this.loopPreheaders.length - 1; i >= 0; i--) {
+      const body = this.loopPreheaders[i].body
+      if (body.isUnchanged(name) && this.isInvariantVariable(info, body)
+          && !(isArray && body.receivers.has(name)))
+        preheader = this.loopPreheaders[i]
+      else
+        break
+    }
+
+    if (preheader === undefined)
+      return undefined
+
+    const key = `${kind} ${name}`
+    let id = preheader.ids.get(key)
+    if (id === undefined) {
+      id = this.loopTempCounter++
+      preheader.ids.set(key, id)
+      preheader.declarations.push(declare(info, id, preheader.body))
+    }
+
+    return id
+  }
+
+  // an array access like a[b] where the address of the first element
+  // and the length of the array are obtained before the loop.
+  private hoistedArrayAccess(node: AST.MemberExpression, lvalue: boolean, env: VariableEnv) {
+    if (this.loopPreheaders.length === 0 || !AST.isIdentifier(node.object))
+      return false
+
+    const name = node.object.name
+    const base = cr.arrayElementBase(getStaticType(node.object))
+    if (base === undefined)
+      return false
+
+    const mayBeReadOnly = base.mayBeReadOnly && this.mayHoldReadOnlyArray(name, env)
+    const id = this.hoistedValue(name, 'elem', env, true, (info, id, body) => {
+      const array = info.transpile(name)
+      // a function called in the loop may push an element on the array if it is growable.
+      // Then the length is 0 so that every access is checked by gc_intarray_get() etc.
+      // If the loop assigns a value to an element, the length is 0 also for a read-only array
+      // so that the assignment throws an error.
+      const length = mayBeReadOnly && body.elementsAssigned.has(name) ? cr.writableArrayLengthOrZero
+                     : body.hasCalls ? cr.fixedArrayLengthOrZero : cr.arrayLengthOrZero
+      return `${base.elementType}* elem_base${id} = ${base.getter}${array}); `
+             + `int32_t elem_len${id} = ${length}${array}, ${base.lengthIndex});`
+    })
+    if (id === undefined)
+      return false
+
+    this.result.write(lvalue && mayBeReadOnly ? base.lvalAccessor : base.accessor)
+    this.visit(node.object, env)
+    this.result.write(`, elem_base${id}, elem_len${id}, `)
+    const n = this.callExpressionArg(node.property, Integer, env)
+    this.result.write('))')
+    env.deallocate(n)   // n will be zero.
+    return true
+  }
+
+  // true if the variable may hold a read-only array.  A read-only array is created only for
+  // a const global variable, but it may be passed anywhere.  A local variable never holds it
+  // if all the arrays assigned to the variable are created by an array literal or new.
+  private mayHoldReadOnlyArray(name: string, env: VariableEnv) {
+    const info = env.table.lookup(name)
+    return info === undefined || info.isGlobal() || info.original().mayBeFixed
+  }
+
+  // returns the name of a C variable holding the class of the receiver
+  // if the class is obtained before the loop.
+  private hoistedClassOf(receiver: AST.Node, env: VariableEnv) {
+    if (this.loopPreheaders.length === 0 || !AST.isIdentifier(receiver))
+      return undefined
+
+    const name = receiver.name
+    const id = this.hoistedValue(name, 'class', env, false,
+      (info, id) => `class_object* class_of${id} = ${cr.getClassOf}${info.transpile(name)});`)
+    return id === undefined ? undefined : `class_of${id}`
+  }
+
+  /*
+    cr.typeConversion() with a type guard obtained before the loop.
+    If expr is a variable not changed in the loop and the conversion checks its type,
+    the check is done before the loop without throwing an error.  In the loop,
+    the conversion function is called only when the check failed, so that it
+    throws an error.
+      (guard0 || safe_value_to_intarray(false, _a), _a)
+    expr is the expression converted by the returned code.  node is used for error messages.
+  */
+  private typeConversion(from: StaticType | undefined, to: StaticType | undefined,
+                         env: VariableEnv, expr: AST.Node, node: AST.Node = expr) {
+    const conversion = cr.typeConversionOf(from, to, env, node)
+    const code = cr.conversionToC(conversion)
+    if (typeof conversion === 'string' || this.loopPreheaders.length === 0 || !AST.isIdentifier(expr))
+      return code
+
+    const info = env.table.lookup(expr.name)
+    if (info === undefined)
+      return code
+
+    const value = info.transpile(expr.name)
+    const guard = cr.typeGuard(conversion, value)
+    const id = this.hoistedValue(expr.name, `guard ${code}`, env, false,
+                                 (info, id) => `bool guard${id} = ${guard};`)
+    if (id === undefined)
+      return code
+    else
+      return `(guard${id} || ${code}${value}), `
+  }
+
+  private forStatementBody(node: AST.ForStatement, withInit: boolean, env2: VariableEnv) {
     this.result.write('for (')
-    if (node.init)
+    if (node.init && withInit)
       this.visit(node.init, env2)
 
-    if (!node.init || AST.isExpression(node.init))
+    if (!node.init || !withInit || AST.isExpression(node.init))
       this.result.write('; ')
 
     if (node.test)
@@ -365,9 +571,165 @@ export class CodeGenerator extends visitor.NodeVisitor<VariableEnv> {
       this.visit(node.body, env2)
       this.result.left()
     }
+  }
 
-    env2.deallocate(num)
-    this.endWithReturn = false
+  // returns a counted loop if array accesses in the loop body can be
+  // executed without a range check.  See loop-analysis.ts.
+  private countedLoopOverArrays(node: AST.ForStatement, env: VariableEnv) {
+    const loop = findCountedLoop(node)
+    if (loop === undefined)
+      return undefined
+
+    const index = env.table.lookup(loop.index)
+    if (index === undefined || index.type !== Integer || index.isBoxed())
+      return undefined
+
+    const bound = loop.bound
+    if (AST.isIdentifier(bound)) {
+      const info = env.table.lookup(bound.name)
+      if (info === undefined || info.type !== Integer || !this.isInvariantVariable(info, loop.body))
+        return undefined
+    }
+
+    if (loop.boundArray !== undefined && this.typedArrayVariable(loop.boundArray, env, loop.body) === undefined)
+      return undefined
+
+    for (const name of loop.arrays.keys())
+      if (this.typedArrayVariable(name, env, loop.body) === undefined)
+        loop.arrays.delete(name)
+
+    return loop.arrays.size > 0 ? loop : undefined
+  }
+
+  // true if the value of the variable does not change during the loop when the loop body
+  // does not assign a value to it.  If the loop calls a function, the function may assign
+  // a new value to a global variable or a variable captured by a closure.
+  private isInvariantVariable(info: VariableInfo, body: LoopBody) {
+    if (info.isFunction || info.isTypeName)
+      return false
+    else if (info.isGlobal())
+      return info.isConst || !body.hasCalls
+    else
+      return !info.isBoxed() || !body.hasCalls
+  }
+
+  // returns the variable information and its C accessors if the variable holds a typed array
+  // during the loop.  Its length may change if it is a growable array and the loop calls a function.
+  // See uncheckedForStatement().
+  private typedArrayVariable(name: string, env: VariableEnv, body: LoopBody) {
+    const info = env.table.lookup(name)
+    if (info !== undefined && this.isInvariantVariable(info, body)) {
+      const base = cr.arrayElementBase(info.type)
+      if (base !== undefined)
+        return { info, base }
+    }
+
+    return undefined
+  }
+
+  /*
+    A counted loop is compiled into the following code:
+
+      { int32_t _i = <init>;
+        bool unchecked0 = <the loop bound is within the arrays>;
+        float* elem_base1 = unchecked0 ? gc_floatarray_base(<array>) : 0;
+        for (; _i < <bound>; _i++) ... (*(unchecked0 ? &elem_base1[_i] : gc_floatarray_get(<array>, _i))) ...
+      }
+
+    The loop body is emitted only once.  An element is accessed without a range check
+    only when the check before the loop passes.  unchecked0 is omitted if no check is needed.
+    If the loop calls a function, the length of a growable array may change during the loop.
+    So the arrays are checked by gc_fixed_length_or_zero(), which is 0 for a growable array.
+    If the loop assigns a value to an element of an integer[] or float[] array,
+    the array is checked by gc_writable_length_or_zero(), which is 0 also for
+    a read-only array, so that the checked assignment throws an error.
+  */
+  private uncheckedForStatement(node: AST.ForStatement, loop: CountedLoop, env2: VariableEnv) {
+    const loopVar = env2.table.lookup(loop.index) as VariableInfo
+    const conditions: (() => void)[] = []
+    if (!loop.startsWithNonNegative())
+      conditions.push(() => this.result.write(`${loopVar.transpile(loop.index)} >= ${-loop.minOffset()}`))
+
+    const bases = new Map<string, string>()
+    for (const [name, accesses] of loop.arrays) {
+      const { info, base } = this.typedArrayVariable(name, env2, loop.body)!
+      const array = info.transpile(name)
+      const writable = base.mayBeReadOnly && loop.body.elementsAssigned.has(name)
+                       && this.mayHoldReadOnlyArray(name, env2)
+      const hasCalls = loop.body.hasCalls || writable
+      const length = writable ? `${cr.writableArrayLengthOrZero}${array}, ${base.lengthIndex})`
+                     : hasCalls ? `${cr.fixedArrayLengthOrZero}${array}, ${base.lengthIndex})`
+                                : `${cr.getObjectPrimitiveProperty(Integer)}${array}, ${base.lengthIndex})`
+      // the loop bound plus the maximum offset must be <= the array length.
+      if (accesses.byLoopVariable
+          && (hasCalls || !(loop.boundArray === name && loop.boundOffset + accesses.maxOffset <= 0)))
+        conditions.push(() => {
+          const offset = accesses.maxOffset
+          this.result.write('(')
+          this.visit(loop.bound, env2)
+          this.result.write(`) <= ${length}${offset > 0 ? ` - ${offset}` : offset < 0 ? ` + ${-offset}` : ''}`)
+        })
+
+      if (accesses.maxConstantIndex >= 0)
+        conditions.push(() => this.result.write(`${accesses.maxConstantIndex} < ${length}`))
+
+      bases.set(name, `elem_base${this.loopTempCounter++}`)
+    }
+
+    const flag = conditions.length > 0 ? `unchecked${this.loopTempCounter++}` : undefined
+    this.result.nl().write('{')
+    this.result.right()
+    this.visit(node.init!, env2)
+    this.result.nl()
+    if (flag !== undefined) {
+      this.result.write(`bool ${flag} = `)
+      conditions.forEach((cond, i) => {
+        if (i > 0)
+          this.result.write(' && ')
+
+        cond()
+      })
+      this.result.write(';').nl()
+    }
+
+    for (const [name, baseName] of bases) {
+      const { info, base } = this.typedArrayVariable(name, env2, loop.body)!
+      const getter = `${base.getter}${info.transpile(name)})`
+      this.result.write(`${base.elementType}* ${baseName} = ${flag === undefined ? getter : `${flag} ? ${getter} : 0`}; `)
+    }
+
+    this.result.nl()
+    this.uncheckedLoops.push({ loop, bases, flag })
+    this.forStatementBody(node, false, env2)
+    this.uncheckedLoops.pop()
+    this.result.left()
+    this.result.nl().write('}')
+  }
+
+  // returns the name of the variable holding the address of the first element
+  // if an array access is in a counted loop and it does not need a range check.
+  // flag is the name of the variable that is true if the range check before the loop passed.
+  private uncheckedElementBase(node: AST.MemberExpression) {
+    if (!AST.isIdentifier(node.object))
+      return undefined
+
+    const name = node.object.name
+    const index = node.property
+    for (let i = this.uncheckedLoops.length - 1; i >= 0; i--) {
+      const { loop, bases, flag } = this.uncheckedLoops[i]
+      const accesses = loop.arrays.get(name)
+      const base = bases.get(name)
+      const offset = loopVariableOffset(index, loop.index)
+      if (accesses !== undefined && base !== undefined)
+        if (offset !== undefined && accesses.byLoopVariable
+            && accesses.minOffset <= offset && offset <= accesses.maxOffset)
+          return { base, flag }
+        else if (AST.isNumericLiteral(index) && Number.isInteger(index.value)
+                 && 0 <= index.value && index.value <= accesses.maxConstantIndex)
+          return { base, flag }
+    }
+
+    return undefined
   }
 
   expressionStatement(node: AST.ExpressionStatement, env: VariableEnv): void {
@@ -416,7 +778,7 @@ export class CodeGenerator extends visitor.NodeVisitor<VariableEnv> {
         const typeAndVar = cr.typeToCType(retType, cr.returnValueVariable)
         const type = this.needsCoercion(argument)
         if (type)
-          this.result.write(`{ ${typeAndVar} = ${cr.typeConversion(type, retType, env, node)}`)
+          this.result.write(`{ ${typeAndVar} = ${this.typeConversion(type, retType, env, argument, node)}`)
         else
           this.result.write(`{ ${typeAndVar} = (`)
 
@@ -723,7 +1085,9 @@ export class CodeGenerator extends visitor.NodeVisitor<VariableEnv> {
       }
       else if (info.isGlobal() && decl.init) {
         this.result.write(`${cr.setGlobalVariable}(&${info.transpile(varName)}, `)
-        this.declaratorInitializer(decl, false, info, env)
+        if (!(info.isConst && this.readOnlyArrayInitializer(decl.init)))
+          this.declaratorInitializer(decl, false, info, env)
+
         this.result.write(')')
         return signature
       }
@@ -741,7 +1105,7 @@ export class CodeGenerator extends visitor.NodeVisitor<VariableEnv> {
     if (decl.init) {
       const initType = this.needsCoercion(decl.init)
       if (initType) {
-        const converter = cr.typeConversion(initType, info.type, env, decl)
+        const converter = this.typeConversion(initType, info.type, env, decl.init, decl)
         this.result.write(` ${withEq ? '=' : ''} ${converter}`)
         this.visit(decl.init, env)
         this.result.write(')')
@@ -1027,7 +1391,7 @@ export class CodeGenerator extends visitor.NodeVisitor<VariableEnv> {
       }
     }
 
-    this.updateExpr(node, argType, env, () => this.visit(node.argument, env))
+    this.updateExpr(node, argType, env, () => this.visitLvalue(node.argument, env))
   }
 
   updateExpr(node: AST.UpdateExpression, argType: StaticType | undefined, env: VariableEnv,
@@ -1236,11 +1600,19 @@ export class CodeGenerator extends visitor.NodeVisitor<VariableEnv> {
         }
     }
 
-    this.visit(left, env)
+    this.visitLvalue(left, env)
     this.result.write(' = ')
     this.assignmentRight(leftType, right, rightType, env)
   }
 
+  // visits the left operand of an assignment.  If it is an array access, the generated code
+  // throws an error when the array is a read-only array.
+  private visitLvalue(node: AST.Node, env: VariableEnv) {
+    this.lvalue = AST.isMemberExpression(node)
+    this.visit(node, env)
+    this.lvalue = false
+  }
+
   private isAssignmentToVar(left: AST.Node, env: VariableEnv) {
     if (AST.isIdentifier(left))
       return env.table.lookup(left.name)
@@ -1293,7 +1665,7 @@ export class CodeGenerator extends visitor.NodeVisitor<VariableEnv> {
                           env: VariableEnv) {
     let func: string
     if (left_type === Any || right_type === Any)
-      func = cr.typeConversion(right_type, left_type, env, right)
+      func = this.typeConversion(right_type, left_type, env, right)
     else
       func = '('
 
@@ -1350,7 +1722,7 @@ export class CodeGenerator extends visitor.NodeVisitor<VariableEnv> {
       }
     }
 
-    this.accumulateExpr(node, leftType, rightType, env, () => this.visit(left, env))
+    this.accumulateExpr(node, leftType, rightType, env, () => this.visitLvalue(left, env))
   }
 
   // if node is a member expression, the type of l-value is a primitive type.
@@ -1504,10 +1876,16 @@ export class CodeGenerator extends visitor.NodeVisitor<VariableEnv> {
           // a method call on a typed object
           let funcExpr = func
           const minfo = method[0]
+          let clazz
           if (minfo[2] instanceof ArrayType && minfo[2].elementType === Any)
             funcExpr = cr.isArrayObject(func)
+          else
+            clazz = this.hoistedClassOf((node.callee as AST.MemberExpression).object, env)
 
-          this.result.write(`, ${cr.methodLookup(method[0], funcExpr)}(${func}`)
+          if (clazz === undefined)
+            this.result.write(`, ${cr.methodLookup(method[0], funcExpr)}(${func}`)
+          else
+            this.result.write(`, ${cr.methodLookupInClass(method[0], clazz)}(${func}`)
         }
       }
       else {
@@ -1562,7 +1940,7 @@ export class CodeGenerator extends visitor.NodeVisitor<VariableEnv> {
     if (arg_type === undefined)
       this.visit(arg, env)
     else {
-      this.result.write(cr.typeConversion(arg_type, type, env, arg))
+      this.result.write(this.typeConversion(arg_type, type, env, arg))
       this.visit(arg, env)
       this.result.write(')')
     }
@@ -1582,12 +1960,25 @@ export class CodeGenerator extends visitor.NodeVisitor<VariableEnv> {
 
   newExpression(node: AST.NewExpression, env: VariableEnv): void {
     const type = getStaticType(node)
-    if (type instanceof ArrayType)
-      this.newArrayExpression(node, type, env)
-    else if (type instanceof InstanceType)
-      this.newObjectExpression(node, type, env)
+    this.growableArray(node, () => {
+      if (type instanceof ArrayType)
+        this.newArrayExpression(node, type, env)
+      else if (type instanceof InstanceType)
+        this.newObjectExpression(node, type, env)
+      else
+        throw this.errorLog.push(`bad new expression`, node)
+    })
+  }
+
+  // if the type checker marks the node, the array created by emit() is made growable.
+  private growableArray(node: AST.Node, emit: () => void) {
+    if (getGrowableFlag(node)) {
+      this.result.write(cr.growableArray)
+      emit()
+      this.result.write(')')
+    }
     else
-      throw this.errorLog.push(`bad new expression`, node)
+      emit()
   }
 
   private newArrayExpression(node: AST.NewExpression, atype: ArrayType, env: VariableEnv): void {
@@ -1663,13 +2054,16 @@ export class CodeGenerator extends visitor.NodeVisitor<VariableEnv> {
 
   arrayExpression(node: AST.ArrayExpression, env: VariableEnv):void {
     const atype = getStaticType(node)
-    this.arrayExpressionWithType(node, atype, env)
+    this.growableArray(node, () => this.arrayExpressionWithType(node, atype, env))
   }
 
   private arrayExpressionWithType(node: AST.ArrayExpression, atype: StaticType | undefined, env: VariableEnv):void {
     if (!(atype instanceof ArrayType))
       throw this.errorLog.push(`bad array expression`, node)
 
+    if (this.constantArrayExpression(node, atype))
+      return
+
     this.result.write(cr.arrayFromElements(atype, env) + node.elements.length)
     let numOfObjectArgs = 0
     for (const ele of node.elements)
@@ -1686,13 +2080,109 @@ export class CodeGenerator extends visitor.NodeVisitor<VariableEnv> {
     this.result.write(')')
   }
 
+  // an array literal such as [1, 2, -3] of integer[] or float[] type.
+  // If its elements are numeric literals, they are stored in a constant C array
+  // and copied by a single memcpy() when the array object is created.
+  // It returns false if the literal is not such an array literal.
+  private constantArrayExpression(node: AST.ArrayExpression, atype: ArrayType) {
+    const constants = this.constantArrayElements(node, atype)
+    if (constants === undefined)
+      return false
+
+    const { maker, elements } = constants
+    const name = cr.constantArrayNameInC(this.constantArrayCounter++)
+    this.constantArrayDeclarations += cr.constantArrayDeclaration(name, maker.elementType, elements)
+    this.result.write(`${maker.maker}${elements.length}, ${name})`)
+    return true
+  }
+
+  // the initial value of a const global variable such as const table = [1, 2, 3, 4].
+  // If the value is an array literal that constantArrayExpression() accepts,
+  // the array object is a read-only array, which is not allocated in the heap memory.
+  // On microcontrollers, it is placed in the flash memory.
+  // It returns false if the value is not such an array literal.
+  private readOnlyArrayInitializer(init: AST.Expression) {
+    const atype = getStaticType(init)
+    if (!(AST.isArrayExpression(init) && atype instanceof ArrayType)
+        || getGrowableFlag(init) || this.needsCoercion(init))
+      return false
+
+    const constants = this.constantArrayElements(init, atype)
+    if (constants === undefined)
+      return false
+
+    const { maker, elements } = constants
+    if (!this.readOnlyArrayClasses.has(maker.readOnlyClass)) {
+      this.readOnlyArrayClasses.add(maker.readOnlyClass)
+      this.constantArrayDeclarations += cr.readOnlyArrayClassDeclaration(maker.readOnlyClass)
+    }
+
+    const name = cr.constantArrayNameInC(this.constantArrayCounter++)
+    this.constantArrayDeclarations += cr.staticArrayDeclaration(maker.staticMaker, name, elements)
+    this.result.write(cr.staticArrayValue(name))
+    return true
+  }
+
+  // the C function making an array object and the elements in C
+  // if the elements of the array literal are numeric literals.
+  private constantArrayElements(node: AST.ArrayExpression, atype: ArrayType) {
+    const maker = cr.arrayFromConstants(atype)
+    if (maker === undefined || node.elements.length < cr.minConstantArrayLength)
+      return undefined
+
+    const elements: string[] = []
+    for (const ele of node.elements)
+      if (AST.isNumericLiteral(ele))
+        elements.push(ele.extra?.raw as string)
+      else if (AST.isUnaryExpression(ele) && ele.operator === '-' && AST.isNumericLiteral(ele.argument))
+        elements.push(`-${ele.argument.extra?.raw}`)
+      else
+        return undefined
+
+    return { maker, elements }
+  }
+
+  // true if the value of node may be a read-only array.
+  private mayBeReadOnlyArray(node: AST.Node, env: VariableEnv) {
+    return !AST.isIdentifier(node) || this.mayHoldReadOnlyArray(node.name, env)
+  }
+
   memberExpression(node: AST.MemberExpression, env: VariableEnv): void {
+    const lvalue = this.lvalue
+    this.lvalue = false
     let prop
-    if (node.computed) {
+    let unchecked
+    if (node.computed && (unchecked = this.uncheckedElementBase(node))) {
+      // an array access like a[i] in a counted loop
+      if (unchecked.flag === undefined) {
+        this.result.write(`(${unchecked.base}[`)
+        this.visit(node.property, env)
+        this.result.write('])')
+      }
+      else {
+        // the range check is done by the accessor if the check before the loop failed.
+        const arrayType = getStaticType(node.object)
+        const elementType = getStaticType(node)
+        const accessor = lvalue ? cr.arrayElementLvalue(elementType, arrayType, this.mayBeReadOnlyArray(node.object, env), node)
+                                : cr.arrayElementGetter(elementType, arrayType, node)
+        this.result.write(`(*(${unchecked.flag} ? &${unchecked.base}[`)
+        this.visit(node.property, env)
+        this.result.write(`] : ${accessor.slice(2)}`)     // accessor starts with '(*'
+        this.visit(node.object, env)
+        this.result.write(', ')
+        this.visit(node.property, env)
+        this.result.write(')))')
+      }
+    }
+    else if (node.computed && this.hoistedArrayAccess(node, lvalue, env)) {
+      // an array access like a[b] in a loop
+    }
+    else if (node.computed) {
       // an array access like a[b]
       const arrayType = getStaticType(node.object)
       const elementType = getStaticType(node)
-      this.result.write(cr.arrayElementGetter(elementType, arrayType, node))
+      this.result.write(lvalue ? cr.arrayElementLvalue(elementType, arrayType, this.mayBeReadOnlyArray(node.object, env), node)
+                               : cr.arrayElementGetter(elementType, arrayType, node))
       this.visit(node.object, env)
       this.result.write(', ')
       const n = this.callExpressionArg(node.property, Integer, env)
@@ -1709,7 +2199,7 @@ export class CodeGenerator extends visitor.NodeVisitor<VariableEnv> {
       const objType = getStaticType(node.object)
       const propertyName = (node.property as AST.Identifier).name
       if (objType instanceof InstanceType) {
-        if (propertyName === ArrayType.lengthProperty && objType.name() === ByteArrayClass) {
+        if (propertyName === ArrayType.lengthProperty && isIntegerArrayClass(objType.name())) {
           this.result.write(cr.getObjectPrimitiveProperty(Integer))
           this.visit(node.object, env)
           this.result.write(`, ${cr.getArrayLengthIndex(BooleanT)})`)
@@ -1719,6 +2209,11 @@ export class CodeGenerator extends visitor.NodeVisitor<VariableEnv> {
           this.visit(node.object, env)
           this.result.write(`, ${cr.getArrayLengthIndex(Any)})`)
         }
+        else if (propertyName === MapType.sizeProperty && isHashTableClass(objType.name())) {
+          this.result.write(cr.getObjectPrimitiveProperty(Integer))
+          this.visit(node.object, env)
+          this.result.write(`, ${cr.hashTableSizeIndex})`)
+        }
         else {
           const typeAndIndex = this.getPropertyIndex(objType, propertyName, node)
           const unbox = objType.unboxedProperties()
@@ -1841,7 +2336,7 @@ export class CodeGenerator extends visitor.NodeVisitor<VariableEnv> {
   tsAsExpression(node: AST.TSAsExpression, env: VariableEnv): void {
     const exprType = getStaticType(node.expression)
     const asType = getStaticType(node)
-    this.result.write(`${cr.typeConversion(exprType, asType, env, node)}`)
+    this.result.write(`${this.typeConversion(exprType, asType, env, node.expression, node)}`)
     this.visit(node.expression, env)
     this.result.write(')')
   }
@@ -0,0 +1,271 @@
+// Copyright (C) 2026- Shigeru Chiba.  All rights reserved.
+
+import * as AST from '@babel/types'
+
+/*
+  Range analysis for counted for loops such as
+
+    for (let i = 0; i < arr.length; i++)
+      sum += arr[i]
+
+  In the body of this loop, 0 <= i < arr.length holds if the loop variable i,
+  the loop bound, and the array variable arr are not assigned in the body.
+  If the loop bound is not arr.length, for example, if it is a constant,
+  the code generator checks once before the loop that the bound is
+  less than or equal to arr.length.  An index may be i + c or i - c
+  for a constant c.  An array access whose index is a constant,
+  such as arr[3], is also checked once before the loop.
+
+  This file also provides scanLoop() for finding the variables that any loop
+  (not only a counted loop) does not change.  The code generator computes
+  values depending only on those variables, such as the class of an object,
+  before the loop.
+*/
+
+// the variables that a loop may change.
+export class LoopBody {
+  assigned = new Set<string>()      // assigned variables
+  declared = new Set<string>()      // declared variables
+  receivers = new Set<string>()     // variables whose methods are called
+  elementsAssigned = new Set<string>()  // array variables whose elements are assigned
+  hasCalls = false                  // true if a function is called.  The function may assign a global variable.
+
+  // true if the loop does not assign a value to the variable or declare a variable with the same name.
+  isUnchanged(name: string | undefined) {
+    return name === undefined || (!this.assigned.has(name) && !this.declared.has(name))
+  }
+}
+
+// scans a whole loop including the initializer, the test, and the update expressions.
+// It returns undefined if the loop contains a function, a class, or embedded C code.
+export function scanLoop(node: AST.Loop): LoopBody | undefined {
+  const scanner = new BodyScanner()
+  return scanner.scan(node) ? scanner.body : undefined
+}
+
+// An array accessed in a counted loop.
+export class ArrayAccesses {
+  byLoopVariable = false    // true if the array is indexed by the loop variable (plus an offset)
+  minOffset = 0             // the minimum and maximum offsets added to the loop variable
+  maxOffset = 0
+  maxConstantIndex = -1     // the maximum constant index.  -1 if no constant index is used.
+}
+
+export class CountedLoop {
+  index: string             // the name of the loop variable
+  init: AST.Expression      // the initial value of the loop variable
+  bound: AST.Expression     // the loop bound
+  boundVariable?: string    // x if the bound includes a variable x
+  boundArray?: string       // x if the bound includes x.length
+  boundOffset = 0           // c if the bound is x + c or x - c.  In the latter case, it is negative.
+  arrays = new Map<string, ArrayAccesses>()
+  body = new LoopBody()     // the variables changed in the loop body
+
+  constructor(index: string, init: AST.Expression, bound: AST.Expression) {
+    this.index = index
+    this.init = init
+    this.bound = bound
+  }
+
+  // returns the minimum offset added to the loop variable in the array indexes.
+  minOffset() {
+    let min = 0
+    for (const accesses of this.arrays.values())
+      if (accesses.byLoopVariable)
+        min = Math.min(min, accesses.minOffset)
+
+    return min
+  }
+
+  // true if the loop variable plus the minimum offset is never negative.
+  startsWithNonNegative() {
+    return isNonNegativeInteger(this.init) && this.init.value + this.minOffset() >= 0
+  }
+}
+
+function isNonNegativeInteger(node: AST.Node): node is AST.NumericLiteral {
+  return AST.isNumericLiteral(node) && Number.isInteger(node.value) && node.value >= 0
+}
+
+// returns c if index is i, i + c, or i - c, where i is the loop variable and c is a constant.
+// Otherwise, it returns undefined.
+export function loopVariableOffset(index: AST.Node, loopVar: string): number | undefined {
+  if (AST.isIdentifier(index))
+    return index.name === loopVar ? 0 : undefined
+  else if (AST.isBinaryExpression(index) && (index.operator === '+' || index.operator === '-')
+           && AST.isIdentifier(index.left) && index.left.name === loopVar
+           && isNonNegativeInteger(index.right))
+    return index.operator === '+' ? index.right.value : -index.right.value
+  else
+    return undefined
+}
+
+/*
+  Finds a loop of the form: for (let i = e; i < b; i++) body
+  where b is a numeric literal, an identifier, or x.length, optionally plus or minus
+  a constant.  i++ may be ++i or i += 1.
+  The types of the variables are not checked.  The caller must check them.
+  It returns undefined if the given loop is not of that form, or the body
+  assigns a value to i, b, or x, declares a variable with the same name,
+  or contains a function.
+*/
+export function findCountedLoop(node: AST.ForStatement): CountedLoop | undefined {
+  const init = node.init
+  if (!(AST.isVariableDeclaration(init) && init.kind === 'let' && init.declarations.length === 1))
+    return undefined
+
+  const decl = init.declarations[0]
+  if (!AST.isIdentifier(decl.id) || !decl.init)
+    return undefined
+
+  const index = decl.id.name
+  const test = node.test
+  if (!(AST.isBinaryExpression(test) && test.operator === '<'
+        && AST.isIdentifier(test.left) && test.left.name === index))
+    return undefined
+
+  const loop = new CountedLoop(index, decl.init, test.right)
+  let bound: AST.Node = test.right
+  if (AST.isBinaryExpression(bound) && (bound.operator === '+' || bound.operator === '-')
+      && isNonNegativeInteger(bound.right)) {
+    loop.boundOffset = bound.operator === '+' ? bound.right.value : -bound.right.value
+    bound = bound.left
+  }
+
+  if (AST.isMemberExpression(bound)) {
+    if (bound.computed || !AST.isIdentifier(bound.object) || !AST.isIdentifier(bound.property)
+        || bound.property.name !== 'length')
+      return undefined
+
+    loop.boundArray = bound.object.name
+  }
+  else if (AST.isIdentifier(bound))
+    loop.boundVariable = bound.name
+  else if (!isNonNegativeInteger(bound))
+    return undefined
+
+  if (!isIncrement(node.update, index))
+    return undefined
+
+  const scanner = new BodyScanner(loop)
+  if (!scanner.scan(node.body))
+    return undefined
+
+  const body = loop.body = scanner.body
+  if (!body.isUnchanged(index) || !body.isUnchanged(loop.boundVariable) || !body.isUnchanged(loop.boundArray))
+    return undefined
+
+  for (const name of loop.arrays.keys())
+    if (!body.isUnchanged(name) || body.receivers.has(name))
+      loop.arrays.delete(name)
+
+  return loop.arrays.size > 0 ? loop : undefined
+}
+
+function isIncrement(update: AST.Expression | null | undefined, index: string) {
+  if (AST.isUpdateExpression(update))
+    return update.operator === '++' && AST.isIdentifier(update.argument) && update.argument.name === index
+  else if (AST.isAssignmentExpression(update))
+    return update.operator === '+=' && AST.isIdentifier(update.left) && update.left.name === index
+           && AST.isNumericLiteral(update.right) && update.right.value === 1
+  else
+    return false
+}
+
+// collects the assigned variables in a loop body.  If a counted loop is given,
+// it also collects the array accesses.
+class BodyScanner {
+  loop?: CountedLoop
+  body = new LoopBody()
+
+  constructor(loop?: CountedLoop) {
+    this.loop = loop
+  }
+
+  // returns false if the body cannot be analyzed.
+  scan(node: AST.Node | null | undefined): boolean {
+    if (node === null || node === undefined)
+      return true
+
+    if (AST.isFunction(node) || AST.isClass(node) || AST.isTaggedTemplateExpression(node))
+      return false
+    else if (AST.isAssignmentExpression(node)) {
+      if (AST.isIdentifier(node.left))
+        this.body.assigned.add(node.left.name)
+      else if (AST.isMemberExpression(node.left))
+        this.elementAssignment(node.left)
+      else
+        return false
+    }
+    else if (AST.isUpdateExpression(node)) {
+      if (AST.isIdentifier(node.argument))
+        this.body.assigned.add(node.argument.name)
+      else if (AST.isMemberExpression(node.argument))
+        this.elementAssignment(node.argument)
+    }
+    else if (AST.isVariableDeclarator(node)) {
+      if (AST.isIdentifier(node.id))
+        this.body.declared.add(node.id.name)
+      else
+        return false
+    }
+    else if (AST.isCallExpression(node)) {
+      const callee = node.callee
+      if (AST.isMemberExpression(callee) && AST.isIdentifier(callee.object))
+        this.body.receivers.add(callee.object.name)
+
+      this.body.hasCalls = true
+    }
+    else if (AST.isNewExpression(node))
+      this.body.hasCalls = true
+    else if (AST.isMemberExpression(node) && node.computed && AST.isIdentifier(node.object))
+      this.arrayAccess(node.object.name, node.property)
+
+    const keys = AST.VISITOR_KEYS[node.type] || []
+    for (const key of keys) {
+      const child = (node as any)[key]
+      if (Array.isArray(child)) {
+        for (const c of child)
+          if (!this.scan(c))
+            return false
+      }
+      else if (!this.scan(child))
+        return false
+    }
+
+    return true
+  }
+
+  private elementAssignment(node: AST.MemberExpression) {
+    if (node.computed && AST.isIdentifier(node.object))
+      this.body.elementsAssigned.add(node.object.name)
+  }
+
+  private arrayAccess(name: string, index: AST.Node) {
+    const loop = this.loop
+    if (loop === undefined)
+      return
+
+    let accesses = loop.arrays.get(name)
+    const offset = loopVariableOffset(index, loop.index)
+    if (offset !== undefined) {
+      if (accesses === undefined)
+        loop.arrays.set(name, accesses = new ArrayAccesses())
+
+      if (accesses.byLoopVariable) {
+        accesses.minOffset = Math.min(accesses.minOffset, offset)
+        accesses.maxOffset = Math.max(accesses.maxOffset, offset)
+      }
+      else {
+        accesses.byLoopVariable = true
+        accesses.minOffset = accesses.maxOffset = offset
+      }
+    }
+    else if (isNonNegativeInteger(index)) {
+      if (accesses === undefined)
+        loop.arrays.set(name, accesses = new ArrayAccesses())
+
+      accesses.maxConstantIndex = Math.max(accesses.maxConstantIndex, index.value)
+    }
+  }
+}
@@ -97,7 +97,7 @@ class FreeVariableInfo extends VariableInfo {
     this.nameInfo = name
   }
 
-  original(): VariableInfo {
+  override original(): VariableInfo {
     return this.nameInfo
   }
 
@@ -13,6 +13,9 @@ export class NameInfo {
   isFunction: boolean  // top-level function
   isExported: boolean
   captured: boolean    // captured as a free variable by a lambda function etc.
+  growable: boolean    // push() or pop() is called on this integer[], float[], or Uint8Array variable.
+  typedArrays?: Node[] // the expressions creating a typed array assigned to this variable.
+  mayBeFixed: boolean  // a typed array not created by an array literal or new, such as a parameter, may be assigned.
 
   constructor(t: StaticType) {
     this.type = t
@@ -21,6 +24,13 @@ export class NameInfo {
     this.isFunction = false
     this.isExported = false
     this.captured = false
+    this.growable = false
+    this.mayBeFixed = false
+  }
+
+  // the NameInfo object for the declaration if this is a free variable.
+  original(): NameInfo {
+    return this
   }
 
   copyFrom(info: NameInfo) {
@@ -52,6 +62,10 @@ export class FreeNameInfo extends NameInfo {
 
     this.nameInfo = name
   }
+
+  override original(): NameInfo {
+    return this.nameInfo
+  }
 }
 
 // Name tables
@@ -275,6 +289,16 @@ export function getCoercionFlag(node: Node) {
   return ((node as unknown) as { coercion: boolean }).coercion
 }
 
+// marks an expression creating an integer[], float[], or Uint8Array object
+// so that it will create a growable array.
+export function addGrowableFlag(node: Node) {
+  ((node as unknown) as { growable: boolean }).growable = true
+}
+
+export function getGrowableFlag(node: Node) {
+  return ((node as unknown) as { growable?: boolean }).growable === true
+}
+
 // utility classes for running a type checker with NameTable<NameInfo>
 
 export class BasicNameTableMaker implements NameTableMaker<NameInfo> {
@@ -4,7 +4,10 @@ import * as AST from '@babel/types'
 import { ErrorLog } from './utils'
 import * as visitor from './visitor'
 
-import { ArrayType, StaticType, ByteArrayClass, isPrimitiveType, UnionType, FixedArrayClass, StringType } from './types'
+import { ArrayType, StaticType, ByteArrayClass, isPrimitiveType, UnionType, FixedArrayClass, StringType,
+         StringBuilderClass, StringBuilderType, typedArrayMethods, compactArrayClasses,
+         isIntegerArrayClass, MapClass, SetClass, MapType, hashTableClassNames, hashTableClassName,
+         hashTableMethods, isHashTableClass } from './types'
 
 import {
   Integer, Int32, Float, BooleanT, StringT, Void, Null, Any,
@@ -18,12 +21,19 @@ import { actualElementType } from './code-generator/c-runtime'
 import {
   NameTable, NameTableMaker, GlobalNameTable, BasicGlobalNameTable, NameInfo,
   addNameTable, addStaticType, getStaticType, BasicNameTableMaker,
-  addCoercionFlag, getNameTable
+  addCoercionFlag, getNameTable, addGrowableFlag
 } from './names'
 import { InstanceType } from './classes'
 
 export const codeTagFunction = 'code'
 
+// true if t is integer[], float[], or Uint8Array.
+export function isTypedArray(t: StaticType | undefined) {
+  if (t instanceof ArrayType)
+    return t.elementType === Integer || t.elementType === Float
+  else
+    return t instanceof InstanceType && t.name() === ByteArrayClass
+}
 
 // entry point for just running a type checker
 export function runTypeChecker(ast: AST.Node, names: BasicGlobalNameTable,
@@ -81,15 +91,32 @@ export default class TypeChecker<Info extends NameInfo> extends visitor.NodeVisi
   }
 
   addBuiltinTypes(node: AST.Node, names: NameTable<Info>) {
-    this.addBuiltinClass(names, node, ByteArrayClass, [Integer, Integer])
+    this.addBuiltinClass(names, node, ByteArrayClass, [Integer, Integer], clazz => {
+      for (const [name, type] of typedArrayMethods(clazz, Integer))
+        clazz.addMethod(name, type)
+    })
+    for (const name of compactArrayClasses)
+      this.addBuiltinClass(names, node, name, [Integer, Integer])
+
     this.addBuiltinClass(names, node, FixedArrayClass, [Integer, Any])
+    this.addBuiltinClass(names, node, StringBuilderClass, [], clazz => {
+      clazz.addMethod(StringBuilderType.appendMethod, new FunctionType(clazz, [Any]))
+      clazz.addMethod(StringBuilderType.toStringMethod, new FunctionType(StringT, []))
+    })
+    for (const name of hashTableClassNames())
+      this.addBuiltinClass(names, node, name, [], clazz => {
+        for (const [method, type] of hashTableMethods(clazz, name))
+          clazz.addMethod(method, type)
+      })
   }
 
   // if constructorParams is undefined, this class may not be instantiated.
+  // addMethods adds methods to the class.  Their vtable indexes must match the class object in c-runtime.c.
   private addBuiltinClass(names: NameTable<Info>, node: AST.Node, typeName: string,
-                         constructorParams: StaticType[]) {
+                         constructorParams: StaticType[], addMethods?: (clazz: InstanceType) => void) {
     const clazz = this.maker.instanceType(typeName, objectType)
     clazz.addMethod('constructor', new FunctionType(Void, constructorParams))
+    addMethods?.(clazz)
     clazz.leafType = true
     if (!names.record(typeName, clazz, this.maker,
                       _ => { _.isTypeName = true; _.isExported = true }))
@@ -674,6 +701,9 @@ export default class TypeChecker<Info extends NameInfo> extends visitor.NodeVisi
                                    _ => { _.isConst = isConst; _.isExported = this.inExport })
       this.assert(success, `Identifier '${varName}' has already been declared`, node)
     }
+
+    if (node.init)
+      this.typedArrayAssignment(names.lookupInThis(varName), node.init)
   }
 
   private checkVariableInitializer(id: AST.Identifier | AST.ClassProperty, varType: StaticType | undefined,
@@ -687,7 +717,9 @@ export default class TypeChecker<Info extends NameInfo> extends visitor.NodeVisi
     }
 
     if (init) {    // a const declaration must have an initializer.  a let declaration may not.
-      this.visit(init, names)
+      if (!this.emptyTypedArray(init, varType, names))
+        this.visit(init, names)
+
       this.assert(this.result !== Void, 'void may not be an initial value', init)
       if (varType === undefined)
         varType = this.result
@@ -843,7 +875,7 @@ export default class TypeChecker<Info extends NameInfo> extends visitor.NodeVisi
         varType = this.result
       }
 
-      this.assert(names.record(varName, varType, this.maker),
+      this.assert(names.record(varName, varType, this.maker, _ => { _.mayBeFixed = isTypedArray(varType) }),
         `duplicated parameter name: ${varName}`, node)
       paramTypes.push(varType)
     }
@@ -1051,9 +1083,13 @@ export default class TypeChecker<Info extends NameInfo> extends visitor.NodeVisi
     this.assertLvalue(node.left, names)
     this.visit(node.left, names)
     let left_type = this.result
-    this.visit(node.right, names)
+    if (!(node.operator === '=' && this.emptyTypedArray(node.right, left_type, names)))
+      this.visit(node.right, names)
+
     const right_type = this.result
     const op = node.operator
+    if (op === '=' && AST.isIdentifier(node.left))
+      this.typedArrayAssignment(names.lookup(node.left.name), node.right)
 
     if (op === '=') {
       if (isConsistent(right_type, left_type) || (left_type === Int32 && right_type === Any)
@@ -1312,6 +1348,15 @@ export default class TypeChecker<Info extends NameInfo> extends visitor.NodeVisi
         this.newArrayExpression(node, names)
         return
       }
+      else if ((className.name === MapClass || className.name === SetClass) && node.typeParameters) {
+        const type = this.hashTableType(className.name, node.typeParameters.params as AST.TSType[], node, names)
+        if (type instanceof InstanceType)
+          this.newObjectExpression(node, type, names)
+        else
+          this.result = Any
+
+        return
+      }
       else {
         const info = names.lookup(className.name)
         if (info?.isTypeName && info.type instanceof InstanceType) {
@@ -1409,6 +1454,72 @@ export default class TypeChecker<Info extends NameInfo> extends visitor.NodeVisi
     this.arrayExpressionWithUpperType(node, names)
   }
 
+  /*
+    integer[], float[], and Uint8Array objects are fixed-length arrays unless they are
+    growable arrays created by gc_new_growable_array() in c-runtime.c.
+    An expression creating such an array is marked to create a growable array
+    if it is assigned to a variable and push() or pop() is called on that variable.
+    An empty array literal [] assigned to integer[] or float[] always creates a growable array.
+    push() and pop() are not available on a parameter, a property, or a variable
+    that may hold an array created elsewhere since the array may be a fixed-length array.
+  */
+
+  // when init is [] and type is integer[] or float[], this checks init as an array of that type.
+  // It returns false if it does not check init.
+  private emptyTypedArray(init: AST.Node, type: StaticType | undefined, names: NameTable<Info>) {
+    if (AST.isArrayExpression(init) && init.elements.length === 0
+        && type instanceof ArrayType && isTypedArray(type)) {
+      this.arrayExpressionWithUpperType(init, names, type.elementType)
+      addGrowableFlag(init)
+      return true
+    }
+    else
+      return false
+  }
+
+  // records that the value of expr is assigned to the variable.
+  private typedArrayAssignment(info: Info | undefined, expr: AST.Node) {
+    if (info === undefined || !isTypedArray(info.type))
+      return
+
+    const original = info.original()
+    if (AST.isArrayExpression(expr) || AST.isNewExpression(expr)) {
+      if (original.growable)
+        addGrowableFlag(expr)
+      else
+        (original.typedArrays ??= []).push(expr)
+    }
+    else {
+      original.mayBeFixed = true
+      this.assert(!original.growable, 'push() or pop() is called on this variable.  It may not be assigned this array', expr)
+    }
+  }
+
+  // called when a method is called on a typed array.
+  private growableArrayReceiver(node: AST.MemberExpression, type: StaticType, names: NameTable<Info>) {
+    if (!(AST.isIdentifier(node.property) && isTypedArray(type)))
+      return
+
+    if (!AST.isIdentifier(node.object)) {
+      const name = node.property.name
+      this.assert(name !== ArrayType.pushMethod && name !== ArrayType.popMethod,
+                  `${name}() is available only on a variable holding a growable array`, node)
+      return
+    }
+
+    const name = node.property.name
+    if (name === ArrayType.pushMethod || name === ArrayType.popMethod) {
+      const original = names.lookup(node.object.name)?.original()
+      this.assert(original === undefined || !original.mayBeFixed,
+                  `${name}() is not available on a parameter or a variable that may hold a fixed-length array`, node)
+      if (original !== undefined && !original.growable) {
+        original.growable = true
+        original.typedArrays?.forEach(addGrowableFlag)
+        original.typedArrays = undefined
+      }
+    }
+  }
+
   private arrayExpressionWithUpperType(node: AST.ArrayExpression, names: NameTable<Info>, upperType?: StaticType): void {
     let etype: StaticType | undefined = undefined
     for (const ele of node.elements)
@@ -1480,7 +1591,7 @@ export default class TypeChecker<Info extends NameInfo> extends visitor.NodeVisi
       this.result = this.result.elementType
       this.addStaticType(node, this.result)
     }
-    else if (this.result instanceof InstanceType && this.result.name() === ByteArrayClass) {
+    else if (this.result instanceof InstanceType && isIntegerArrayClass(this.result.name())) {
       this.addStaticType(node, Integer)
       this.result = Integer
     }
@@ -1516,11 +1627,16 @@ export default class TypeChecker<Info extends NameInfo> extends visitor.NodeVisi
           const unboxed = type.unboxedProperties()
           return unboxed === undefined || unboxed <= typeAndIndex[1]
         }
-        else if (propertyName === ArrayType.lengthProperty && (type.name() === ByteArrayClass || type.name() === FixedArrayClass)) {
+        else if (propertyName === ArrayType.lengthProperty && (isIntegerArrayClass(type.name()) || type.name() === FixedArrayClass)) {
           this.assert(readonly, 'cannot change .length', node.property)
           this.result = Integer
           return false  // an uboxed value.
         }
+        else if (propertyName === MapType.sizeProperty && isHashTableClass(type.name())) {
+          this.assert(readonly, 'cannot change .size', node.property)
+          this.result = Integer
+          return false  // an uboxed value.
+        }
         else if (this.firstPass) {
           // forward reference
           this.result = Any
@@ -1617,6 +1733,7 @@ export default class TypeChecker<Info extends NameInfo> extends visitor.NodeVisi
     if (type instanceof InstanceType) {
       const typeAndIndex  = type.findMethod(propertyName)
       if (typeAndIndex) {
+        this.growableArrayReceiver(node, type, names)
         this.result = typeAndIndex[0]
         return true
       }
@@ -1624,6 +1741,7 @@ export default class TypeChecker<Info extends NameInfo> extends visitor.NodeVisi
     else if (type instanceof ArrayType) {
       const method = type.findMethod(propertyName)
       if (method) {
+        this.growableArrayReceiver(node, type, names)
         this.result = method[0]
         return true
       }
@@ -1684,8 +1802,13 @@ export default class TypeChecker<Info extends NameInfo> extends visitor.NodeVisi
 
   tsTypeReference(node: AST.TSTypeReference, names: NameTable<Info>): void {
     this.assertSyntax(AST.isIdentifier(node.typeName), node)
-    this.assertSyntax(node.typeParameters === undefined || node.typeParameters === null, node)
     const name = (node.typeName as AST.Identifier).name
+    if ((name === MapClass || name === SetClass) && node.typeParameters) {
+      this.result = this.hashTableType(name, node.typeParameters.params, node, names)
+      return
+    }
+
+    this.assertSyntax(node.typeParameters === undefined || node.typeParameters === null, node)
     if (name === Float)
       this.result = Float
     else if (name === Integer)
@@ -1709,6 +1832,28 @@ export default class TypeChecker<Info extends NameInfo> extends visitor.NodeVisi
     }
   }
 
+  // Map<K, V> or Set<K>.  It is one of the built-in classes specialized for K and V.
+  private hashTableType(name: string, typeArgNodes: AST.TSType[], node: AST.Node, names: NameTable<Info>): StaticType {
+    const typeArgs = typeArgNodes.map(e => {
+      this.visit(e, names)
+      return this.result
+    })
+
+    const className = hashTableClassName(name, typeArgs)
+    if (className === undefined) {
+      this.assert(false, `${name}<${typeArgs.map(t => typeToString(t)).join(', ')}> is not supported`, node)
+      return Any
+    }
+
+    const info = names.lookup(className)
+    if (info?.isTypeName && info.type instanceof InstanceType)
+      return info.type
+    else {
+      this.assert(false, `internal error: cannot find ${className} type`, node)
+      return Any
+    }
+  }
+
   tsArrayType(node: AST.TSArrayType, names: NameTable<Info>): void {
     this.visit(node.elementType, names)
     const elementType = this.result
@@ -10,7 +10,23 @@ export const Null = 'null'
 export const Any = 'any'
 
 export const ByteArrayClass = 'Uint8Array'    // Uint8Array is also used as byte[].
+export const Int8ArrayClass = 'Int8Array'
+export const Int16ArrayClass = 'Int16Array'
+export const Uint16ArrayClass = 'Uint16Array'
+export const Uint32ArrayClass = 'Uint32Array'
 export const FixedArrayClass = 'FixedArray'
+export const StringBuilderClass = 'StringBuilder'
+export const MapClass = 'Map'
+export const SetClass = 'Set'
+
+// arrays of 8, 16, or 32 bit integers other than Uint8Array.  They do not have methods.
+export const compactArrayClasses = [Int8ArrayClass, Int16ArrayClass, Uint16ArrayClass, Uint32ArrayClass]
+
+// true if name is Uint8Array or the name of a compact array class.
+// The element type of these arrays is integer.
+export function isIntegerArrayClass(name: string) {
+  return name === ByteArrayClass || compactArrayClasses.includes(name)
+}
 
 export type StaticType = 'integer' | 'int32' | 'float' | 'boolean' | 'string' | 'void' | 'null' | 'any' |
   ObjectType | FunctionType | UnionType | EnumType
@@ -145,6 +161,22 @@ export class ArrayType extends ObjectType {
   static readonly unshiftMethod = 'unshift'
   static readonly shiftMethod = 'shift'
 
+  // bulk operations on integer[], float[], and Uint8Array
+  static readonly fillMethod = 'fill'
+  static readonly setMethod = 'set'
+  static readonly addMethod = 'add'
+  static readonly scaleMethod = 'scale'
+  static readonly dotMethod = 'dot'
+  static readonly sumMethod = 'sum'
+  static readonly minMethod = 'min'
+  static readonly maxMethod = 'max'
+
+  // sorting and searching on integer[], float[], Uint8Array, and arrays of objects
+  static readonly sortMethod = 'sort'
+  static readonly binarySearchMethod = 'binarySearch'
+  static readonly indexOfMethod = 'indexOf'
+  static readonly reverseMethod = 'reverse'
+
   elementType: StaticType
 
   constructor(element: StaticType) {
@@ -172,8 +204,17 @@ export class ArrayType extends ObjectType {
   }
 
   findMethod(name: string): [StaticType, number, this] | undefined {
-    if (isPrimitiveType(this.elementType))
-      return undefined  // primitive-type arrays do not have methods
+    if (isPrimitiveType(this.elementType)) {
+      // only integer[] and float[] have methods among primitive-type arrays.
+      if (this.elementType === Integer || this.elementType === Float) {
+        const ops = typedArrayMethods(this, this.elementType)
+        const index = ops.findIndex(op => op[0] === name)
+        if (index >= 0)
+          return [ops[index][1], index, this]
+      }
+
+      return undefined
+    }
     else if (name === ArrayType.pushMethod)
       return [new FunctionType(Integer, [this.elementType]), 0, this]
     else if (name === ArrayType.popMethod)
@@ -182,9 +223,47 @@ export class ArrayType extends ObjectType {
       return [new FunctionType(Integer, [this.elementType]), 2, this]
     else if (name === ArrayType.shiftMethod)
       return [new FunctionType(new UnionType([this.elementType, Null]), []), 3, this]
+    else if (name === ArrayType.sortMethod)
+      return [new FunctionType(this, [this.comparatorType()]), 4, this]
+    else if (name === ArrayType.binarySearchMethod)
+      return [new FunctionType(Integer, [this.elementType, this.comparatorType()]), 5, this]
+    else if (name === ArrayType.indexOfMethod)
+      return [new FunctionType(Integer, [this.elementType]), 6, this]
+    else if (name === ArrayType.reverseMethod)
+      return [new FunctionType(this, []), 7, this]
     else
       return undefined
   }
+
+  // the type of the comparator given to sort() and binarySearch() on an array of objects.
+  comparatorType() {
+    return new FunctionType(Integer, [this.elementType, this.elementType])
+  }
+}
+
+/*
+  The methods of integer[], float[], and Uint8Array.  They are the bulk operations
+  followed by push() and pop(), which are available only on a growable array,
+  and then the sorting and searching methods.
+  arrayType is the type of the receiver and elementType is its element type.
+  The methods are listed in the order of their vtable indexes.
+  They must match the class objects in c-runtime.c.
+*/
+export function typedArrayMethods(arrayType: StaticType, elementType: StaticType): [string, FunctionType][] {
+  return [[ArrayType.fillMethod, new FunctionType(arrayType, [elementType])],
+          [ArrayType.setMethod, new FunctionType(Void, [arrayType, Integer])],
+          [ArrayType.addMethod, new FunctionType(Void, [arrayType])],
+          [ArrayType.scaleMethod, new FunctionType(Void, [elementType])],
+          [ArrayType.dotMethod, new FunctionType(elementType, [arrayType])],
+          [ArrayType.sumMethod, new FunctionType(elementType, [])],
+          [ArrayType.minMethod, new FunctionType(elementType, [])],
+          [ArrayType.maxMethod, new FunctionType(elementType, [])],
+          [ArrayType.pushMethod, new FunctionType(Integer, [elementType])],
+          [ArrayType.popMethod, new FunctionType(elementType, [])],
+          [ArrayType.sortMethod, new FunctionType(arrayType, [])],
+          [ArrayType.binarySearchMethod, new FunctionType(Integer, [elementType])],
+          [ArrayType.indexOfMethod, new FunctionType(Integer, [elementType])],
+          [ArrayType.reverseMethod, new FunctionType(arrayType, [])]]
 }
 
 // This class is used only for holding built-in method names.
@@ -213,6 +292,64 @@ export class StringType {
   }
 }
 
+// This class is used only for holding the method names of StringBuilder.
+// see builtinPropertiesAndMethods in classes.ts
+export class StringBuilderType {
+  static readonly appendMethod = 'append'
+  static readonly toStringMethod = 'toString'
+}
+
+/*
+  Map<K, V> and Set<K> are built-in classes specialized for the types of keys and values,
+  so that the keys and the values are not boxed.  K is integer or string.  V is integer,
+  float, or any.  The class names are given by hashTableClassName().
+  They must match the class objects in c-runtime.c.
+*/
+export class MapType {
+  static readonly sizeProperty = 'size'
+
+  static readonly setMethod = ArrayType.setMethod
+  static readonly getMethod = 'get'
+  static readonly hasMethod = 'has'
+  static readonly deleteMethod = 'delete'
+  static readonly clearMethod = 'clear'
+  static readonly addMethod = ArrayType.addMethod    // only for Set
+}
+
+// the key and value types of the built-in Map and Set classes.  The value type of a Set is undefined.
+const hashTableClasses = new Map<string, [StaticType, StaticType | undefined]>([
+  ['IntIntMap', [Integer, Integer]], ['IntFloatMap', [Integer, Float]], ['IntAnyMap', [Integer, Any]],
+  ['StringIntMap', [StringT, Integer]], ['StringFloatMap', [StringT, Float]], ['StringAnyMap', [StringT, Any]],
+  ['IntSet', [Integer, undefined]], ['StringSet', [StringT, undefined]]])
+
+export function hashTableClassName(generic: string, typeArgs: StaticType[]) {
+  const names = new Map<StaticType, string>([[Integer, 'Int'], [StringT, 'String'], [Float, 'Float'], [Any, 'Any']])
+  let name: string
+  if (generic === MapClass && typeArgs.length === 2)
+    name = `${names.get(typeArgs[0])}${names.get(typeArgs[1])}Map`
+  else if (generic === SetClass && typeArgs.length === 1)
+    name = `${names.get(typeArgs[0])}Set`
+  else
+    return undefined
+
+  return hashTableClasses.has(name) ? name : undefined
+}
+
+// The methods of a Map or Set class.  They are listed in the order of their vtable indexes.
+// clazz is the class and name is its name.
+export function hashTableMethods(clazz: StaticType, name: string): [string, FunctionType][] {
+  const [key, value] = hashTableClasses.get(name)!
+  const common: [string, FunctionType][]
+    = [[MapType.hasMethod, new FunctionType(BooleanT, [key])],
+       [MapType.deleteMethod, new FunctionType(BooleanT, [key])],
+       [MapType.clearMethod, new FunctionType(Void, [])]]
+  if (value === undefined)
+    return [[MapType.addMethod, new FunctionType(clazz, [key])], ...common]
+  else
+    return [[MapType.setMethod, new FunctionType(clazz, [key, value])],
+            [MapType.getMethod, new FunctionType(value, [key])], ...common]
+}
+
 export class UnionType extends CompositeType {
   types: StaticType[]
 
@@ -81,6 +81,7 @@ export class CodeWriter {
   copy() {
     const writer = new CodeWriter()
     writer.indentLevel = this.indentLevel
+    writer.updateIndent(writer.indentLevel)
     return writer
   }
 
@@ -180,6 +180,28 @@ describe('Test single compile: Compiler for Host', () => {
         expect(testEnv.resultSharedLibraryExists()).toBe(true);
     });
 
+    it('should compile index.bs with a library import.', async () => {
+        // index.bs <- lib1, which is not declared as a dependency
+
+        testEnv.createSubPackage('lib1');
+        testEnv.makeLibrary('lib1');
+        testEnv.addSourceFile('lib1', './index.bs', `export function add(a: integer, b:integer) {return a + b}`);
+        testEnv.createMainPackage();
+        testEnv.addSourceFile(testEnv.mainPackageName, './index.bs', `import {add} from 'lib1';\nadd(1, 2);`);
+
+        await compile(testEnv);
+        expect(testEnv.resultSharedLibraryExists()).toBe(true);
+    });
+
+    it('should throw error if an imported package is neither a dependency nor a library.', async () => {
+        testEnv.createSubPackage('package1');
+        testEnv.addSourceFile('package1', './index.bs', `export function add(a: integer, b:integer) {return a + b}`);
+        testEnv.createMainPackage();
+        testEnv.addSourceFile(testEnv.mainPackageName, './index.bs', `import {add} from 'package1';\nadd(1, 2);`);
+
+        await expect(compile(testEnv)).rejects.toThrow(`Cannot fine package. Package name: package1`);
+    });
+
     it('should compile index.bs with an unused package.', async () => {
         testEnv.createSubPackage('package1');
         testEnv.addSourceFile('package1', './index.bs', `export function add(a: integer, b:integer) {return a + b}`);
@@ -9,6 +9,7 @@ class CompilerTestEnv<P extends Package = Package> {
     readonly root: string;
     public readonly mainPackageName: string;
     protected packages = new Map<string, P>();
+    protected libraries = new Map<string, P>();
 
     constructor(name?: string) {
         this.mainPackageName = name ?? 'compiler-test';
@@ -44,10 +45,23 @@ class CompilerTestEnv<P extends Package = Package> {
         }
     }
 
+    // makes a registered package a library shipped with the runtime.
+    // It is read by the library reader without being declared as a dependency.
+    public makeLibrary(packageName: string) {
+        const pkg = this.packages.get(packageName);
+        if (pkg) this.libraries.set(packageName, pkg);
+        else throw new Error(`Package ${packageName} is not registered.`);
+    }
+
+    public getLibraryReader(): (name: string) => P | undefined {
+        return (name: string) => this.libraries.get(name);
+    }
+
     public init() {
         this.delete();
         fs.mkdirSync(this.root, { recursive: true });
         this.packages = new Map<string, P>();
+        this.libraries = new Map<string, P>();
     }
 
     public delete() {
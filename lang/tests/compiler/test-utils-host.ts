@@ -89,7 +89,8 @@ export const compile = async (testEnv: HostUnixCompilerTestEnv | HostWindowsComp
         let toolchain = new HostUnixToolchain(compilerConfig);
         const project = Project.load<PackageForHostUnix>(
             testEnv.mainPackageName,
-            testEnv.getPackageReader() as (name: string) => PackageForHostUnix
+            testEnv.getPackageReader() as (name: string) => PackageForHostUnix,
+            testEnv.getLibraryReader() as (name: string) => PackageForHostUnix | undefined
         );
         const session = new CompilerSession<PackageForHostUnix, SharedLibrary>(toolchain);
         await session.buildProject(project);
@@ -106,7 +107,8 @@ export const compile = async (testEnv: HostUnixCompilerTestEnv | HostWindowsComp
         let toolchain = new HostWindowsToolchain(compilerConfig);
         const project = Project.load<PackageForHostWindows>(
             testEnv.mainPackageName,
-            testEnv.getPackageReader() as (name: string) => PackageForHostWindows
+            testEnv.getPackageReader() as (name: string) => PackageForHostWindows,
+            testEnv.getLibraryReader() as (name: string) => PackageForHostWindows | undefined
         );
         const session = new CompilerSession<PackageForHostWindows, SharedLibrary>(toolchain);
         await session.buildProject(project);
@@ -30,7 +30,7 @@ function add(i, f, b) {
   return b ? i + f : i + f + f;
 }
 
-for(let i = 0; i < 15; i++) {
+for(let i = 0; i < 100; i++) {
   add(1, 3.3, true)
 }
 print(add(1, 3.5, true))
@@ -41,7 +41,7 @@ print(add(1, 3.5, true))
   const file1 = tempCFilePath('file1')
   const result1 = compile(0, src, profiler, file1, result0.names)
   expect(execute([file0, file1], [result1.main], tempCFilePath('file2'), tempExecutableFilePath('bscript')))
-    .toEqual("integer, float, boolean, undefined\n4.500000\n")
+    .toEqual("integer, float, boolean -> float\n4.500000\n")
 })
 
 test('profile: string', () => {
@@ -50,7 +50,7 @@ function ss(s) {
   return 3;
 }
 
-for(let i = 0; i < 15; i++) {
+for(let i = 0; i < 100; i++) {
   ss("hello");
 }
 print(ss("hello"))
@@ -61,7 +61,7 @@ print(ss("hello"))
   const file1 = tempCFilePath('file1')
   const result1 = compile(0, src, profiler, file1, result0.names)
   expect(execute([file0, file1], [result1.main], tempCFilePath('file2'), tempExecutableFilePath('bscript')))
-    .toEqual("string, undefined, undefined, undefined\n3\n")
+    .toEqual("string\n3\n")
 })
 
 test('profile: intarray, floatarray, boolarray', () => {
@@ -73,7 +73,7 @@ function add0(iarr, farr, barr) {
 let iarr = [1, 2, 3];
 let farr = [4.1, 5.1, 6.1];
 let barr = [true, false];
-for(let i = 0; i < 15; i++) {
+for(let i = 0; i < 100; i++) {
   add0(iarr, farr, barr);
 }
 print(add0(iarr, farr, barr));
@@ -84,7 +84,7 @@ print(add0(iarr, farr, barr));
   const file1 = tempCFilePath('file1')
   const result1 = compile(0, src, profiler, file1, result0.names)
   expect(execute([file0, file1], [result1.main], tempCFilePath('file2'), tempExecutableFilePath('bscript')))
-    .toEqual("integer[], float[], boolean[], undefined\n5.100000\n")
+    .toEqual("integer[], float[], boolean[] -> float\n5.100000\n")
 })
 
 test('profile: anyarray, array', () => {
@@ -95,7 +95,7 @@ function aarr0(aarr, arr) {
 
 let aarr:any[] = [1, "foo", 3];
 let arr = ["hello"];
-for(let i = 0; i < 15; i++) {
+for(let i = 0; i < 100; i++) {
   aarr0(aarr, arr);
 }
 print(aarr0(aarr, arr));
@@ -106,7 +106,7 @@ print(aarr0(aarr, arr));
   const file1 = tempCFilePath('file1')
   const result1 = compile(0, src, profiler, file1, result0.names)
   expect(execute([file0, file1], [result1.main], tempCFilePath('file2'), tempExecutableFilePath('bscript')))
-    .toEqual("any[], string[], undefined, undefined\n1\n")
+    .toEqual("any[], string[] -> integer\n1\n")
 })
 
 test('profile: class', () => {
@@ -126,7 +126,7 @@ function area(rect) {
 }
 
 let rect = new Rectangle(11, 4)
-for(let i = 0; i < 15; i++) {
+for(let i = 0; i < 100; i++) {
   area(rect);
 }
 print(area(rect));
@@ -137,7 +137,7 @@ print(area(rect));
   const file1 = tempCFilePath('file1')
   const result1 = compile(0, src, profiler, file1, result0.names)
   expect(execute([file0, file1], [result1.main], tempCFilePath('file2'), tempExecutableFilePath('bscript')))
-    .toEqual("Rectangle, undefined, undefined, undefined\n44\n")
+    .toEqual("Rectangle -> integer\n44\n")
 })
 
 test('profile: class array', () => {
@@ -161,7 +161,7 @@ function areas(rects) {
 }
 
 let rects = [new Rectangle(11, 4), new Rectangle(11, 4), new Rectangle(11, 4)]
-for(let i = 0; i < 15; i++) {
+for(let i = 0; i < 100; i++) {
   areas(rects);
 }
 print(areas(rects));
@@ -172,7 +172,7 @@ print(areas(rects));
   const file1 = tempCFilePath('file1')
   const result1 = compile(0, src, profiler, file1, result0.names)
   expect(execute([file0, file1], [result1.main], tempCFilePath('file2'), tempExecutableFilePath('bscript')))
-    .toEqual("Rectangle[], undefined, undefined, undefined\n132\n")
+    .toEqual("Rectangle[]\n132\n")
 })
 
 test('profile: not profile function with function return type', () => {
@@ -181,7 +181,7 @@ function func(a:()=>integer) {
   return a();
 }
 
-for(let i = 0; i < 15; i++) {
+for(let i = 0; i < 100; i++) {
   func(()=>3)
 }
   `
@@ -200,7 +200,7 @@ function add(a:integer, b:integer) {
   return a + b;
 }
 
-for(let i = 0; i < 15; i++) {
+for(let i = 0; i < 100; i++) {
   add(1, 3)
 }
   `
@@ -215,12 +215,12 @@ for(let i = 0; i < 15; i++) {
 
 test('profile: not profile with too many params', () => {
   const src = `
-function add(a, b, c, d, e) {
-  return a + b + c + d + e;
+function add(a, b, c, d, e, f, g, h, k) {
+  return a + b + c + d + e + f + g + h + k;
 }
 
-for(let i = 0; i < 15; i++) {
-  add(1, 2, 3, 4, 5)
+for(let i = 0; i < 100; i++) {
+  add(1, 2, 3, 4, 5, 6, 7, 8, 9)
 }
   `
   const profiler = new Profiler()
@@ -249,7 +249,7 @@ function add(a, b) {
   return a + b + 2;
 }
 
-for(let i = 0; i < 15; i++) {
+for(let i = 0; i < 100; i++) {
   add(1, 3)
 }
 print(add(1, 3))
@@ -263,7 +263,7 @@ print(add(1, 3))
   const file2 = tempCFilePath('file2')
   const result2 = compile(1, src2, profiler, file2, result1.names)
   expect(execute([file0, file1, file2], [result1.main, result2.main], tempCFilePath('file4'), tempExecutableFilePath('bscript')))
-    .toEqual(`4\ninteger, integer, undefined, undefined\n6\n`)
+    .toEqual(`4\ninteger, integer -> integer\n6\n`)
 })
 
 
@@ -534,4 +534,86 @@ print(add(4, 5))
   const result4 = compile(3, src4, profiler, file4, result3.names)
   expect(execute([file0, file1, file2, file3, file4], [result1.main, result2.main, result3.main, result4.main], tempCFilePath('file5'), tempExecutableFilePath('bscript')))
     .toEqual(`9\nExecute specialized function\n9\nExecute specialized function\n11\n`)
-})
\ No newline at end of file
+})
+
+test('jit compile: multiple versions', () => {
+  const src1 = `
+function add(a, b) {
+  return a + b
+}
+print(add(4, 5))
+  `
+
+  const src4 = `
+print(add(4, 5))
+print(add(1.5, 2))
+print(add("a", "b"))
+  `
+
+  const profiler = new Profiler()
+  const file0 = tempCFilePath('file0')
+  const result0 = initialCompile(file0);
+  const file1 = tempCFilePath('file1')
+  const result1 = compile(0, src1, profiler, file1, result0.names)
+
+  const func = profiler.getFunctionProfileById(0);
+  if (func === undefined)
+    throw new Error(`Cannot find func.`)
+  profiler.setFuncSpecializedType(0, ["integer", "integer"].map(t => typeStringToStaticType(t, result1.names)))
+
+  const file2 = tempCFilePath('file2')
+  const result2 = compile(1, func.src, profiler, file2, result1.names)
+
+  // the second version is added for the calls that the first version does not accept.
+  profiler.setFuncSpecializedType(0, ["float", "integer"].map(t => typeStringToStaticType(t, result2.names)))
+  const file3 = tempCFilePath('file3')
+  const result3 = compile(2, func.src, profiler, file3, result2.names)
+
+  const file4 = tempCFilePath('file4')
+  const result4 = compile(3, src4, profiler, file4, result3.names)
+  expect(execute([file0, file1, file2, file3, file4], [result1.main, result2.main, result3.main, result4.main], tempCFilePath('file5'), tempExecutableFilePath('bscript')))
+    .toEqual(`9\nExecute specialized function\n9\nExecute specialized function\n3.500000\nExecute original function\nab\n`)
+  expect(func.versions.map(v => v.version)).toEqual([0, 1])
+})
+
+test('jit compile: no profiling after a function with versions becomes megamorphic', () => {
+  const src1 = `
+function add(a, b) {
+  return a + b
+}
+print(add(4, 5))
+  `
+
+  const src4 = `
+print(add(4, 5))
+print(add("a", "b"))
+  `
+
+  const profiler = new Profiler()
+  const file0 = tempCFilePath('file0')
+  const result0 = initialCompile(file0);
+  const file1 = tempCFilePath('file1')
+  const result1 = compile(0, src1, profiler, file1, result0.names)
+
+  const func = profiler.getFunctionProfileById(0);
+  if (func === undefined)
+    throw new Error(`Cannot find func.`)
+  profiler.setFuncSpecializedType(0, ["integer", "integer"].map(t => typeStringToStaticType(t, result1.names)))
+
+  const file2 = tempCFilePath('file2')
+  const result2 = compile(1, func.src, profiler, file2, result1.names)
+  expect(result2.code).toMatch(/bs_profiler_profile\(/)
+
+  // the wrapper is compiled again without profiling the calls that no version accepts.
+  profiler.setFuncMegamorphic(0)
+  expect(func.state.state).toBe('specializing')
+  const file3 = tempCFilePath('file3')
+  const result3 = compile(2, func.src, profiler, file3, result2.names)
+  expect(func.state.state).toBe('specialized')
+  expect(result3.code).not.toMatch(/bs_profiler_profile/)
+
+  const file4 = tempCFilePath('file4')
+  const result4 = compile(3, src4, profiler, file4, result3.names)
+  expect(execute([file0, file1, file2, file3, file4], [result1.main, result2.main, result3.main, result4.main], tempCFilePath('file5'), tempExecutableFilePath('bscript')))
+    .toEqual(`9\nExecute specialized function\n9\nExecute original function\nab\n`)
+})
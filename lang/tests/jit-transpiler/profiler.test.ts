@@ -0,0 +1,73 @@
+import {expect, test} from "@jest/globals";
+import {maxVersionNum, Profiler} from "../../src/jit-transpiler/profiler";
+import {Any, ArrayType, BooleanT, Float, FunctionType, Integer, StringT} from "../../src/transpiler/types";
+
+
+function makeProfiler() {
+  const profiler = new Profiler()
+  const func = profiler.setFunctionProfile('add', 'function add(a, b: integer) { return a + b }',
+                                           new FunctionType(Any, [Any, Integer]))
+  return { profiler, func }
+}
+
+test('specialized versions', () => {
+  const { profiler, func } = makeProfiler()
+  profiler.setFuncSpecializedType(func.id, [Integer])
+  expect(func.state.state).toBe('specializing')
+  expect(func.versions.map(v => v.type.paramTypes)).toEqual([[Integer, Integer]])
+
+  profiler.setFunctionState('add', {state: 'specialized'})
+  profiler.setFuncSpecializedType(func.id, [Integer])
+  expect(func.state.state).toBe('specialized')
+  expect(func.versions.length).toBe(1)
+
+  profiler.setFuncSpecializedType(func.id, [Float])
+  expect(func.state.state).toBe('specializing')
+  expect(func.versions.map(v => v.version)).toEqual([0, 1])
+
+  // the versions are kept when the other calls are megamorphic.
+  profiler.setFuncMegamorphic(func.id)
+  expect(func.state.state).toBe('specializing')
+  expect(func.versions.length).toBe(2)
+})
+
+test('a megamorphic function with versions is compiled again', () => {
+  const { profiler, func } = makeProfiler()
+  profiler.setFuncSpecializedType(func.id, [Integer])
+  profiler.setFunctionState('add', {state: 'specialized'})
+  profiler.setFuncMegamorphic(func.id)
+  expect(func.megamorphic).toBe(true)
+  expect(func.state.state).toBe('specializing')
+
+  // no more version is added.
+  profiler.setFunctionState('add', {state: 'specialized'})
+  profiler.setFuncSpecializedType(func.id, [Float])
+  profiler.setFuncMegamorphic(func.id)
+  expect(func.state.state).toBe('specialized')
+  expect(func.versions.length).toBe(1)
+})
+
+test('a cold version is replaced', () => {
+  const { profiler, func } = makeProfiler()
+  const types = [Integer, Float, BooleanT, StringT]
+  expect(types.length).toBe(maxVersionNum)
+  for (const t of types)
+    profiler.setFuncSpecializedType(func.id, [t])
+
+  profiler.addVersionHits(func.id, 0, 1024)
+  profiler.addVersionHits(func.id, 1, 1024)
+  profiler.addVersionHits(func.id, 3, 1024)
+  profiler.setFuncSpecializedType(func.id, [new ArrayType(Integer)])
+  expect(func.versions.map(v => v.version)).toEqual([0, 1, 3, 4])
+
+  profiler.addVersionHits(func.id, 4, 1024)
+  profiler.setFuncSpecializedType(func.id, [new ArrayType(Float)])
+  expect(func.versions.map(v => v.version)).toEqual([0, 1, 3, 4])
+  expect(func.versions.map(v => v.hits)).toEqual([1024, 1024, 1024, 1024])
+})
+
+test('undoing a function without versions', () => {
+  const { profiler, func } = makeProfiler()
+  profiler.setFuncMegamorphic(func.id)
+  expect(func.state.state).toBe('undoing')
+})
@@ -291,6 +291,26 @@ test('string declaration', () => {
   expect(compileAndRun(src)).toBe("foo\n3.000000\nbar\n")
 })
 
+test('string literals evaluated many times', () => {
+  const src = `
+  function foo(n: integer) {
+    let s = ''
+    let a: any[] = []
+    for (let i = 0; i < n; i++) {
+      s = 'foo'
+      a = [s, 'bar', 'foo', i]
+    }
+    print(s)
+    print(a[0] + a[1] + a[2])
+    print(a[0] == 'foo')
+  }
+  foo(10000)
+  foo(3)
+  `
+
+  expect(compileAndRun(src)).toBe("foo\nfoobarfoo\ntrue\nfoo\nfoobarfoo\ntrue\n")
+})
+
 test('mixed type declaration', () => {
   const src = `
   function foo(n: integer) {
@@ -816,6 +836,21 @@ test('string equality', () => {
   expect(compileAndRun(src)).toBe(toBoolean([1, 0, 0, 1, 1, 1, 0, 0, 0, 0, 1, 1]).join('\n') + '\n')
 })
 
+test('equality of concatenated strings', () => {
+  const src = `
+  function foo(m: string, n: any) {
+    const s = m + n
+    print(s == 'foo12')
+    print(s == 'foo13')
+    print(s == 'foo1')
+    print(s.length)
+  }
+  foo('foo', 12)
+  foo('fo', 'o13')
+`
+  expect(compileAndRun(src)).toBe(toBoolean([1, 0, 0]).join('\n') + '\n5\n' + toBoolean([0, 1, 0]).join('\n') + '\n5\n')
+})
+
 test('basic binary operators', () => {
   const src = `
   function foo(m: integer, n: float) {
@@ -2418,6 +2453,57 @@ test('super class with unboxed properties only', () => {
   expect(compileAndRun(src)).toBe(['bar', 11, 17, 'baz', 111, 333].join('\n') + '\n')
 })
 
+test('property and method accesses to any-type objects of a deep class hierarchy', () => {
+  const src = `
+  class A {
+    a1: integer
+    a2: string
+    a3: float
+    constructor() { this.a1 = 1; this.a2 = 'a2'; this.a3 = 3.5 }
+    foo() { return 10 }
+    bar() { return 20 }
+  }
+
+  class B extends A {
+    b1: string
+    b2: integer
+    constructor() { super(); this.b1 = 'b1'; this.b2 = 2 }
+    bar() { return 21 }
+    baz() { return 30 }
+  }
+
+  class C extends B {
+    c1: any
+    c2: integer
+    c3: integer
+    constructor() { super(); this.c1 = 'c1'; this.c2 = 12; this.c3 = 13 }
+    foo() { return 11 }
+    qux() { return 40 }
+  }
+
+  const obj: any = new C()
+  print(obj.a1)
+  print(obj.a2)
+  print(obj.a3)
+  print(obj.b1)
+  print(obj.b2)
+  print(obj.c1)
+  print(obj.c2)
+  print(obj.c3)
+  obj.a1 = 101
+  obj.b2 = 102
+  obj.c3 = 103
+  print(obj.a1 + obj.b2 + obj.c3)
+  print(obj.foo())
+  print(obj.bar())
+  print(obj.baz())
+  print(obj.qux())
+`
+
+  expect(compileAndRun(src)).toBe(['1', 'a2', '3.500000', 'b1', 2, 'c1', 12, 13, 306,
+    11, 21, 30, 40].join('\n') + '\n')
+})
+
 test('bad property access to an object of any type', () => {
   const src = `
   class Foo {
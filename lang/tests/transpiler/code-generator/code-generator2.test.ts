@@ -1,4 +1,5 @@
 import { execSync } from 'child_process'
+import * as fs from 'fs'
 import { compileAndRun, multiCompileAndRun, importAndCompileAndRun, importAndMultiCompileAndRun, transpileAndWrite, toBoolean } from './test-code-generator'
 import { expect, test, beforeAll } from '@jest/globals'
 import { GlobalVariableNameTable } from '../../../src/transpiler/code-generator/variables'
@@ -2123,3 +2124,592 @@ test('consistency between any[] and specific arrays and method calls', () => {
 
   expect(() => compileAndRun(src, destFile)).toThrow(/runtime type error.*anyarray/)
 })
+
+test('string concatenation in a loop', () => {
+  const src = `
+  function foo(n: integer) {
+    let s = ''
+    for (let i = 0; i < n; i++)
+      s = s + i % 10
+    return s
+  }
+  const s = foo(1000)
+  print(s.length)
+  print(s.substring(990, 1000))
+  print(s.endsWith('789'))
+  print(s == foo(1000))
+  `
+
+  expect(compileAndRun(src, destFile)).toBe('1000\n0123456789\ntrue\ntrue\n')
+})
+
+test('StringBuilder', () => {
+  const src = `
+  function foo(n: integer) {
+    const sb = new StringBuilder()
+    for (let i = 0; i < n; i++)
+      sb.append(i % 10).append(',')
+    return sb.toString()
+  }
+  const s = foo(100)
+  print(s.length)
+  print(s.substring(0, 6))
+  const sb: any = new StringBuilder()
+  sb.append('x').append(3.5)
+  print(sb.toString())
+  `
+
+  expect(compileAndRun(src, destFile)).toBe('200\n0,1,2,\nx3.5\n')
+})
+
+test('substrings of a command line', () => {
+  const src = `
+  function parse(line: string) {
+    let start = 0
+    let count = 0
+    for (let i = 0; i <= line.length; i++) {
+      const word = line.substring(start, i)
+      if (word.endsWith(' ') || i == line.length) {
+        const w = word.endsWith(' ') ? word.substring(0, word.length - 1) : word
+        if (w.startsWith('-'))
+          print(w.substring(1, w.length))
+        else
+          print(w)
+        start = i
+        count++
+      }
+    }
+    return count
+  }
+  print(parse('set -led 12 -color red'))
+  `
+
+  expect(compileAndRun(src, destFile)).toBe('set\nled\n12\ncolor\nred\n5\n')
+})
+
+test('array accesses in counted loops', () => {
+  const src = `
+  const N = 4
+  function sum(a: integer[]) {
+    let s = 0
+    for (let i = 0; i < a.length; i++)
+      s += a[i]
+    return s
+  }
+  function scale(a: float[], b: float[], coef: float[], start: integer) {
+    for (let i = start; i < N; i++)
+      b[i] = a[i - 1] * coef[2] + coef[0]
+  }
+  function count(flags: boolean[]) {
+    let n = 0
+    for (let i = 0; i < flags.length - 1; ++i)
+      if (flags[i + 1])
+        n++
+    return n
+  }
+  print(sum([1, 2, 3, 4]))
+  const b = [0.0, 0.0, 0.0, 0.0]
+  scale([1.0, 2.0, 3.0, 4.0], b, [0.5, 0.0, 2.5], 1)
+  print(b[0])
+  print(b[3])
+  print(count([true, true, false, true]))
+  `
+
+  expect(compileAndRun(src, destFile)).toBe('10\n0.000000\n8.000000\n2\n')
+
+  const src2 = `
+  function sum(a: integer[], n: integer) {
+    let s = 0
+    for (let i = 0; i < n; i++)
+      s += a[i]
+    return s
+  }
+  print(sum([1, 2, 3], 2))
+  print(sum([1, 2, 3], 4))
+  `
+
+  expect(() => compileAndRun(src2, destFile)).toThrow(/array index out of range/)
+})
+
+test('nested counted loops are not duplicated', () => {
+  const src = `
+  function total(m: integer[], rows: integer, cols: integer) {
+    let s = 0
+    for (let i = 0; i < rows; i++)
+      for (let j = 0; j < cols; j++)
+        s += m[j] * i
+    return s
+  }
+  print(total([1, 2, 3], 3, 3))
+  `
+
+  expect(transpile(1, src).code.match(/for \(/g)?.length).toBe(2)
+  expect(compileAndRun(src, destFile)).toBe('18\n')
+  expect(() => compileAndRun(src.replace('[1, 2, 3], 3, 3', '[1, 2, 3], 3, 4'), destFile)).toThrow(/array index out of range/)
+})
+
+test('loop-invariant values in loops', () => {
+  const src = `
+  class Counter {
+    n: integer
+    constructor() { this.n = 0 }
+    inc(k: integer) { this.n += k; return this.n }
+  }
+  function evens(a: integer[], n: integer) {
+    let s = 0
+    let m = 0
+    while (m < n) {
+      s += a[2 * m]
+      m++
+    }
+    return s
+  }
+  function count(c: Counter, times: integer) {
+    let r = 0
+    for (let i = 0; i < times; i++)
+      r = c.inc(2)
+    return r
+  }
+  function total(v: any, n: integer) {
+    let s = 0.0
+    let j = 0
+    do {
+      const f = v as float[]
+      s += f[j]
+      j++
+    } while (j < n)
+    return s
+  }
+  function skip(a: integer[], n: integer) {
+    let s = 0
+    for (let i = 0; i < n; i += 2)
+      s += a[i * 3]
+    return s
+  }
+  let empty: integer[]
+  print(evens([1, 2, 3, 4, 5, 6], 3))
+  print(count(new Counter(), 5))
+  print(total([1.5, 2.5, 3.0], 3))
+  print(skip(empty, 0))
+  `
+
+  expect(compileAndRun(src, destFile)).toBe('9\n10\n7.000000\n0\n')
+
+  const src2 = `
+  function total(v: any, n: integer) {
+    let s = 0
+    for (let i = 0; i < n; i++) {
+      print(i)
+      const f = v as integer[]
+      s += f[i]
+    }
+    return s
+  }
+  print(total([1, 2], 0))
+  print(total('foo', 1))
+  `
+
+  expect(() => compileAndRun(src2, destFile)).toThrow(/runtime type error/)
+
+  const src3 = `
+  function evens(a: integer[], n: integer) {
+    let s = 0
+    for (let m = 0; m < n; m++)
+      s += a[2 * m]
+    return s
+  }
+  print(evens([1, 2, 3], 3))
+  `
+
+  expect(() => compileAndRun(src3, destFile)).toThrow(/array index out of range/)
+})
+
+test('bulk operations on typed arrays', () => {
+  const src = `
+  const a = new Array<integer>(10, 2)
+  const b = [1, 2, 3, 4, 5, 6, 7, 8, 9, 10]
+  a.add(b)
+  a.scale(3)
+  print(a.sum())
+  print(a.dot(b))
+  print(a.fill(-1).min())
+  a.set([7, 8], 8)
+  print(a.max())
+  const f = [0.5, 1.5, -2.0, 4.0]
+  print(f.sum())
+  print(f.dot(f))
+  const u = new Uint8Array(5, 100)
+  u.scale(3)
+  print(u.max())
+  const v: any = b
+  print(v.sum())
+  `
+
+  expect(compileAndRun(src, destFile)).toBe('225\n1485\n-1\n8\n4.000000\n22.500000\n44\n55\n')
+
+  const src2 = `
+  const a = [1, 2, 3]
+  a.add([1, 2])
+  `
+
+  expect(() => compileAndRun(src2, destFile)).toThrow(/array index out of range/)
+
+  const src3 = `
+  const f: float[] = []
+  print(f.min())
+  `
+
+  expect(() => compileAndRun(src3, destFile)).toThrow(/array index out of range/)
+})
+
+test('an array used as a queue', () => {
+  const src = `
+  const q: any[] = []
+  let sum = 0
+  for (let i = 0; i < 1000; i++) {
+    q.push(i)
+    if (i % 3 == 0) {
+      const v: integer = q.shift()
+      sum += v
+    }
+  }
+  q.unshift(-1)
+  print(q.length)
+  print(sum)
+  print(q[0])
+  print(q[1])
+  print(q[q.length - 1])
+  while (q.length > 1)
+    q.pop()
+  print(q[0])
+  `
+
+  expect(compileAndRun(src, destFile)).toBe('667\n55611\n-1\n334\n999\n-1\n')
+})
+
+test('growable typed arrays', () => {
+  const src = `
+  const a: integer[] = []
+  for (let i = 0; i < 100; i++)
+    a.push(i * 2)
+
+  let sum = 0
+  for (let i = 0; i < a.length; i++)
+    sum += a[i]
+
+  print(a.length)
+  print(sum)
+  print(a.pop())
+  const f = [1.5, 2.5]
+  f.push(3.0)
+  print(f.sum())
+  print(f.length)
+  const u = new Uint8Array(2, 7)
+  u.push(300)
+  print(u[2])
+  print(u.length)
+  const c: integer[] = []
+  for (let i = 0; i < 10; i++)
+    c.push(i)
+
+  print(c.sum())
+  `
+
+  expect(compileAndRun(src, destFile)).toBe('100\n9900\n198\n7.000000\n3\n44\n3\n45\n')
+
+  // a function called in a loop grows the array accessed in the loop.
+  const src2 = `
+  const g: integer[] = []
+  for (let k = 0; k < 8; k++)
+    g.push(10 + k)
+
+  function grow() { g.push(g.length) }
+
+  let t = 0
+  for (let i = 0; i < 5; i++) {
+    grow()
+    t += g[i]
+  }
+
+  print(t)
+  print(g.length)
+  print(g[12])
+  `
+
+  expect(compileAndRun(src2, destFile)).toBe('60\n13\n12\n')
+
+  const src3 = `
+  function add(b: integer[]) { b.push(4) }
+  const a = [1, 2, 3]
+  add(a)
+  `
+
+  // the array passed to a parameter may be a fixed-length array.
+  expect(() => compileAndRun(src3, destFile)).toThrow(/push\(\) is not available on a parameter/)
+
+  const src4 = `
+  const a: integer[] = []
+  a.pop()
+  `
+
+  expect(() => compileAndRun(src4, destFile)).toThrow(/array index out of range/)
+})
+
+test('Int8Array, Int16Array, Uint16Array, and Uint32Array', () => {
+  const src = `
+  const a = new Int8Array(4, 0)
+  a[0] = 127
+  a[0] += 1
+  a[1] = 200
+  print(a[0])
+  print(a[1])
+  print(a.length)
+  const s = new Int16Array(100, -3)
+  let sum = 0
+  for (let i = 0; i < s.length; i++)
+    sum += s[i]
+
+  print(sum)
+  const u = new Uint16Array(3, 70000)
+  u[2] = -1
+  print(u[0])
+  print(u[2])
+  const w = new Uint32Array(2, 7)
+  w[1] = w[0] * 3
+  print(w[1])
+  const x: any = u
+  x[1] = 65537
+  print(x[1])
+  print(x.length)
+  print(x instanceof Uint16Array)
+  `
+
+  expect(compileAndRun(src, destFile)).toBe('-128\n-56\n4\n-300\n4464\n65535\n21\n1\n3\ntrue\n')
+
+  const src2 = `
+  const a = new Int16Array(3, 0)
+  print(a[3])
+  `
+
+  expect(() => compileAndRun(src2, destFile)).toThrow(/array index out of range/)
+})
+
+test('array literals of constants and array copies', () => {
+  const src = `
+  function table(): integer[] { return [3, -1, 4, 1, 5, 9, 2, 6] }
+
+  const t = table()
+  t[0] = 100
+  print(table()[0])
+  print(t.sum())
+  const f = [0.5, -1.25, 2.0, 4, 1e2]
+  print(f.sum())
+  const x = 7
+  const g = [1, 2, x, 4]
+  print(g[2])
+  const s = ['a', 'b', 'c']
+  s.unshift('z')
+  const s2 = new Array<string>(s)
+  print(s2[0] + s2[3] + s2.length)
+  const a = new Array<any>(t)
+  print(a[7])
+  `
+
+  expect(compileAndRun(src, destFile)).toBe('3\n126\n105.250000\n7\nzc4\n6\n')
+})
+
+test('read-only constant arrays', () => {
+  const src = `
+  const table = [3, -1, 4, 1, 5, 9, 2, 6]
+  const weights: float[] = [0.5, 0.25, 0.125, 0.125]
+
+  function dot(a: integer[], w: float[]) {
+    let s = 0.0
+    for (let i = 0; i < w.length; i++)
+      s += a[i] * w[i]
+    return s
+  }
+
+  let sum = 0
+  for (let i = 0; i < table.length; i++)
+    sum += table[i]
+
+  print(sum)
+  print(dot(table, weights))
+  print(table.max())
+  const copy = new Array<integer>(table)
+  copy[0] = 10
+  print(copy[0] + table[0])
+  const t2: any = table
+  print(t2[7])
+  `
+
+  expect(compileAndRun(src, destFile)).toBe('29\n1.875000\n9\n13\n6\n')
+
+  const src2 = `
+  const table = [3, -1, 4, 1, 5, 9, 2, 6]
+  function clear(a: integer[]) {
+    for (let i = 0; i < a.length; i++)
+      a[i] = 0
+  }
+
+  clear(table)
+  `
+
+  expect(() => compileAndRun(src2, destFile)).toThrow(/read-only array/)
+
+  const src3 = `
+  const table = [3.0, -1.0, 4.0, 1.0]
+  let k = 2
+  table[k] += 1.0
+  `
+
+  expect(() => compileAndRun(src3, destFile)).toThrow(/read-only array/)
+
+  const src4 = `
+  const table = [3, -1, 4, 1, 5, 9, 2, 6]
+  table.fill(0)
+  `
+
+  expect(() => compileAndRun(src4, destFile)).toThrow(/read-only array/)
+})
+
+test('element assignments check read-only arrays only when needed', () => {
+  const src = `
+  function make(n: integer, k: integer) {
+    const a = new Array<integer>(n, 0)
+    a[k] = 3
+    return a
+  }
+
+  function set(a: integer[], k: integer) {
+    a[k] = 4
+  }
+
+  const b = make(4, 1)
+  set(b, 2)
+  print(b[1] + b[2])
+  `
+
+  expect(compileAndRun(src, destFile)).toBe('7\n')
+
+  // a in make() never holds a read-only array but a in set() may.
+  const code = transpile(0, src).code
+  expect(code.match(/gc_intarray_lval\(/g)?.length).toBe(1)
+})
+
+test('Map and Set', () => {
+  const src = `
+  const squares = new Map<integer, integer>()
+  for (let i = 0; i < 100; i++)
+    squares.set(i, i * i)
+
+  for (let i = 0; i < 100; i += 2)
+    squares.delete(i)
+
+  let found = 0
+  for (let i = 0; i < 100; i++)
+    if (squares.has(i))
+      found += squares.get(i)
+
+  print(squares.size)
+  print(found)
+
+  const prices = new Map<string, float>()
+  prices.set('apple', 1.5).set('orange', 0.25)
+  prices.set('apple', 2.0)
+  print(prices.get('apple') + prices.get('orange'))
+  print(prices.size)
+
+  const names = new Set<string>()
+  const words = ['one', 'two', 'one', 'three', 'two']
+  for (let i = 0; i < words.length; i++)
+    names.add(words[i])
+
+  print(names.size)
+  names.clear()
+  print(names.size)
+  if (!names.has('one'))
+    print('cleared')
+
+  const m = new Map<integer, any>()
+  m.set(3, 'three')
+  print(m.get(3))
+  print(m.get(4))
+  `
+
+  expect(compileAndRun(src, destFile)).toBe('50\n166650\n2.250000\n2\n3\n0\ncleared\nthree\nundefined\n')
+
+  const src2 = `
+  const m = new Map<integer, integer>()
+  m.set(1, 10)
+  print(m.get(2))
+  `
+
+  expect(() => compileAndRun(src2, destFile)).toThrow(/no such key/)
+
+  const src3 = `
+  const m = new Map<boolean, integer>()
+  `
+
+  expect(() => compileAndRun(src3, destFile)).toThrow(/is not supported/)
+
+  const src4 = `
+  const m = new Set<integer>()
+  m.size = 3
+  `
+
+  expect(() => compileAndRun(src4, destFile)).toThrow(/cannot change .size/)
+})
+
+test('sort and search on arrays', () => {
+  const src = `
+  let a = [5, -3, 8, 1, 9, 2, 7, 1]
+  a.sort()
+  print(a[0] + ' ' + a[7])
+  print(a.binarySearch(7))
+  print(a.binarySearch(3))
+  print(a.indexOf(1))
+  a.reverse()
+  print(a[0])
+
+  let f = [2.5, -1.0, 0.5]
+  print(f.sort()[0])
+  print(f.indexOf(2.5))
+
+  const b = new Uint8Array(4, 0)
+  b[0] = 200; b[1] = 3; b[2] = 90
+  b.sort()
+  print(b[3])
+
+  const words = ['pear', 'apple', 'fig', 'banana']
+  const byLength = (x: string, y: string) => x.length - y.length
+  words.sort(byLength)
+  print(words[0] + ' ' + words[3])
+  print(words.binarySearch('kiwi', byLength))
+  print(words.indexOf('apple'))
+  print(words.reverse()[0])
+  `
+
+  expect(compileAndRun(src, destFile)).toBe('-3 9\n5\n-5\n1\n9\n-1.000000\n2\n200\nfig banana\n1\n2\nbanana\n')
+
+  const src2 = `
+  const table = [3, -1, 4, 1, 5, 9, 2, 6]
+  table.sort()
+  `
+
+  expect(() => compileAndRun(src2, destFile)).toThrow(/read-only array/)
+})
+
+test('method name codes in the precompiled std-module.c', () => {
+  // std-module.c must be generated again when a name is added to builtinPropertiesAndMethods in classes.ts.
+  const mnames = (code: string) => code.match(/static const uint16_t mnames_\w+\[\] = \{[^}]*\};/g)
+  for (const [bs, c] of [['../microcontroller/ports/host/std-module.bs', '../microcontroller/ports/host/std-module.c'],
+                         ['../microcontroller/ports/esp32/std-module.bs', '../microcontroller/ports/esp32/main/std-module.c']]) {
+    const result = transpile(0, fs.readFileSync(bs).toString())
+    const table = result.names.classTable()
+    const compiled = fs.readFileSync(c).toString()
+    expect(compiled).toContain(`mnames_Console[] = { ${table.encodeName('log')}, ${table.encodeName('error')}, };`)
+    expect(mnames(compiled)).toEqual(mnames(result.code))
+  }
+})
@@ -170,6 +170,34 @@ test('bad index type', () => {
   expect(() => tested.transpile(src)).toThrow()
 })
 
+test('push() and pop() on an array that may be fixed-length', () => {
+  const src = `const a: integer[] = []
+  a.push(3)
+  let b = [1, 2]
+  b = [3, 4, 5]
+  b.pop()`
+
+  expect(() => tested.transpile(src)).not.toThrow()
+
+  const src2 = `function foo(a: integer[]) { a.push(3) }`
+  expect(() => tested.transpile(src2)).toThrow(/push\(\) is not available on a parameter/)
+
+  const src3 = `const a = [1, 2]
+  const b: integer[] = a
+  b.pop()`
+  expect(() => tested.transpile(src3)).toThrow(/pop\(\) is not available/)
+
+  const src4 = `let a: integer[] = []
+  a.push(3)
+  function foo(b: integer[]) { a = b }`
+  expect(() => tested.transpile(src4)).toThrow(/may not be assigned/)
+
+  const src5 = `class Foo { items: integer[] = [] }
+  const f = new Foo()
+  f.items.push(3)`
+  expect(() => tested.transpile(src5)).toThrow(/available only on a variable/)
+})
+
 test('duplicated parameter names', () => {
   const src = `function foo(a: number, b, a) { return a }`
   expect(() => tested.transpile(src)).toThrow()
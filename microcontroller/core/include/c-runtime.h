@@ -44,18 +44,28 @@ struct object_type {
 
 typedef struct object_type* pointer_t;
 
+// an element of a flattened property table.
+struct property_entry {
+    const uint16_t name;        // property name
+    const uint16_t index;       // the index of the property
+    const char type;            // the type of the unboxed property, or ' ' if it is boxed.
+};
+
 struct property_table {
     const uint16_t size;        // the number of properties declared in this class.
     const uint16_t offset;      // the index of the first property
     const uint16_t unboxed;     // 1 + the maximum index of the unboxed properties
     const uint16_t* const prop_names;   // property names
     const char* const unboxed_types; // the types of unboxed properties
+    const uint16_t all_size;    // the number of properties including inherited ones.
+    const struct property_entry* const all_props;   // all the properties sorted by names, or NULL.
 };
 
 struct method_table {
     const uint16_t size;        // the number of methods declared in this class.
     const uint16_t* const names;         // method names
     const char* const* const signatures; // method pointers
+    const uint16_t* const sorted;        // method indexes sorted by method names, or NULL.
 };
 
 typedef struct class_object {
@@ -81,9 +91,34 @@ inline int32_t value_to_int(value_t v) { return (int32_t)v / 4; }
 inline value_t int_to_value(int32_t v) { return (uint32_t)v << 2; }
 inline bool is_int_value(value_t v) { return (v & 3) == 0; }
 
-extern float CR_SECTION value_to_float(value_t v);
-extern value_t CR_SECTION float_to_value(float v);
+extern float CR_SECTION value_to_float_slow(value_t v);
+extern value_t CR_SECTION float_to_value_slow(float f);
+
+// A float value is a 32bit float whose exponent is narrowed to 6 bits.
+// Normal numbers, 2^-30 <= |f| < 2^32, are converted by only shifting
+// and adding an offset to the exponent.  The others, such as zero, infinity,
+// and subnormal numbers, are converted by the slow paths.
+inline value_t float_to_value(float f) {
+    union { float f; uint32_t u; } v = { .f = f };
+    uint32_t abs = v.u & 0x7FFFFFFFu;
+    if (abs - 0x30800000u < 0x4F800000u - 0x30800000u)
+        return (v.u & 0x80000000u) | ((abs - 0x30000000u) << 2) | 1;
+    else
+        return float_to_value_slow(f);
+}
+
+inline float value_to_float(value_t v) {
+    if ((v & 0x7E000000u) - 0x02000000u < 0x7C000000u) {
+        union { uint32_t u; float f; } f = { .u = (v & 0x80000000u) | (((v & 0x7FFFFFFCu) >> 2) + 0x30000000u) };
+        return f.f;
+    }
+    else
+        return value_to_float_slow(v);
+}
+
 inline bool is_float_value(value_t v) { return (v & 3) == 1; }
+extern void CR_SECTION floats_to_values(value_t* dest, const float* src, int32_t n);
+extern void CR_SECTION values_to_floats(float* dest, const value_t* src, int32_t n);
 
 #ifdef LINUX64
 extern pointer_t gc_heap_pointer(pointer_t ptr);
@@ -190,6 +225,18 @@ inline value_t gc_new_object(const class_object* clazz) {
     return ptr_to_value(gc_allocate_object(clazz));
 }
 
+// the length of an array loaded before a loop.  It is 0 if obj is null (or undefined)
+// since the loop body may not be executed.  index is the position of the length in the object.
+inline int32_t gc_length_or_zero(value_t obj, int index) {
+    return obj == VALUE_NULL ? 0 : value_to_ptr(obj)->body[index];
+}
+
+// the same as gc_length_or_zero() except that it is 0 also if obj is a growable array.
+extern int32_t CR_SECTION gc_fixed_length_or_zero(value_t obj, int index);
+
+// the same as gc_fixed_length_or_zero() except that it is 0 also if obj is a read-only array.
+extern int32_t CR_SECTION gc_writable_length_or_zero(value_t obj, int index);
+
 inline value_t get_obj_property(value_t obj, int index) {
     return value_to_ptr(obj)->body[index];
 }
@@ -230,36 +277,142 @@ extern value_t CR_SECTION gc_new_int_box(int32_t value);
 extern value_t CR_SECTION gc_new_float_box(float value);
 
 extern value_t CR_SECTION gc_new_string(char* str);
+extern value_t CR_SECTION gc_static_string(value_t* cache, const char* str, int32_t len, uint32_t hash);
+
+// A string literal that is not allocated in the heap memory.
+// STATIC_STRING declares it and STATIC_STRING_VALUE obtains its value.
+// str must be a string literal in C and hash is its hash code computed in advance.
+// The garbage collector does not manage it.  On microcontrollers, it is a constant object
+// in the read-only data section.  The declaration requires
+// extern CLASS_OBJECT(string_literal, 1) in advance.
+#ifdef LINUX64
+#define STATIC_STRING(name, str, hash)  static value_t name = 0; static const char name##_cstr[] = str; \
+                                        static const uint32_t name##_hash = hash
+#define STATIC_STRING_VALUE(name)   (name != 0 ? name : gc_static_string(&name, name##_cstr, sizeof(name##_cstr) - 1, name##_hash))
+#else
+#define STATIC_STRING(name, str, hash)  static ALGIN const struct { uint32_t header; const char* str; int32_t len; uint32_t hash; } name \
+                                        = { (uint32_t)&string_literal.clazz, str, sizeof(str) - 1, hash }
+#define STATIC_STRING_VALUE(name)   ((value_t)(uintptr_t)&name | 3)
+#endif
+
 extern bool CR_SECTION gc_is_string_object(value_t obj);
 extern const char* CR_SECTION gc_string_to_cstr(value_t obj);
 extern int32_t CR_SECTION gc_string_length(value_t obj);
 extern char* CR_SECTION gc_any_to_cstring(char* p, value_t obj);
+
+// the buffer size large enough for gc_int_to_cstring() etc.
+#define NUMBER_STRING_SIZE  56
+extern char* CR_SECTION gc_int_to_cstring(char* p, int32_t n);
+extern char* CR_SECTION gc_float_to_cstring(char* p, float f);
+extern char* CR_SECTION gc_float_to_fixed_cstring(char* p, float f);
+
 extern value_t CR_SECTION gc_new_String(value_t s1, value_t s2);
+extern value_t CR_SECTION gc_new_string_builder();
+extern value_t CR_SECTION gc_string_builder_append(value_t self, value_t v);
+extern value_t CR_SECTION gc_string_builder_to_string(value_t self);
 
 extern value_t CR_SECTION safe_value_to_intarray(bool nullable, value_t v);
 extern value_t CR_SECTION gc_new_intarray(int32_t n, int32_t init_value);
 extern value_t CR_SECTION gc_copy_intarray(value_t array);
 extern value_t CR_SECTION gc_make_intarray(int32_t n, ...);
+extern value_t CR_SECTION gc_make_intarray_from(int32_t n, const int32_t* elements);
 extern int32_t CR_SECTION gc_intarray_length(value_t obj);
 extern int32_t* CR_SECTION gc_intarray_get(value_t obj, int32_t index);
+// the address of the first element.  The code generator uses it
+// only when it has checked the range of indexes before a loop.
+extern int32_t* CR_SECTION gc_intarray_base(value_t obj);
+// an element access through the address of the first element and the length loaded before a loop.
+// If the index is out of range, it calls gc_intarray_get() to report an error.
+inline int32_t* gc_intarray_elem(value_t obj, int32_t* base, int32_t len, int32_t index) {
+    return (uint32_t)index < (uint32_t)len ? &base[index] : gc_intarray_get(obj, index);
+}
+extern int32_t* CR_SECTION gc_intarray_lval(value_t obj, int32_t index);
+inline int32_t* gc_intarray_elem_lval(value_t obj, int32_t* base, int32_t len, int32_t index) {
+    return (uint32_t)index < (uint32_t)len ? &base[index] : gc_intarray_lval(obj, index);
+}
 extern bool CR_SECTION gc_is_intarray(value_t v);
 
 extern value_t CR_SECTION safe_value_to_floatarray(bool nullable, value_t v);
 extern value_t CR_SECTION gc_new_floatarray(int32_t n, float init_value);
 extern value_t CR_SECTION gc_copy_floatarray(value_t array);
 extern value_t CR_SECTION gc_make_floatarray(int32_t n, ...);
+extern value_t CR_SECTION gc_make_floatarray_from(int32_t n, const float* elements);
 extern int32_t CR_SECTION gc_floatarray_length(value_t obj);
 extern float* CR_SECTION gc_floatarray_get(value_t obj, int32_t index);
+extern float* CR_SECTION gc_floatarray_base(value_t obj);
+inline float* gc_floatarray_elem(value_t obj, float* base, int32_t len, int32_t index) {
+    return (uint32_t)index < (uint32_t)len ? &base[index] : gc_floatarray_get(obj, index);
+}
+extern float* CR_SECTION gc_floatarray_lval(value_t obj, int32_t index);
+inline float* gc_floatarray_elem_lval(value_t obj, float* base, int32_t len, int32_t index) {
+    return (uint32_t)index < (uint32_t)len ? &base[index] : gc_floatarray_lval(obj, index);
+}
 extern bool CR_SECTION gc_is_floatarray(value_t v);
 
+// A read-only integer[] or float[] object that is not allocated in the heap memory.
+// STATIC_INTARRAY or STATIC_FLOATARRAY declares it and STATIC_ARRAY_VALUE obtains its value.
+// n is the number of elements and the rest of the arguments are the elements.
+// The garbage collector does not manage it.  On microcontrollers, it is a constant object
+// in the read-only data section.  The declaration requires
+// extern CLASS_OBJECT(readonly_intarray, 1) or extern CLASS_OBJECT(readonly_floatarray, 1) in advance.
+extern value_t CR_SECTION gc_static_intarray(value_t* cache, int32_t n, const int32_t* elements);
+extern value_t CR_SECTION gc_static_floatarray(value_t* cache, int32_t n, const float* elements);
+#ifdef LINUX64
+#define STATIC_INTARRAY(name, n, ...)   static value_t name = 0; static const int32_t name##_elements[n] = { __VA_ARGS__ }; \
+                                        static value_t name##_make() { return gc_static_intarray(&name, n, name##_elements); }
+#define STATIC_FLOATARRAY(name, n, ...) static value_t name = 0; static const float name##_elements[n] = { __VA_ARGS__ }; \
+                                        static value_t name##_make() { return gc_static_floatarray(&name, n, name##_elements); }
+#define STATIC_ARRAY_VALUE(name)        (name != 0 ? name : name##_make())
+#else
+#define STATIC_INTARRAY(name, n, ...)   static ALGIN const struct { uint32_t header; int32_t len; int32_t elements[n]; } name \
+                                        = { (uint32_t)&readonly_intarray.clazz, n, { __VA_ARGS__ } }
+#define STATIC_FLOATARRAY(name, n, ...) static ALGIN const struct { uint32_t header; int32_t len; float elements[n]; } name \
+                                        = { (uint32_t)&readonly_floatarray.clazz, n, { __VA_ARGS__ } }
+#define STATIC_ARRAY_VALUE(name)        ((value_t)(uintptr_t)&name | 3)
+#endif
+
 extern value_t CR_SECTION safe_value_to_boolarray(bool nullable, value_t v);
 extern value_t CR_SECTION gc_new_bytearray(bool is_boolean, int32_t n, int32_t init_value);
 extern value_t CR_SECTION gc_copy_bytearray(bool is_boolean, value_t array);
 extern value_t CR_SECTION gc_make_bytearray(bool is_boolean, int32_t n, ...);
 extern int32_t CR_SECTION gc_bytearray_length(value_t obj);
 extern uint8_t* CR_SECTION gc_bytearray_get(value_t obj, int32_t index);
+extern const uint8_t* CR_SECTION gc_bytes_of(value_t obj, int32_t* len);
+extern uint8_t* CR_SECTION gc_bytearray_base(value_t obj);
+inline uint8_t* gc_bytearray_elem(value_t obj, uint8_t* base, int32_t len, int32_t index) {
+    return (uint32_t)index < (uint32_t)len ? &base[index] : gc_bytearray_get(obj, index);
+}
 extern bool CR_SECTION gc_is_boolarray(value_t v);
 
+// Int8Array, Int16Array, Uint16Array, and Uint32Array.
+// The elements of Uint32Array are accessed as int32_t.
+extern value_t CR_SECTION gc_new_int8array(int32_t n, int32_t init_value);
+extern int8_t* CR_SECTION gc_int8array_get(value_t obj, int32_t index);
+extern int8_t* CR_SECTION gc_int8array_base(value_t obj);
+inline int8_t* gc_int8array_elem(value_t obj, int8_t* base, int32_t len, int32_t index) {
+    return (uint32_t)index < (uint32_t)len ? &base[index] : gc_int8array_get(obj, index);
+}
+extern value_t CR_SECTION gc_new_int16array(int32_t n, int32_t init_value);
+extern int16_t* CR_SECTION gc_int16array_get(value_t obj, int32_t index);
+extern int16_t* CR_SECTION gc_int16array_base(value_t obj);
+inline int16_t* gc_int16array_elem(value_t obj, int16_t* base, int32_t len, int32_t index) {
+    return (uint32_t)index < (uint32_t)len ? &base[index] : gc_int16array_get(obj, index);
+}
+extern value_t CR_SECTION gc_new_uint16array(int32_t n, int32_t init_value);
+extern uint16_t* CR_SECTION gc_uint16array_get(value_t obj, int32_t index);
+extern uint16_t* CR_SECTION gc_uint16array_base(value_t obj);
+inline uint16_t* gc_uint16array_elem(value_t obj, uint16_t* base, int32_t len, int32_t index) {
+    return (uint32_t)index < (uint32_t)len ? &base[index] : gc_uint16array_get(obj, index);
+}
+extern value_t CR_SECTION gc_new_uint32array(int32_t n, int32_t init_value);
+extern int32_t* CR_SECTION gc_uint32array_get(value_t obj, int32_t index);
+extern int32_t* CR_SECTION gc_uint32array_base(value_t obj);
+inline int32_t* gc_uint32array_elem(value_t obj, int32_t* base, int32_t len, int32_t index) {
+    return (uint32_t)index < (uint32_t)len ? &base[index] : gc_uint32array_get(obj, index);
+}
+
+extern value_t CR_SECTION gc_new_growable_array(value_t array);
+
 extern value_t CR_SECTION safe_value_to_fixedarray(bool nullable, value_t v);
 extern value_t CR_SECTION gc_new_fixedarray(int32_t n, value_t init_value);
 extern int32_t CR_SECTION gc_fixedarray_length(value_t obj);
@@ -267,6 +420,9 @@ extern value_t CR_SECTION gc_fixedarray_get(value_t obj, int32_t index);
 extern value_t CR_SECTION gc_fixedarray_set(value_t obj, int32_t index, value_t new_value);
 extern value_t CR_SECTION gc_make_fixedarray(int32_t n, ...);
 
+// makes a Map or Set object.  clazz is class_IntIntMap, class_StringSet, etc.
+extern value_t CR_SECTION gc_new_hash_table(const class_object* clazz);
+
 extern bool CR_SECTION gc_is_instance_of_array(value_t obj);
 extern value_t CR_SECTION safe_value_to_anyarray(bool nullable, value_t v);
 extern value_t CR_SECTION safe_anyarray_to_anyarrayobj(value_t v);
@@ -281,6 +437,10 @@ extern int32_t gc_array_push(value_t obj, value_t new_value);
 extern value_t gc_array_pop(value_t obj);
 extern int32_t gc_array_unshift(value_t obj, value_t new_value);
 extern value_t gc_array_shift(value_t obj);
+extern value_t gc_array_sort(value_t obj, value_t compare);
+extern int32_t gc_array_binary_search(value_t obj, value_t v, value_t compare);
+extern int32_t gc_array_index_of(value_t obj, value_t v);
+extern value_t gc_array_reverse(value_t obj);
 
 extern int32_t CR_SECTION get_all_array_length(value_t obj);
 extern value_t CR_SECTION get_anyobj_length_property(value_t obj, int property);
@@ -6,16 +6,66 @@
 
 #ifdef LINUX64
 typedef uint64_t typeint_t;
-#define CORE_TEXT_SECTION 
-#define CORE_DATA_SECTION 
+#define CORE_TEXT_SECTION
+#define CORE_DATA_SECTION
 #else
 typedef uint32_t typeint_t;
 #define CORE_TEXT_SECTION __attribute__((section(".core_text")))
 #define CORE_DATA_SECTION __attribute__((section(".core_data")))
 #endif
 
+// The maximum number of any-type parameters profiled per function.
+// It must be equal to maxParamNum in lang/src/jit-transpiler/profiler.ts.
+#ifndef BS_PROFILER_MAX_PARAMS
+#define BS_PROFILER_MAX_PARAMS     8
+#endif
 
-void CORE_TEXT_SECTION bs_profiler_profile(uint8_t fid, uint8_t* call_count, typeint_t** type_profile, value_t p1, value_t p2, value_t p3, value_t p4);
+// The maximum number of type combinations recorded per function.
+#ifndef BS_PROFILER_MAX_ROWS
+#define BS_PROFILER_MAX_ROWS       8
+#endif
 
-#endif /* __BS_PROFILER__ */
+// The number of functions profiled at the same time.
+#ifndef BS_PROFILER_MAX_PROFILES
+#define BS_PROFILER_MAX_PROFILES   8
+#endif
 
+// The size of the ring buffer holding the profile records.  It must be a power of 2.
+#ifndef BS_PROFILER_BUFFER_SIZE
+#define BS_PROFILER_BUFFER_SIZE    512
+#endif
+
+// The maximum number of bytes read by bs_profiler_read() at a time.
+// It must be large enough to hold the largest record.
+#define BS_PROFILER_BATCH_SIZE     128
+
+// The number of calls to a specialized version of a function between two reports of the calls.
+#ifndef BS_PROFILER_HITS_INTERVAL
+#define BS_PROFILER_HITS_INTERVAL  1024
+#endif
+
+// The maximum number of classes reported by the profiler.
+#ifndef BS_PROFILER_MAX_CLASSES
+#define BS_PROFILER_MAX_CLASSES    64
+#endif
+
+typedef struct bs_profiler_config {
+    uint16_t call_threshold;    // the number of calls before profiling starts
+    uint16_t type_threshold;    // the number of calls with the same types needed for specialization
+    uint16_t max_samples;       // a function is megamorphic if no types are dominant after this number of calls
+    uint8_t dominance;          // the percentage of the profiled calls that the dominant types must account for
+    uint8_t rows;               // the number of type combinations recorded (<= BS_PROFILER_MAX_ROWS)
+} bs_profiler_config;
+
+typedef struct bs_type_profile bs_type_profile;
+
+void CORE_TEXT_SECTION bs_profiler_configure(const bs_profiler_config* config);
+void CORE_TEXT_SECTION bs_profiler_profile(uint8_t fid, uint16_t* call_count, bs_type_profile** type_profile,
+                                           uint8_t n, const value_t* params);
+void CORE_TEXT_SECTION bs_profiler_profile_return(bs_type_profile** type_profile, value_t result);
+void CORE_TEXT_SECTION bs_profiler_count_hits(uint8_t fid, uint8_t version, uint16_t* hits);
+uint32_t CORE_TEXT_SECTION bs_profiler_read(uint8_t* buffer, uint32_t size);
+uint32_t CORE_TEXT_SECTION bs_profiler_dropped();
+void CORE_TEXT_SECTION bs_profiler_reset();
+
+#endif /* __BS_PROFILER__ */
@@ -13,7 +13,7 @@ void CORE_TEXT_SECTION bs_protocol_write_log(char* message);
 
 void CORE_TEXT_SECTION bs_protocol_write_error(char* message);
 
-void CORE_TEXT_SECTION bs_protocol_write_profile(uint8_t fid, char* profile);
+void CORE_TEXT_SECTION bs_protocol_write_profile(uint8_t* records, uint32_t len);
 
 void CORE_TEXT_SECTION bs_protocol_write_execution_time(int32_t id, float time);
 
@@ -0,0 +1,21 @@
+#ifndef __BS_SAMPLER__
+#define __BS_SAMPLER__
+
+#include <stdint.h>
+
+// The number of program counters that the ring buffer holds.  It must be a power of 2.
+#ifndef BS_SAMPLER_BUFFER_SIZE
+#define BS_SAMPLER_BUFFER_SIZE    1024
+#endif
+
+/*
+  A ring buffer of the program counters sampled by a timer.
+  bs_sampler_record() may be called by a signal handler or an interrupt handler
+  while the other functions are called by a single thread.
+*/
+void bs_sampler_record(uintptr_t pc);
+uint32_t bs_sampler_read(uintptr_t* buffer, uint32_t size);
+uint32_t bs_sampler_dropped();
+void bs_sampler_reset();
+
+#endif /* __BS_SAMPLER__ */
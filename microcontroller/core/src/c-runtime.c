@@ -96,6 +96,30 @@ static inline value_t raw_ptr_to_value(const void* v) { return (value_t)v; }
 
 static value_t heap_memory[HEAP_SIZE];
 
+#ifdef LINUX64
+// memory for string literals that are not managed by the garbage collector.
+// See gc_static_string().
+#define STATIC_STRINGS_NUM      256
+static value_t static_strings[STATIC_STRINGS_NUM * 4];
+static value_t* static_string_caches[STATIC_STRINGS_NUM];
+static uint32_t static_strings_num = 0;
+
+// memory for read-only arrays.  See gc_static_array().
+#define STATIC_ARRAYS_NUM       64
+#define STATIC_ARRAYS_SIZE      (1024 * 4)  // words
+static value_t static_arrays[STATIC_ARRAYS_SIZE];
+static value_t* static_array_caches[STATIC_ARRAYS_NUM];
+static uint32_t static_arrays_num = 0;
+static uint32_t static_arrays_used = 0;
+#endif
+
+// true if the object is allocated in the heap memory.
+// Otherwise, it is a static object such as a string literal, and
+// the garbage collector must not mark it.
+static inline bool gc_is_heap_object(pointer_t obj) {
+    return heap_memory <= (value_t*)obj && (value_t*)obj < heap_memory + HEAP_SIZE;
+}
+
 #ifdef LINUX64
 pointer_t gc_heap_pointer(pointer_t ptr) {
     return (pointer_t)((uint64_t)heap_memory & MASK64H | (uint64_t)ptr & MASK32);
@@ -190,7 +214,11 @@ typedef union { uint32_t u; float f; } float_or_uint;
 const uint32_t FLOAT_TAG = 0x1u;
 const float_or_uint ENCODE_MULT = { 0x0F800000u };
 
-value_t float_to_value(float f) {
+// the slow paths of float_to_value() and value_to_float() in c-runtime.h.
+// They scale a float by ENCODE_MULT so that the hardware rounds
+// subnormal numbers.
+
+value_t float_to_value_slow(float f) {
     if (isnan(f)) {
         return 0x7F000000u | FLOAT_TAG;
     }
@@ -204,7 +232,7 @@ value_t float_to_value(float f) {
     }
 }
 
-float value_to_float(value_t v) {
+float value_to_float_slow(value_t v) {
     if ((v | ~0x7E000000) == 0xFFFFFFFF) {
         // inf, -inf, NaN
         float_or_uint f;
@@ -216,6 +244,53 @@ float value_to_float(value_t v) {
     }
 }
 
+/*
+  converts n floats into float values.
+  The first loop has no branch so that a compiler can vectorize it.
+  It also records whether a float is out of the range of normal numbers.
+  Such floats are converted again by the slow path.
+*/
+void floats_to_values(value_t* dest, const float* src, int32_t n) {
+    uint32_t out_of_range = 0;
+    for (int32_t i = 0; i < n; i++) {
+        uint32_t u;
+        memcpy(&u, &src[i], sizeof(u));
+        uint32_t abs = u & 0x7FFFFFFFu;
+        out_of_range |= abs - 0x30800000u >= 0x4F800000u - 0x30800000u;
+        dest[i] = (u & 0x80000000u) | ((abs - 0x30000000u) << 2) | FLOAT_TAG;
+    }
+
+    if (out_of_range)
+        for (int32_t i = 0; i < n; i++) {
+            uint32_t u;
+            memcpy(&u, &src[i], sizeof(u));
+            if ((u & 0x7FFFFFFFu) - 0x30800000u >= 0x4F800000u - 0x30800000u)
+                dest[i] = float_to_value_slow(src[i]);
+        }
+}
+
+/*
+  converts n values into floats.  Like floats_to_values(), the first loop has no branch.
+  Integers and floats out of the range of normal numbers are converted
+  again by safe_value_to_float(), which throws an error if a value is not a number.
+*/
+void values_to_floats(float* dest, const value_t* src, int32_t n) {
+    uint32_t irregular = 0;
+    for (int32_t i = 0; i < n; i++) {
+        value_t v = src[i];
+        irregular |= ((v & 3) != 1) | ((v & 0x7E000000u) - 0x02000000u >= 0x7C000000u);
+        uint32_t u = (v & 0x80000000u) | (((v & 0x7FFFFFFCu) >> 2) + 0x30000000u);
+        memcpy(&dest[i], &u, sizeof(u));
+    }
+
+    if (irregular)
+        for (int32_t i = 0; i < n; i++) {
+            value_t v = src[i];
+            if ((v & 3) != 1 || (v & 0x7E000000u) - 0x02000000u >= 0x7C000000u)
+                dest[i] = safe_value_to_float(v);
+        }
+}
+
 float safe_value_to_float(value_t v) {
     if (is_float_value(v))
         return value_to_float(v);
@@ -338,12 +413,17 @@ value_t any_power(value_t a, value_t b) {
 
 double double_power(double a, double b) { return pow(a, b); }
 
+static bool gc_string_equals(value_t a, value_t b);
+static int32_t gc_string_compare(value_t a, value_t b);
+static void flatten_string_pair(value_t a, value_t b);
+
 bool any_eq(value_t a, value_t b) {
-    if (gc_is_string_object(a))
-        return gc_is_string_object(b)
-            && strcmp(gc_string_to_cstr(a), gc_string_to_cstr(b)) == 0;
+    if (a == b)
+        return true;
+    else if (gc_is_string_object(a))
+        return gc_is_string_object(b) && gc_string_equals(a, b);
     else
-        return a == b;
+        return false;
 }
 
 #define ANY_CMP_FUNC(name, op) \
@@ -361,7 +441,7 @@ bool any_##name(value_t a, value_t b) {\
             return value_to_float(a) op value_to_float(b);\
     }\
     else if (gc_is_string_object(a) && gc_is_string_object(b))\
-        return strcmp(gc_string_to_cstr(a), gc_string_to_cstr(b)) op 0;\
+        return gc_string_compare(a, b) op 0;\
     return runtime_type_error("bad operand for " #op);\
 }
 
@@ -457,6 +537,14 @@ void gc_initialize() {
     gc_root_set_head = NULL;
 #ifdef LINUX64
     initialize_pointer_table();
+    for (uint32_t i = 0; i < static_strings_num; i++)
+        *static_string_caches[i] = 0;
+
+    static_strings_num = 0;
+    for (uint32_t i = 0; i < static_arrays_num; i++)
+        *static_array_caches[i] = 0;
+
+    static_arrays_num = static_arrays_used = 0;
 #endif
 }
 
@@ -524,8 +612,8 @@ void* gc_method_lookup(value_t obj, uint32_t index) {
 // t is an object accessible by the [] operator.
 #define IS_ARRAY_TYPE(clazz)    (clazz != NULL && (clazz)->array_type_name != NULL)
 
-#define DEFAULT_PTABLE      { .size = 0, .offset = 0, .unboxed = 0, .prop_names = NULL, .unboxed_types = NULL }
-#define DEFAULT_MTABLE      { .size = 0, .names = NULL, .signatures = NULL }
+#define DEFAULT_PTABLE      { .size = 0, .offset = 0, .unboxed = 0, .prop_names = NULL, .unboxed_types = NULL, .all_size = 0, .all_props = NULL }
+#define DEFAULT_MTABLE      { .size = 0, .names = NULL, .signatures = NULL, .sorted = NULL }
 
 CLASS_OBJECT(object_class, 1) = {
     .clazz = { .size = 0, .start_index = 0, .name = "object", .superclass = NULL, .array_type_name = NULL, .table = DEFAULT_PTABLE, .mtable = DEFAULT_MTABLE }};
@@ -545,10 +633,41 @@ pointer_t gc_allocate_object(const class_object* clazz) {
     return obj;
 }
 
+// a binary search on a flattened property table.
+// It returns -1 if the property is not found.
+static int find_sorted_property(const struct property_table* table, int property, char* type) {
+    const struct property_entry* props = table->all_props;
+    int low = 0;
+    int high = table->all_size - 1;
+    while (low <= high) {
+        int mid = (low + high) / 2;
+        int name = props[mid].name;
+        if (name == property) {
+            *type = props[mid].type;
+            return props[mid].index;
+        }
+        else if (name < property)
+            low = mid + 1;
+        else
+            high = mid - 1;
+    }
+
+    return -1;
+}
+
 static int get_anyobj_property2(const class_object* clazz, int property, char* type) {
     if (clazz == NULL)
         runtime_type_error("no such property is found");
 
+    if (clazz->table.all_props != NULL) {
+        // the table includes the properties declared in the super classes.
+        int index = find_sorted_property(&clazz->table, property, type);
+        if (index < 0)
+            runtime_type_error("no such property is found");
+
+        return index;
+    }
+
     const uint16_t size = clazz->table.size;
     const uint16_t* names = clazz->table.prop_names;
     for (int i = 0; i < size; i++)
@@ -745,76 +864,198 @@ value_t gc_new_float_box(float value) {
 }
 
 // string object
+//
+// All kinds of string objects, a string literal, a String object, a rope, and a slice,
+// hold the length of the string in body[1] and its hash code in body[2].
+// The hash code is lazily computed.  It is 0 if it has not been computed yet.
+
+#define STRING_LENGTH_INDEX     1
+#define STRING_HASH_INDEX       2
+
+static inline int32_t string_object_length(value_t obj) {
+    return (int32_t)value_to_ptr(obj)->body[STRING_LENGTH_INDEX];
+}
+
+// FNV-1a.  lang/src/transpiler/code-generator/c-runtime.ts computes the same hash code
+// for a string literal.
+static uint32_t string_hash(const char* str, int32_t len) {
+    uint32_t h = 0x811c9dc5;
+    for (int32_t i = 0; i < len; i++)
+        h = (h ^ (uint8_t)str[i]) * 0x01000193;
+
+    return h == 0 ? 1 : h;
+}
+
+static const char* flat_string_chars(value_t obj);
+static bool gc_is_string_rope(value_t obj);
+
+static uint32_t gc_string_hash(value_t obj) {
+    pointer_t objp = value_to_ptr(obj);
+    uint32_t h = objp->body[STRING_HASH_INDEX];
+    if (h == 0) {
+        if (gc_is_string_rope(obj))
+            gc_string_to_cstr(obj);
+
+        h = string_hash(flat_string_chars(obj), objp->body[STRING_LENGTH_INDEX]);
+        if (gc_is_heap_object(objp))    // a static object may be in read-only memory.
+            objp->body[STRING_HASH_INDEX] = h;
+    }
+
+    return h;
+}
+
+// a and b must be string objects.
+static bool gc_string_equals(value_t a, value_t b) {
+    int32_t len = string_object_length(a);
+    if (len != string_object_length(b))
+        return false;
+
+    flatten_string_pair(a, b);
+    if (gc_string_hash(a) != gc_string_hash(b))
+        return false;
+    else
+        return memcmp(flat_string_chars(a), flat_string_chars(b), len) == 0;
+}
+
+// a and b must be string objects.  It returns a negative value, 0, or a positive value
+// as strcmp() does.
+static int32_t gc_string_compare(value_t a, value_t b) {
+    int32_t len = string_object_length(a);
+    int32_t len2 = string_object_length(b);
+    flatten_string_pair(a, b);
+    int32_t r = memcmp(flat_string_chars(a), flat_string_chars(b), len < len2 ? len : len2);
+    return r == 0 ? len - len2 : r;
+}
 
 static int32_t string_starts_with(value_t self, value_t prefix) {
-    const char* str = gc_string_to_cstr(self);
-    const char* pre = gc_string_to_cstr(prefix);
-    return strncmp(str, pre, strlen(pre)) == 0;
+    int32_t len = string_object_length(prefix);
+    if (len > string_object_length(self))
+        return false;
+
+    flatten_string_pair(self, prefix);
+    return memcmp(flat_string_chars(self), flat_string_chars(prefix), len) == 0;
 }
 
 static int32_t string_ends_with(value_t self, value_t suffix) {
-    const char* str = gc_string_to_cstr(self);
-    const char* suf = gc_string_to_cstr(suffix);
-    int32_t len = strlen(str);
-    int32_t len2 = strlen(suf);
+    int32_t len = string_object_length(self);
+    int32_t len2 = string_object_length(suffix);
     if (len2 > len)
         return false;
 
-    return strncmp(str + len - len2, suf, len2) == 0;
+    flatten_string_pair(self, suffix);
+    return memcmp(flat_string_chars(self) + len - len2, flat_string_chars(suffix), len2) == 0;
 }
 
 static pointer_t make_string_object(int32_t len);
+static value_t make_string_slice(value_t str, int32_t offset, int32_t len);
 
+// this does not copy characters.  It returns a slice of the string.
 static value_t string_substring(value_t self, int32_t start, int32_t end) {
-    ROOT_SET(rootset, 1)
-    rootset.values[0] = self;
-    const char* str = gc_string_to_cstr(self);
-    int32_t len = strlen(str);
+    int32_t len = string_object_length(self);
     if (start < 0)
         start = 0;
-    if (end < 0)
+    if (end < 0 || end > len)
         end = len;
+    if (start > end)
+        start = end;
 
-    pointer_t obj = make_string_object(end - start);
-    char* buf = (char*)&obj->body[1];
-    for (int i = start; i < end; i++)
-        *buf++ = str[i];
-
-    *buf = '\0';
-    DELETE_ROOT_SET(rootset)
-    return ptr_to_value(obj);
+    return make_string_slice(self, start, end - start);
 }
 
-// string_literal is a class for objects that contain a pointer to a C string.
+// string_literal is a class for objects that contain a pointer to a C string,
+// its length, and its hash code.
 // This C string is not allocated in the heap memory managed by the garbage collector.
+// This class is not static since STATIC_STRING in c-runtime.h refers to it.
+
+CLASS_OBJECT(string_literal, 3) = {
+    .body = { .s = 3, .i = SIZE_NO_POINTER, .cn = "string", .sc = NULL, .an = NULL, .pt = DEFAULT_PTABLE,
+              .mt = { .size = 3,
+                      .names = (const uint16_t[]){ /* startsWith */ 1, /* endsWith */ 2, /* substring */ 3, },
+                      .signatures = (const char* const[]){ "(s)b", "(s)b", "(ii)s" },
+                      .sorted = (const uint16_t[]){ 0, 1, 2 } },
+              .vtbl = { string_starts_with, string_ends_with, string_substring } }};
 
-static CLASS_OBJECT(string_literal, 3) = {
-    .body = { .s = 1, .i = SIZE_NO_POINTER, .cn = "string", .sc = NULL, .an = NULL, .pt = DEFAULT_PTABLE,
+// a rope is a lazily concatenated string.  See gc_new_String().
+// body[0] is not used.  body[1] and body[2] are the length and the hash code.
+// body[3] and body[4] are the left and right operands.  The right operand is
+// never a rope that has not been flattened.
+// When a rope is flattened, body[3] is set to the resulting String object
+// and body[4] is set to VALUE_UNDEF.
+static CLASS_OBJECT(string_rope, 3) = {
+    .body = { .s = 5, .i = 3, .cn = "String", .sc = &object_class.clazz, .an = NULL, .pt = DEFAULT_PTABLE,
               .mt = { .size = 3,
                       .names = (const uint16_t[]){ /* startsWith */ 1, /* endsWith */ 2, /* substring */ 3, },
-                      .signatures = (const char* const[]){ "(s)b", "(s)b", "(ii)s" } },
+                      .signatures = (const char* const[]){ "(s)b", "(s)b", "(ii)s" },
+                      .sorted = (const uint16_t[]){ 0, 1, 2 } },
               .vtbl = { string_starts_with, string_ends_with, string_substring } }};
 
+#define ROPE_LEFT_INDEX         3
+#define ROPE_RIGHT_INDEX        4
+
+// a concatenated string is a rope if its length is more than or equal to this.
+#define ROPE_MIN_LENGTH         32
+
+// a slice is a substring sharing the characters with its parent.  See string_substring().
+// body[0] is the offset in the parent.  body[1] and body[2] are the length and the hash code.
+// body[3] is the parent, a string literal or a String object.
+// When a C string is needed and the slice does not end at the end of its parent,
+// the slice is materialized; body[3] is set to a String object holding a copy of
+// the characters and body[0] is set to 0.
+static CLASS_OBJECT(string_slice, 3) = {
+    .body = { .s = 4, .i = 3, .cn = "String", .sc = &object_class.clazz, .an = NULL, .pt = DEFAULT_PTABLE,
+              .mt = { .size = 3,
+                      .names = (const uint16_t[]){ /* startsWith */ 1, /* endsWith */ 2, /* substring */ 3, },
+                      .signatures = (const char* const[]){ "(s)b", "(s)b", "(ii)s" },
+                      .sorted = (const uint16_t[]){ 0, 1, 2 } },
+              .vtbl = { string_starts_with, string_ends_with, string_substring } }};
+
+#define SLICE_OFFSET_INDEX      0
+#define SLICE_PARENT_INDEX      3
+
 static CLASS_OBJECT(class_String, 3) = {
     .body = { .s = -1, .i = SIZE_NO_POINTER, .cn = "String", .sc = &object_class.clazz, .an = NULL, .pt = DEFAULT_PTABLE,
               .mt = { .size = 3,
                       .names = (const uint16_t[]){ /* startsWith */ 1, /* endsWith */ 2, /* substring */ 3, },
-                      .signatures = (const char* const[]){ "(s)b", "(s)b", "(ii)s" } },
+                      .signatures = (const char* const[]){ "(s)b", "(s)b", "(ii)s" },
+                      .sorted = (const uint16_t[]){ 0, 1, 2 } },
               .vtbl = { string_starts_with, string_ends_with, string_substring } }};
 
 // str: a char array in the C language.
 value_t gc_new_string(char* str) {
+    int32_t len = strlen(str);
 #ifdef LINUX64
     str = (char*)record_64bit_pointer(str);
 #endif
     pointer_t obj = gc_allocate_object(&string_literal.clazz);
     obj->body[0] = raw_ptr_to_value(str);
+    obj->body[STRING_LENGTH_INDEX] = len;
+    obj->body[STRING_HASH_INDEX] = 0;
     return ptr_to_value(obj);
 }
 
-// true if this is a string literal object.
-static bool gc_is_string_literal(value_t obj) {
-    return gc_get_class_of(obj) == &string_literal.clazz;
+// returns a string literal object that the garbage collector does not manage.
+// This is called only on LINUX64; the object is allocated once and recorded in *cache.
+// See STATIC_STRING_VALUE in c-runtime.h.  On microcontrollers, the object is statically
+// allocated in the read-only data section.
+// It throws an error if there is no room for the object.  Otherwise, a new heap
+// object would be allocated every time the string literal is evaluated.
+// len: the length of str.
+// hash: the hash code of str or 0.
+value_t gc_static_string(value_t* cache, const char* str, int32_t len, uint32_t hash) {
+#ifdef LINUX64
+    if (static_strings_num >= STATIC_STRINGS_NUM)
+        return runtime_memory_allocation_error("too many string literals");
+
+    pointer_t obj = (pointer_t)&static_strings[static_strings_num * 4];
+    static_string_caches[static_strings_num++] = cache;
+    set_object_header(obj, &string_literal.clazz);
+    obj->body[0] = raw_ptr_to_value(record_64bit_pointer(str));
+    obj->body[STRING_LENGTH_INDEX] = len;
+    obj->body[STRING_HASH_INDEX] = hash;
+    return *cache = ptr_to_value(obj);
+#else
+    return *cache = gc_new_string((char*)str);
+#endif
 }
 
 // returns a pointer to a char array in the C language.
@@ -824,149 +1065,577 @@ static const char* gc_string_literal_cstr(value_t obj) {
     return (const char*)raw_value_to_ptr(str->body[0]);
 }
 
-// true if this is a String object.
-static bool gc_is_string_instance(value_t obj) {
-    return gc_get_class_of(obj) == &class_String.clazz;
-}
-
 // returns a pointer to a char array in the C language.
 // this function is only used in test-code-generator.ts.
 static const char* gc_string_instance_cstr(value_t obj) {
     pointer_t str = value_to_ptr(obj);
-    return (const char*)&str->body[1];
+    return (const char*)&str->body[3];
+}
+
+static char* string_instance_chars(pointer_t obj) {
+    return (char*)&obj->body[3];
+}
+
+// true if this is a rope that has not been flattened yet.
+static bool gc_is_string_rope(value_t obj) {
+    return gc_get_class_of(obj) == &string_rope.clazz
+           && value_to_ptr(obj)->body[ROPE_RIGHT_INDEX] != VALUE_UNDEF;
 }
 
 bool gc_is_string_object(value_t obj) {
-    return gc_is_string_literal(obj) || gc_is_string_instance(obj);
+    const class_object* clazz = gc_get_class_of(obj);
+    return clazz == &string_literal.clazz || clazz == &class_String.clazz
+           || clazz == &string_rope.clazz || clazz == &string_slice.clazz;
 }
 
+static value_t flatten_rope(value_t rope);
+static const char* materialize_slice(value_t slice);
+
+// this may allocate a new object if obj is a rope or a slice.
 const char* gc_string_to_cstr(value_t obj) {
-    if (gc_is_string_literal(obj))
+    const class_object* clazz = gc_get_class_of(obj);
+    if (clazz == &string_literal.clazz)
         return gc_string_literal_cstr(obj);
-    else if (gc_is_string_instance(obj))
+    else if (clazz == &class_String.clazz)
         return gc_string_instance_cstr(obj);
+    else if (clazz == &string_rope.clazz)
+        return gc_string_instance_cstr(flatten_rope(obj));
+    else if (clazz == &string_slice.clazz)
+        return materialize_slice(obj);
     else
         return NULL;
 }
 
-static int32_t string_length_for_int(int32_t n) {
-    if (n == 0)
-        return 1;
-    else if (n < 0)
-        return 1 + string_length_for_int(-n);
-    else {
-        int32_t len = 0;
-        while (n > 0) {
-            len++;
-            n /= 10;
-        }
-        return len;
+// returns a pointer to the characters of a string object that is not a rope
+// or is a flattened rope.  This never allocates an object.
+// The characters of a slice may not end with the null character.
+static const char* flat_string_chars(value_t obj) {
+    const class_object* clazz = gc_get_class_of(obj);
+    int32_t offset = 0;
+    if (clazz == &string_slice.clazz) {
+        pointer_t slice = value_to_ptr(obj);
+        offset = slice->body[SLICE_OFFSET_INDEX];
+        obj = slice->body[SLICE_PARENT_INDEX];
+        clazz = gc_get_class_of(obj);
     }
+
+    if (clazz == &string_literal.clazz)
+        return gc_string_literal_cstr(obj) + offset;
+    else if (clazz == &class_String.clazz)
+        return gc_string_instance_cstr(obj) + offset;
+    else    // a flattened rope
+        return gc_string_instance_cstr(value_to_ptr(obj)->body[ROPE_LEFT_INDEX]);
+}
+
+// copies the characters of a string object to dest.  The null character is not copied.
+// Unlike gc_string_to_cstr(), this never allocates an object even if str is a rope.
+static void copy_string_chars(char* dest, value_t str) {
+    int32_t end = string_object_length(str);
+    while (gc_is_string_rope(str)) {
+        pointer_t ropep = value_to_ptr(str);
+        value_t right = ropep->body[ROPE_RIGHT_INDEX];
+        int32_t len = string_object_length(right);
+        end -= len;
+        memcpy(dest + end, flat_string_chars(right), len);
+        str = ropep->body[ROPE_LEFT_INDEX];
+    }
+
+    memcpy(dest, flat_string_chars(str), end);
 }
 
-static char* int_to_str(char* p, int32_t n) {
-    if (n == 0) {
-        *p++ = '0';
-        *p = '\0';
-        return p;
+// returns the String object obtained by flattening the given rope.
+static value_t flatten_rope(value_t rope) {
+    pointer_t ropep = value_to_ptr(rope);
+    if (ropep->body[ROPE_RIGHT_INDEX] == VALUE_UNDEF)
+        return ropep->body[ROPE_LEFT_INDEX];
+
+    ROOT_SET(rootset, 1)
+    rootset.values[0] = rope;
+    int32_t len = ropep->body[STRING_LENGTH_INDEX];
+    pointer_t str = make_string_object(len);
+    char* chars = string_instance_chars(str);
+    copy_string_chars(chars, rope);
+    chars[len] = '\0';
+    str->body[STRING_HASH_INDEX] = ropep->body[STRING_HASH_INDEX];
+    value_t strv = ptr_to_value(str);
+    gc_write_barrier(ropep, strv);
+    ropep->body[ROPE_LEFT_INDEX] = strv;
+    ropep->body[ROPE_RIGHT_INDEX] = VALUE_UNDEF;
+    DELETE_ROOT_SET(rootset)
+    return strv;
+}
+
+// makes a slice of the given string.
+static value_t make_string_slice(value_t str, int32_t offset, int32_t len) {
+    ROOT_SET(rootset, 1)
+    rootset.values[0] = str;
+    if (gc_is_string_rope(str))
+        str = rootset.values[0] = flatten_rope(str);
+    else if (gc_get_class_of(str) == &string_rope.clazz)
+        str = value_to_ptr(str)->body[ROPE_LEFT_INDEX];
+    else if (gc_get_class_of(str) == &string_slice.clazz) {
+        pointer_t slice = value_to_ptr(str);
+        offset += slice->body[SLICE_OFFSET_INDEX];
+        str = slice->body[SLICE_PARENT_INDEX];
+    }
+
+    pointer_t obj = gc_allocate_object(&string_slice.clazz);
+    obj->body[SLICE_OFFSET_INDEX] = offset;
+    obj->body[STRING_LENGTH_INDEX] = len;
+    obj->body[STRING_HASH_INDEX] = 0;
+    obj->body[SLICE_PARENT_INDEX] = str;
+    DELETE_ROOT_SET(rootset)
+    return ptr_to_value(obj);
+}
+
+// returns a C string.  If the slice does not end at the end of its parent,
+// the characters are copied into a new String object.
+static const char* materialize_slice(value_t obj) {
+    pointer_t slice = value_to_ptr(obj);
+    int32_t len = slice->body[STRING_LENGTH_INDEX];
+    if (slice->body[SLICE_OFFSET_INDEX] + len == string_object_length(slice->body[SLICE_PARENT_INDEX]))
+        return flat_string_chars(obj);
+
+    ROOT_SET(rootset, 1)
+    rootset.values[0] = obj;
+    pointer_t str = make_string_object(len);
+    char* chars = string_instance_chars(str);
+    memcpy(chars, flat_string_chars(obj), len);
+    chars[len] = '\0';
+    str->body[STRING_HASH_INDEX] = slice->body[STRING_HASH_INDEX];
+    value_t strv = ptr_to_value(str);
+    gc_write_barrier(slice, strv);
+    slice->body[SLICE_PARENT_INDEX] = strv;
+    slice->body[SLICE_OFFSET_INDEX] = 0;
+    DELETE_ROOT_SET(rootset)
+    return chars;
+}
+
+// since flattening a rope allocates an object, this must be called
+// before obtaining the characters of two string objects at the same time.
+static void flatten_string_pair(value_t a, value_t b) {
+    if (gc_is_string_rope(a) || gc_is_string_rope(b)) {
+        ROOT_SET(rootset, 2)
+        rootset.values[0] = a;
+        rootset.values[1] = b;
+        gc_string_to_cstr(a);
+        gc_string_to_cstr(b);
+        DELETE_ROOT_SET(rootset)
+    }
+}
+
+// Number-to-string conversion.
+// Each function writes the characters in a single pass and returns
+// a pointer to the terminating null character.
+// A buffer of NUMBER_STRING_SIZE bytes is large enough for any number.
+
+static const char digit_pairs[201] =
+    "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+    "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+    "8081828384858687888990919293949596979899";
+
+static const uint32_t powers_of_10[10] = {
+    1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000 };
+
+static int32_t count_digits(uint32_t n) {
+    if (n < 10000)
+        return n < 100 ? (n < 10 ? 1 : 2) : (n < 1000 ? 3 : 4);
+    else if (n < 100000000)
+        return n < 1000000 ? (n < 100000 ? 5 : 6) : (n < 10000000 ? 7 : 8);
+    else
+        return n < 1000000000 ? 9 : 10;
+}
+
+// writes exactly len digits, padding with '0' if necessary.
+// Two digits are written at a time by looking up digit_pairs.
+static char* write_digits(char* p, uint32_t n, int32_t len) {
+    char* end = p + len;
+    char* q = end;
+    while (n >= 100) {
+        uint32_t r = n % 100;
+        n /= 100;
+        q -= 2;
+        memcpy(q, &digit_pairs[r * 2], 2);
+    }
+
+    if (n >= 10) {
+        q -= 2;
+        memcpy(q, &digit_pairs[n * 2], 2);
     }
+    else if (q > p)
+        *--q = '0' + n;
+
+    while (q > p)
+        *--q = '0';
 
+    *end = '\0';
+    return end;
+}
+
+static char* uint_to_str(char* p, uint32_t n) {
+    return write_digits(p, n, count_digits(n));
+}
+
+static char* int_to_str(char* p, int32_t n) {
     if (n < 0) {
         *p++ = '-';
-        n = -n;
+        return uint_to_str(p, -(uint32_t)n);
     }
+    else
+        return uint_to_str(p, n);
+}
+
+static char* write_zeros(char* p, int32_t n) {
+    memset(p, '0', n);
+    p[n] = '\0';
+    return p + n;
+}
+
+/*
+  The shortest decimal representation of a float that is read back
+  as the same float.  This is a port of Ryu (Ulf Adams, PLDI 2018)
+  for 32bit floats.  It needs only 32x64 bit multiplications.
+*/
 
-    int32_t len = string_length_for_int(n);
-    p += len;
-    char* q = p;
-    *q-- = '\0';
-    while (n > 0) {
-        *q-- = '0' + n % 10;
-        n /= 10;
+#define FLOAT_MANTISSA_BITS     23
+#define FLOAT_BIAS              127
+#define FLOAT_POW5_INV_BITCOUNT 59
+#define FLOAT_POW5_BITCOUNT     61
+
+static const uint64_t float_pow5_inv_split[31] = {
+    576460752303423489u, 461168601842738791u, 368934881474191033u,
+    295147905179352826u, 472236648286964522u, 377789318629571618u,
+    302231454903657294u, 483570327845851670u, 386856262276681336u,
+    309485009821345069u, 495176015714152110u, 396140812571321688u,
+    316912650057057351u, 507060240091291761u, 405648192073033409u,
+    324518553658426727u, 519229685853482763u, 415383748682786211u,
+    332306998946228969u, 531691198313966350u, 425352958651173080u,
+    340282366920938464u, 544451787073501542u, 435561429658801234u,
+    348449143727040987u, 557518629963265579u, 446014903970612463u,
+    356811923176489971u, 570899077082383953u, 456719261665907162u,
+    365375409332725730u
+};
+
+static const uint64_t float_pow5_split[47] = {
+    1152921504606846976u, 1441151880758558720u, 1801439850948198400u,
+    2251799813685248000u, 1407374883553280000u, 1759218604441600000u,
+    2199023255552000000u, 1374389534720000000u, 1717986918400000000u,
+    2147483648000000000u, 1342177280000000000u, 1677721600000000000u,
+    2097152000000000000u, 1310720000000000000u, 1638400000000000000u,
+    2048000000000000000u, 1280000000000000000u, 1600000000000000000u,
+    2000000000000000000u, 1250000000000000000u, 1562500000000000000u,
+    1953125000000000000u, 1220703125000000000u, 1525878906250000000u,
+    1907348632812500000u, 1192092895507812500u, 1490116119384765625u,
+    1862645149230957031u, 1164153218269348144u, 1455191522836685180u,
+    1818989403545856475u, 2273736754432320594u, 1421085471520200371u,
+    1776356839400250464u, 2220446049250313080u, 1387778780781445675u,
+    1734723475976807094u, 2168404344971008868u, 1355252715606880542u,
+    1694065894508600678u, 2117582368135750847u, 1323488980084844279u,
+    1654361225106055349u, 2067951531382569187u, 1292469707114105741u,
+    1615587133892632177u, 2019483917365790221u
+};
+
+// ceil(log2(5^e)) if e > 0, or 1 if e == 0.
+static inline int32_t pow5bits(int32_t e) {
+    return (int32_t)(((uint32_t)e * 1217359) >> 19) + 1;
+}
+
+// floor(log10(2^e))
+static inline uint32_t log10_pow2(int32_t e) {
+    return ((uint32_t)e * 78913) >> 18;
+}
+
+// floor(log10(5^e))
+static inline uint32_t log10_pow5(int32_t e) {
+    return ((uint32_t)e * 732923) >> 20;
+}
+
+static bool is_multiple_of_pow5(uint32_t value, uint32_t p) {
+    uint32_t count = 0;
+    while (value % 5 == 0) {
+        value /= 5;
+        if (++count >= p)
+            return true;
     }
 
-    return p;
+    return false;
+}
+
+static inline bool is_multiple_of_pow2(uint32_t value, uint32_t p) {
+    return (value & ((1u << p) - 1)) == 0;
 }
 
-static int32_t string_length_for_float(float f) {
-    if (isnan(f) || f == 0.0)
-        return 3;   // nan or 0.0
-    else if (f < 0.0)
-        return 1 + string_length_for_float(-f);
+static inline uint32_t mul_shift32(uint32_t m, uint64_t factor, int32_t shift) {
+    uint64_t bits0 = (uint64_t)m * (uint32_t)factor;
+    uint64_t bits1 = (uint64_t)m * (uint32_t)(factor >> 32);
+    uint64_t sum = (bits0 >> 32) + bits1;
+    return (uint32_t)(sum >> (shift - 32));
+}
+
+// computes digits and e10 such that digits * 10^e10 is the shortest
+// representation of a finite, non-zero float whose bits are ieee.
+static uint32_t float_to_decimal(uint32_t ieee, int32_t* e10_out) {
+    uint32_t ieee_mantissa = ieee & ((1u << FLOAT_MANTISSA_BITS) - 1);
+    uint32_t ieee_exponent = (ieee >> FLOAT_MANTISSA_BITS) & 0xff;
+    int32_t e2;
+    uint32_t m2;
+    if (ieee_exponent == 0) {
+        e2 = 1 - FLOAT_BIAS - FLOAT_MANTISSA_BITS - 2;
+        m2 = ieee_mantissa;
+    }
     else {
-        int32_t n = (int32_t)f;
-        int32_t len = string_length_for_int(n) + 1;
-        int32_t digits = 0;
-        f -= n;
-        float limit = 0.000001;
-        if (f < limit)
-            digits = 1;
-        else
-            while (f >= limit && digits < 6) {
-                f *= 10;
-                f -= (int32_t)f;
-                digits++;
-                limit *= 10.0;
+        e2 = (int32_t)ieee_exponent - FLOAT_BIAS - FLOAT_MANTISSA_BITS - 2;
+        m2 = (1u << FLOAT_MANTISSA_BITS) | ieee_mantissa;
+    }
+
+    bool accept_bounds = (m2 & 1) == 0;
+
+    // the interval of valid representations is [mm, mp] * 2^e2.
+    uint32_t mv = 4 * m2;
+    uint32_t mp = 4 * m2 + 2;
+    uint32_t mm_shift = ieee_mantissa != 0 || ieee_exponent <= 1;
+    uint32_t mm = 4 * m2 - 1 - mm_shift;
+
+    uint32_t vr, vp, vm;
+    int32_t e10;
+    bool vm_trailing_zeros = false;
+    bool vr_trailing_zeros = false;
+    uint32_t last_removed_digit = 0;
+    if (e2 >= 0) {
+        uint32_t q = log10_pow2(e2);
+        e10 = (int32_t)q;
+        int32_t k = FLOAT_POW5_INV_BITCOUNT + pow5bits((int32_t)q) - 1;
+        int32_t i = -e2 + (int32_t)q + k;
+        vr = mul_shift32(mv, float_pow5_inv_split[q], i);
+        vp = mul_shift32(mp, float_pow5_inv_split[q], i);
+        vm = mul_shift32(mm, float_pow5_inv_split[q], i);
+        if (q != 0 && (vp - 1) / 10 <= vm / 10) {
+            // one removed digit is needed even if the loop below does not run.
+            int32_t l = FLOAT_POW5_INV_BITCOUNT + pow5bits((int32_t)(q - 1)) - 1;
+            last_removed_digit = mul_shift32(mv, float_pow5_inv_split[q - 1], -e2 + (int32_t)q - 1 + l) % 10;
+        }
+
+        if (q <= 9) {
+            // only one of mp, mv, and mm can be a multiple of 5.
+            if (mv % 5 == 0)
+                vr_trailing_zeros = is_multiple_of_pow5(mv, q);
+            else if (accept_bounds)
+                vm_trailing_zeros = is_multiple_of_pow5(mm, q);
+            else
+                vp -= is_multiple_of_pow5(mp, q);
+        }
+    }
+    else {
+        uint32_t q = log10_pow5(-e2);
+        e10 = (int32_t)q + e2;
+        int32_t i = -e2 - (int32_t)q;
+        int32_t k = pow5bits(i) - FLOAT_POW5_BITCOUNT;
+        int32_t j = (int32_t)q - k;
+        vr = mul_shift32(mv, float_pow5_split[i], j);
+        vp = mul_shift32(mp, float_pow5_split[i], j);
+        vm = mul_shift32(mm, float_pow5_split[i], j);
+        if (q != 0 && (vp - 1) / 10 <= vm / 10) {
+            j = (int32_t)q - 1 - (pow5bits(i + 1) - FLOAT_POW5_BITCOUNT);
+            last_removed_digit = mul_shift32(mv, float_pow5_split[i + 1], j) % 10;
+        }
+
+        if (q <= 1) {
+            // mv has at least q trailing 0 bits.
+            vr_trailing_zeros = true;
+            if (accept_bounds)
+                vm_trailing_zeros = mm_shift == 1;
+            else
+                --vp;
+        }
+        else if (q < 31)
+            vr_trailing_zeros = is_multiple_of_pow2(mv, q - 1);
+    }
+
+    // removes as many digits as possible while staying in the interval.
+    int32_t removed = 0;
+    uint32_t output;
+    if (vm_trailing_zeros || vr_trailing_zeros) {
+        while (vp / 10 > vm / 10) {
+            vm_trailing_zeros &= vm % 10 == 0;
+            vr_trailing_zeros &= last_removed_digit == 0;
+            last_removed_digit = vr % 10;
+            vr /= 10;
+            vp /= 10;
+            vm /= 10;
+            ++removed;
+        }
+
+        if (vm_trailing_zeros)
+            while (vm % 10 == 0) {
+                vr_trailing_zeros &= last_removed_digit == 0;
+                last_removed_digit = vr % 10;
+                vr /= 10;
+                vp /= 10;
+                vm /= 10;
+                ++removed;
             }
 
-        return len + digits;
+        if (vr_trailing_zeros && last_removed_digit == 5 && vr % 2 == 0)
+            last_removed_digit = 4;     // round to even
+
+        output = vr + ((vr == vm && (!accept_bounds || !vm_trailing_zeros)) || last_removed_digit >= 5);
+    }
+    else {
+        while (vp / 10 > vm / 10) {
+            last_removed_digit = vr % 10;
+            vr /= 10;
+            vp /= 10;
+            vm /= 10;
+            ++removed;
+        }
+
+        output = vr + (vr == vm || last_removed_digit >= 5);
     }
+
+    *e10_out = e10 + removed;
+    return output;
 }
 
+// converts a float into the shortest string that is read back as the same float.
+// The exponent notation is not used.  A fraction part is always printed,
+// for example, 3.0, 0.25, 0.000001, and 1200.0.
 static char* float_to_str(char* p, float f) {
-    if (isnan(f)) {
-        *p++ = 'n';
-        *p++ = 'a';
-        *p++ = 'n';
-        *p = '\0';
-        return p;
-    }
+    float_or_uint v = { .f = f };
+    if ((v.u & 0x7fffffff) == 0)
+        return stpcpy(p, "0.0");
+    else if ((v.u & 0x7fffffff) > 0x7f800000u)
+        return stpcpy(p, "nan");
 
-    if (f == 0.0) {
-        *p++ = '0';
-        *p++ = '.';
-        *p++ = '0';
-        *p = '\0';
-        return p;
+    if (v.u & 0x80000000u)
+        *p++ = '-';
+
+    if ((v.u & 0x7f800000u) == 0x7f800000u)
+        return stpcpy(p, "inf");
+
+    int32_t e10;
+    uint32_t digits = float_to_decimal(v.u, &e10);
+    int32_t len = count_digits(digits);
+    if (e10 >= 0) {
+        p = write_digits(p, digits, len);
+        p = write_zeros(p, e10);
+        return stpcpy(p, ".0");
+    }
+    else {
+        int32_t point = len + e10;
+        if (point > 0) {
+            uint32_t d = powers_of_10[-e10];
+            p = write_digits(p, digits / d, point);
+            *p++ = '.';
+            return write_digits(p, digits % d, -e10);
+        }
+        else {
+            *p++ = '0';
+            *p++ = '.';
+            p = write_zeros(p, -point);
+            return write_digits(p, digits, len);
+        }
     }
+}
 
-    if (f < 0.0) {
+// converts a float as printf("%f") does.  The result is rounded to 6 digits
+// after the decimal point.
+static char* float_to_fixed_str(char* p, float f) {
+    float_or_uint v = { .f = f };
+    if (v.u & 0x80000000u)
         *p++ = '-';
-        f = -f;
-    }
 
-    int32_t n = (int32_t)f;
-    p = int_to_str(p, n);
-    *p++ = '.';
-    f -= n;
-    float limit = 0.000001;
-    if (f < limit)
-        *p++ = '0';
+    if ((v.u & 0x7f800000u) == 0x7f800000u)
+        return stpcpy(p, (v.u & 0x7fffff) != 0 ? "nan" : "inf");
+
+    uint32_t ieee_exponent = (v.u >> FLOAT_MANTISSA_BITS) & 0xff;
+    uint32_t m = v.u & ((1u << FLOAT_MANTISSA_BITS) - 1);
+    int32_t e2;
+    if (ieee_exponent == 0)
+        e2 = 1 - FLOAT_BIAS - FLOAT_MANTISSA_BITS;
     else {
-        int32_t digits = 0;
-        while (f >= limit && digits < 6) {
-            f *= 10;
-            n = (int32_t)f;
-            *p++ = '0' + n;
-            f -= n;
-            limit *= 10.0;
-            digits++;
+        e2 = (int32_t)ieee_exponent - FLOAT_BIAS - FLOAT_MANTISSA_BITS;
+        m |= 1u << FLOAT_MANTISSA_BITS;
+    }
+
+    // the value is m * 2^e2.
+    if (e2 > 8) {
+        // a large integer.  It is computed in base 10^9.
+        uint32_t limbs[5] = { m };
+        int32_t n = 1;
+        while (e2 > 0) {
+            int32_t s = e2 > 29 ? 29 : e2;
+            uint64_t carry = 0;
+            for (int32_t i = 0; i < n; i++) {
+                uint64_t t = ((uint64_t)limbs[i] << s) + carry;
+                limbs[i] = (uint32_t)(t % 1000000000);
+                carry = t / 1000000000;
+            }
+
+            if (carry > 0)
+                limbs[n++] = (uint32_t)carry;
+
+            e2 -= s;
         }
+
+        p = uint_to_str(p, limbs[n - 1]);
+        for (int32_t i = n - 2; i >= 0; i--)
+            p = write_digits(p, limbs[i], 9);
+
+        return stpcpy(p, ".000000");
+    }
+
+    uint32_t int_part, frac_part;
+    if (e2 >= 0) {
+        int_part = m << e2;
+        frac_part = 0;
+    }
+    else if (e2 >= -44) {
+        // the fraction times 10^6 fits in 64 bits.
+        int32_t k = -e2;
+        uint64_t mask = ((uint64_t)1 << k) - 1;
+        int_part = (uint32_t)((uint64_t)m >> k);
+        uint64_t scaled = ((uint64_t)m & mask) * 1000000;
+        frac_part = (uint32_t)(scaled >> k);
+        uint64_t rem = scaled & mask;
+        uint64_t half = (uint64_t)1 << (k - 1);
+        if (rem > half || (rem == half && (frac_part & 1))) {   // round half to even
+            if (++frac_part == 1000000) {
+                frac_part = 0;
+                int_part++;
+            }
+        }
+    }
+    else {
+        // less than 2^-21, which is rounded to 0.
+        int_part = 0;
+        frac_part = 0;
     }
 
-    *p = '\0';
-    return p;
+    p = uint_to_str(p, int_part);
+    *p++ = '.';
+    return write_digits(p, frac_part, 6);
+}
+
+char* gc_int_to_cstring(char* p, int32_t n) {
+    return int_to_str(p, n);
+}
+
+char* gc_float_to_cstring(char* p, float f) {
+    return float_to_str(p, f);
+}
+
+char* gc_float_to_fixed_cstring(char* p, float f) {
+    return float_to_fixed_str(p, f);
 }
 
 int32_t gc_string_length(value_t obj) {
-    if (gc_is_string_literal(obj))
-        return strlen(gc_string_literal_cstr(obj));
-    else if (gc_is_string_instance(obj))
-        return strlen(gc_string_instance_cstr(obj));
+    char buf[NUMBER_STRING_SIZE];
+    if (gc_is_string_object(obj))
+        return string_object_length(obj);
     else if (is_int_value(obj))
-        return string_length_for_int(value_to_int(obj));
+        return int_to_str(buf, value_to_int(obj)) - buf;
     else if (is_float_value(obj))
-        return string_length_for_float(value_to_float(obj));
+        return float_to_str(buf, value_to_float(obj)) - buf;
     else if (is_bool_value(obj))
         return value_to_bool(obj) ? 4 : 5; // true or false
     else if (obj == VALUE_UNDEF)    // undefined or null
@@ -984,10 +1653,12 @@ int32_t gc_string_length(value_t obj) {
 // p: a pointer to a buffer.
 // obj: a value to be converted.
 char* gc_any_to_cstring(char* p, value_t obj) {
-    if (gc_is_string_literal(obj))
-        return stpcpy(p, gc_string_literal_cstr(obj));
-    else if (gc_is_string_instance(obj))
-        return stpcpy(p, gc_string_instance_cstr(obj));
+    if (gc_is_string_object(obj)) {
+        int32_t len = string_object_length(obj);
+        copy_string_chars(p, obj);
+        p[len] = '\0';
+        return p + len;
+    }
     else if (is_int_value(obj))
         return int_to_str(p, value_to_int(obj));
     else if (is_float_value(obj))
@@ -1011,57 +1682,818 @@ char* gc_any_to_cstring(char* p, value_t obj) {
 }
 
 // len: the length of the string excluding the null character.
+// body[0] is the size, body[1] is the length, body[2] is the hash code,
+// and the characters start at body[3].
 static pointer_t make_string_object(int32_t len) {
-    int32_t size = (len + 4) / 4;
+    int32_t size = (len + 4) / 4 + 2;
     pointer_t obj = allocate_heap(size + 1);
     set_object_header(obj, &class_String.clazz);
     obj->body[0] = size;
+    obj->body[STRING_LENGTH_INDEX] = len;
+    obj->body[STRING_HASH_INDEX] = 0;
     return obj;
 }
 
+// returns the length of the string representation of obj.
+// If obj is a number, its representation is written into buf
+// so that the number is converted only once.
+// buf must be NUMBER_STRING_SIZE bytes or longer.
+static int32_t string_length_with_buffer(value_t obj, char* buf) {
+    if (is_int_value(obj))
+        return int_to_str(buf, value_to_int(obj)) - buf;
+    else if (is_float_value(obj))
+        return float_to_str(buf, value_to_float(obj)) - buf;
+    else
+        return gc_string_length(obj);
+}
+
+// the characters of a string object or a number are copied by memcpy()
+// since its length is known.  buf is the buffer given to string_length_with_buffer().
+static char* append_to_cstring(char* p, value_t obj, int32_t len, const char* buf) {
+    if (gc_is_string_object(obj)) {
+        copy_string_chars(p, obj);
+        return p + len;
+    }
+    else if (is_int_value(obj) || is_float_value(obj)) {
+        memcpy(p, buf, len);
+        return p + len;
+    }
+    else
+        return gc_any_to_cstring(p, obj);
+}
+
+// converts a value into a flat string.
+static value_t to_flat_string(value_t obj, int32_t len, const char* buf) {
+    if (gc_is_string_rope(obj))
+        return flatten_rope(obj);
+    else if (gc_is_string_object(obj))
+        return obj;
+    else {
+        pointer_t str = make_string_object(len);
+        *append_to_cstring(string_instance_chars(str), obj, len, buf) = '\0';
+        return ptr_to_value(str);
+    }
+}
+
+/*
+  concatenates two values.  At least one of them is a string.
+  If the resulting string is long and s1 is a string, this returns a rope,
+  which is flattened later when gc_string_to_cstr() is called.
+  So s = s + x in a loop runs in linear time.
+*/
 value_t gc_new_String(value_t s1, value_t s2) {
     ROOT_SET(rootset, 2)
     rootset.values[0] = s1;
     rootset.values[1] = s2;
-    int32_t len = gc_string_length(s1) + gc_string_length(s2);
-    pointer_t obj = make_string_object(len);
-    char* p = (char*)&obj->body[1];
-    gc_any_to_cstring(gc_any_to_cstring(p, s1), s2);
+    char buf1[NUMBER_STRING_SIZE], buf2[NUMBER_STRING_SIZE];
+    int32_t len1 = string_length_with_buffer(s1, buf1);
+    int32_t len2 = string_length_with_buffer(s2, buf2);
+    value_t result;
+    if (len1 + len2 >= ROPE_MIN_LENGTH && gc_is_string_object(s1)) {
+        s2 = rootset.values[1] = to_flat_string(s2, len2, buf2);
+        pointer_t rope = gc_allocate_object(&string_rope.clazz);
+        rope->body[0] = 0;
+        rope->body[STRING_LENGTH_INDEX] = len1 + len2;
+        rope->body[STRING_HASH_INDEX] = 0;
+        rope->body[ROPE_LEFT_INDEX] = s1;
+        rope->body[ROPE_RIGHT_INDEX] = s2;
+        result = ptr_to_value(rope);
+    }
+    else {
+        pointer_t obj = make_string_object(len1 + len2);
+        char* p = string_instance_chars(obj);
+        p = append_to_cstring(append_to_cstring(p, s1, len1, buf1), s2, len2, buf2);
+        *p = '\0';
+        result = ptr_to_value(obj);
+    }
+
     DELETE_ROOT_SET(rootset)
-    return ptr_to_value(obj);
+    return result;
 }
 
-// An int32_t array
+/*
+  Bulk operations on typed arrays: fill, set, add, scale, dot, sum, min, and max.
+  They are the methods of integer[], float[], and Uint8Array.  Their vtable
+  indexes must match bulkOperations() in types.ts.
+
+  The kernels on int32_t and float elements process 8 elements at a time.
+  When this file is compiled by GCC or Clang, they use the vector extension,
+  which is compiled into SSE or AVX instructions on x86, NEON instructions
+  on Arm, and scalar instructions on processors without SIMD support
+  such as the Xtensa processor.
+  If BULK_NO_VECTOR is defined, 8-element arrays are used instead.
+  Both implementations add floats in the same order.  The element at
+  index i is added to the lane i % 8, the lanes are summed up, and then
+  the remaining elements are added one by one.
+*/
 
-static CLASS_OBJECT(intarray_object, 1) = {
-    .clazz = { .size = -1, .start_index = SIZE_NO_POINTER, .name = "integer[]",
-               .superclass = &object_class.clazz, .array_type_name = "[i", .table = DEFAULT_PTABLE, .mtable = DEFAULT_MTABLE }};
+#if defined(__GNUC__) && !defined(BULK_NO_VECTOR)
 
-value_t safe_value_to_intarray(bool nullable, value_t v) {
-    return safe_value_to_value(nullable, &intarray_object.clazz, v);
-}
+// 8 lanes are two 16-byte vectors.  A 16-byte vector fits in an SSE or NEON register.
+typedef float f32x4 __attribute__((vector_size(16)));
+typedef int32_t i32x4 __attribute__((vector_size(16)));
+typedef uint32_t u32x4 __attribute__((vector_size(16)));
 
-static pointer_t gc_new_intarray_base(int32_t n) {
-    if (n < 0)
-        n = 0;
+typedef struct { f32x4 lo, hi; } lanes_f;
+typedef struct { u32x4 lo, hi; } lanes_u;
 
-    pointer_t obj = allocate_heap(n + 1);
-    set_object_header(obj, &intarray_object.clazz);
-    obj->body[0] = n;
-    return obj;
-}
+#define LANES_INLINE    static inline __attribute__((always_inline))
 
-/*
-  An int32_t array.  It cannot contain a pointer.
-  n: the number of elements. n >= 0.
+// x < y ? x : y for each lane of 4-lane vectors.
+#define F32X4_MIN(x, y)     ((f32x4)(((i32x4)(x) & ((x) < (y))) | ((i32x4)(y) & ~((x) < (y)))))
+#define F32X4_MAX(x, y)     ((f32x4)(((i32x4)(x) & ((x) > (y))) | ((i32x4)(y) & ~((x) > (y)))))
+#define I32X4_MIN(x, y)     ((u32x4)(((i32x4)(x) & ((i32x4)(x) < (i32x4)(y))) | ((i32x4)(y) & ~((i32x4)(x) < (i32x4)(y)))))
+#define I32X4_MAX(x, y)     ((u32x4)(((i32x4)(x) & ((i32x4)(x) > (i32x4)(y))) | ((i32x4)(y) & ~((i32x4)(x) > (i32x4)(y)))))
 
-  1st word is the number of elements.
-  2nd, 3rd, ... words hold elements.
-*/
-value_t gc_new_intarray(int32_t n, int32_t init_value) {
-    pointer_t obj = gc_new_intarray_base(n);
-    for (int32_t i = 1; i <= n; i++)
-        obj->body[i] = init_value;
+LANES_INLINE lanes_f lanes_f_splat(float f) { f32x4 v = { f, f, f, f }; return (lanes_f){ v, v }; }
+LANES_INLINE lanes_f lanes_f_add(lanes_f a, lanes_f b) { return (lanes_f){ a.lo + b.lo, a.hi + b.hi }; }
+LANES_INLINE lanes_f lanes_f_mul(lanes_f a, lanes_f b) { return (lanes_f){ a.lo * b.lo, a.hi * b.hi }; }
+LANES_INLINE lanes_f lanes_f_min(lanes_f a, lanes_f b) { return (lanes_f){ F32X4_MIN(a.lo, b.lo), F32X4_MIN(a.hi, b.hi) }; }
+LANES_INLINE lanes_f lanes_f_max(lanes_f a, lanes_f b) { return (lanes_f){ F32X4_MAX(a.lo, b.lo), F32X4_MAX(a.hi, b.hi) }; }
+
+LANES_INLINE lanes_u lanes_u_splat(uint32_t w) { u32x4 v = { w, w, w, w }; return (lanes_u){ v, v }; }
+LANES_INLINE lanes_u lanes_u_add(lanes_u a, lanes_u b) { return (lanes_u){ a.lo + b.lo, a.hi + b.hi }; }
+LANES_INLINE lanes_u lanes_u_mul(lanes_u a, lanes_u b) { return (lanes_u){ a.lo * b.lo, a.hi * b.hi }; }
+LANES_INLINE lanes_u lanes_u_min(lanes_u a, lanes_u b) { return (lanes_u){ I32X4_MIN(a.lo, b.lo), I32X4_MIN(a.hi, b.hi) }; }
+LANES_INLINE lanes_u lanes_u_max(lanes_u a, lanes_u b) { return (lanes_u){ I32X4_MAX(a.lo, b.lo), I32X4_MAX(a.hi, b.hi) }; }
+
+#else
+
+typedef struct { float v[8]; } lanes_f;
+typedef struct { uint32_t v[8]; } lanes_u;
+
+#define LANES_INLINE    static inline
+
+#define LANES_MAP(type, expr)   type r; for (int k = 0; k < 8; k++) r.v[k] = (expr); return r
+
+LANES_INLINE lanes_f lanes_f_splat(float f) { LANES_MAP(lanes_f, f); }
+LANES_INLINE lanes_f lanes_f_add(lanes_f a, lanes_f b) { LANES_MAP(lanes_f, a.v[k] + b.v[k]); }
+LANES_INLINE lanes_f lanes_f_mul(lanes_f a, lanes_f b) { LANES_MAP(lanes_f, a.v[k] * b.v[k]); }
+LANES_INLINE lanes_f lanes_f_min(lanes_f a, lanes_f b) { LANES_MAP(lanes_f, a.v[k] < b.v[k] ? a.v[k] : b.v[k]); }
+LANES_INLINE lanes_f lanes_f_max(lanes_f a, lanes_f b) { LANES_MAP(lanes_f, a.v[k] > b.v[k] ? a.v[k] : b.v[k]); }
+
+LANES_INLINE lanes_u lanes_u_splat(uint32_t v) { LANES_MAP(lanes_u, v); }
+LANES_INLINE lanes_u lanes_u_add(lanes_u a, lanes_u b) { LANES_MAP(lanes_u, a.v[k] + b.v[k]); }
+LANES_INLINE lanes_u lanes_u_mul(lanes_u a, lanes_u b) { LANES_MAP(lanes_u, a.v[k] * b.v[k]); }
+LANES_INLINE lanes_u lanes_u_min(lanes_u a, lanes_u b) {
+    LANES_MAP(lanes_u, (int32_t)a.v[k] < (int32_t)b.v[k] ? a.v[k] : b.v[k]);
+}
+LANES_INLINE lanes_u lanes_u_max(lanes_u a, lanes_u b) {
+    LANES_MAP(lanes_u, (int32_t)a.v[k] > (int32_t)b.v[k] ? a.v[k] : b.v[k]);
+}
+
+#endif
+
+// unaligned loads and stores.  Array elements are aligned only at 4-byte boundaries.
+LANES_INLINE lanes_f lanes_f_load(const float* p) { lanes_f v; memcpy(&v, p, sizeof(v)); return v; }
+LANES_INLINE void lanes_f_store(float* p, lanes_f v) { memcpy(p, &v, sizeof(v)); }
+LANES_INLINE lanes_u lanes_u_load(const int32_t* p) { lanes_u v; memcpy(&v, p, sizeof(v)); return v; }
+LANES_INLINE void lanes_u_store(int32_t* p, lanes_u v) { memcpy(p, &v, sizeof(v)); }
+
+LANES_INLINE float lanes_f_total(lanes_f v) {
+    float t[8];
+    lanes_f_store(t, v);
+    return ((t[0] + t[4]) + (t[2] + t[6])) + ((t[1] + t[5]) + (t[3] + t[7]));
+}
+
+LANES_INLINE uint32_t lanes_u_total(lanes_u v) {
+    int32_t t[8];
+    lanes_u_store(t, v);
+    uint32_t r = 0;
+    for (int k = 0; k < 8; k++)
+        r += (uint32_t)t[k];
+
+    return r;
+}
+
+static void float_fill(float* p, int32_t n, float f) {
+    int32_t i = 0;
+    lanes_f v = lanes_f_splat(f);
+    for (; i <= n - 8; i += 8)
+        lanes_f_store(p + i, v);
+
+    for (; i < n; i++)
+        p[i] = f;
+}
+
+// a[i] += b[i]
+static void float_add(float* a, const float* b, int32_t n) {
+    int32_t i = 0;
+    for (; i <= n - 8; i += 8)
+        lanes_f_store(a + i, lanes_f_add(lanes_f_load(a + i), lanes_f_load(b + i)));
+
+    for (; i < n; i++)
+        a[i] += b[i];
+}
+
+// a[i] *= k
+static void float_scale(float* a, int32_t n, float k) {
+    int32_t i = 0;
+    lanes_f v = lanes_f_splat(k);
+    for (; i <= n - 8; i += 8)
+        lanes_f_store(a + i, lanes_f_mul(lanes_f_load(a + i), v));
+
+    for (; i < n; i++)
+        a[i] *= k;
+}
+
+static float float_dot(const float* a, const float* b, int32_t n) {
+    int32_t i = 0;
+    float r = 0.0f;
+    if (n >= 8) {
+        lanes_f acc = lanes_f_mul(lanes_f_load(a), lanes_f_load(b));
+        for (i = 8; i <= n - 8; i += 8)
+            acc = lanes_f_add(acc, lanes_f_mul(lanes_f_load(a + i), lanes_f_load(b + i)));
+
+        r = lanes_f_total(acc);
+    }
+
+    for (; i < n; i++)
+        r += a[i] * b[i];
+
+    return r;
+}
+
+static float float_sum(const float* a, int32_t n) {
+    int32_t i = 0;
+    float r = 0.0f;
+    if (n >= 8) {
+        lanes_f acc = lanes_f_load(a);
+        for (i = 8; i <= n - 8; i += 8)
+            acc = lanes_f_add(acc, lanes_f_load(a + i));
+
+        r = lanes_f_total(acc);
+    }
+
+    for (; i < n; i++)
+        r += a[i];
+
+    return r;
+}
+
+// the minimum (or maximum if is_max is true) of n > 0 elements.
+// A NaN element is ignored unless it is the first element of a lane.
+static float float_min_max(const float* a, int32_t n, bool is_max) {
+    int32_t i = 1;
+    float r = a[0];
+    if (n >= 8) {
+        lanes_f acc = lanes_f_load(a);
+        if (is_max)
+            for (i = 8; i <= n - 8; i += 8)
+                acc = lanes_f_max(acc, lanes_f_load(a + i));
+        else
+            for (i = 8; i <= n - 8; i += 8)
+                acc = lanes_f_min(acc, lanes_f_load(a + i));
+
+        float t[8];
+        lanes_f_store(t, acc);
+        r = t[0];
+        for (int k = 1; k < 8; k++)
+            r = is_max ? (t[k] > r ? t[k] : r) : (t[k] < r ? t[k] : r);
+    }
+
+    for (; i < n; i++)
+        r = is_max ? (a[i] > r ? a[i] : r) : (a[i] < r ? a[i] : r);
+
+    return r;
+}
+
+// integers are added and multiplied as unsigned integers so that
+// they wrap around on overflow.
+
+static void int32_fill(int32_t* p, int32_t n, int32_t v) {
+    int32_t i = 0;
+    lanes_u w = lanes_u_splat(v);
+    for (; i <= n - 8; i += 8)
+        lanes_u_store(p + i, w);
+
+    for (; i < n; i++)
+        p[i] = v;
+}
+
+static void int32_add(int32_t* a, const int32_t* b, int32_t n) {
+    int32_t i = 0;
+    for (; i <= n - 8; i += 8)
+        lanes_u_store(a + i, lanes_u_add(lanes_u_load(a + i), lanes_u_load(b + i)));
+
+    for (; i < n; i++)
+        a[i] = (uint32_t)a[i] + (uint32_t)b[i];
+}
+
+static void int32_scale(int32_t* a, int32_t n, int32_t k) {
+    int32_t i = 0;
+    lanes_u v = lanes_u_splat(k);
+    for (; i <= n - 8; i += 8)
+        lanes_u_store(a + i, lanes_u_mul(lanes_u_load(a + i), v));
+
+    for (; i < n; i++)
+        a[i] = (uint32_t)a[i] * (uint32_t)k;
+}
+
+static int32_t int32_dot(const int32_t* a, const int32_t* b, int32_t n) {
+    int32_t i = 0;
+    lanes_u acc = lanes_u_splat(0);
+    for (; i <= n - 8; i += 8)
+        acc = lanes_u_add(acc, lanes_u_mul(lanes_u_load(a + i), lanes_u_load(b + i)));
+
+    uint32_t r = lanes_u_total(acc);
+    for (; i < n; i++)
+        r += (uint32_t)a[i] * (uint32_t)b[i];
+
+    return (int32_t)r;
+}
+
+static int32_t int32_sum(const int32_t* a, int32_t n) {
+    int32_t i = 0;
+    lanes_u acc = lanes_u_splat(0);
+    for (; i <= n - 8; i += 8)
+        acc = lanes_u_add(acc, lanes_u_load(a + i));
+
+    uint32_t r = lanes_u_total(acc);
+    for (; i < n; i++)
+        r += (uint32_t)a[i];
+
+    return (int32_t)r;
+}
+
+// the minimum (or maximum if is_max is true) of n > 0 elements.
+static int32_t int32_min_max(const int32_t* a, int32_t n, bool is_max) {
+    int32_t i = 1;
+    int32_t r = a[0];
+    if (n >= 8) {
+        lanes_u acc = lanes_u_load(a);
+        if (is_max)
+            for (i = 8; i <= n - 8; i += 8)
+                acc = lanes_u_max(acc, lanes_u_load(a + i));
+        else
+            for (i = 8; i <= n - 8; i += 8)
+                acc = lanes_u_min(acc, lanes_u_load(a + i));
+
+        int32_t t[8];
+        lanes_u_store(t, acc);
+        r = t[0];
+        for (int k = 1; k < 8; k++)
+            r = is_max ? (t[k] > r ? t[k] : r) : (t[k] < r ? t[k] : r);
+    }
+
+    for (; i < n; i++)
+        r = is_max ? (a[i] > r ? a[i] : r) : (a[i] < r ? a[i] : r);
+
+    return r;
+}
+
+// The byte kernels are simple loops.  A compiler may vectorize them.
+
+static void uint8_add(uint8_t* a, const uint8_t* b, int32_t n) {
+    for (int32_t i = 0; i < n; i++)
+        a[i] = (uint8_t)(a[i] + b[i]);
+}
+
+static void uint8_scale(uint8_t* a, int32_t n, int32_t k) {
+    for (int32_t i = 0; i < n; i++)
+        a[i] = (uint8_t)(a[i] * (uint32_t)k);
+}
+
+static int32_t uint8_dot(const uint8_t* a, const uint8_t* b, int32_t n) {
+    uint32_t r = 0;
+    for (int32_t i = 0; i < n; i++)
+        r += (uint32_t)a[i] * b[i];
+
+    return (int32_t)r;
+}
+
+static int32_t uint8_sum(const uint8_t* a, int32_t n) {
+    uint32_t r = 0;
+    for (int32_t i = 0; i < n; i++)
+        r += a[i];
+
+    return (int32_t)r;
+}
+
+static int32_t uint8_min_max(const uint8_t* a, int32_t n, bool is_max) {
+    uint8_t r = a[0];
+    for (int32_t i = 1; i < n; i++)
+        r = is_max ? (a[i] > r ? a[i] : r) : (a[i] < r ? a[i] : r);
+
+    return r;
+}
+
+// throws an error unless 0 <= offset and offset + n <= len.
+static void bulk_range_check(int32_t offset, int32_t n, int32_t len, char* name) {
+    if (offset < 0 || offset > len - n)
+        runtime_index_error(offset < 0 ? offset : offset + n - 1, len, name);
+}
+
+// throws an error if an array of the given length is empty.
+static void bulk_empty_check(int32_t len, char* name) {
+    if (len <= 0)
+        runtime_index_error(0, len, name);
+}
+
+// these return the address of the first element of a fixed or growable array.
+static int32_t* intarray_elements(value_t obj);
+static float* floatarray_elements(value_t obj);
+static uint8_t* bytearray_elements(value_t obj);
+
+#define INTARRAY_LENGTH(obj)     ((int32_t)value_to_ptr(obj)->body[0])
+#define INTARRAY_ELEMENTS(obj)   intarray_elements(obj)
+#define FLOATARRAY_ELEMENTS(obj) floatarray_elements(obj)
+#define BYTEARRAY_LENGTH(obj)    ((int32_t)value_to_ptr(obj)->body[1])
+#define BYTEARRAY_ELEMENTS(obj)  bytearray_elements(obj)
+
+static value_t intarray_fill(value_t self, int32_t v) {
+    int32_fill(INTARRAY_ELEMENTS(self), INTARRAY_LENGTH(self), v);
+    return self;
+}
+
+static void intarray_set(value_t self, value_t src, int32_t offset) {
+    int32_t n = INTARRAY_LENGTH(src);
+    bulk_range_check(offset, n, INTARRAY_LENGTH(self), "Array<integer>.set");
+    memmove(INTARRAY_ELEMENTS(self) + offset, INTARRAY_ELEMENTS(src), n * sizeof(int32_t));
+}
+
+static void intarray_add(value_t self, value_t other) {
+    int32_t n = INTARRAY_LENGTH(self);
+    bulk_range_check(0, n, INTARRAY_LENGTH(other), "Array<integer>.add");
+    int32_add(INTARRAY_ELEMENTS(self), INTARRAY_ELEMENTS(other), n);
+}
+
+static void intarray_scale(value_t self, int32_t k) {
+    int32_scale(INTARRAY_ELEMENTS(self), INTARRAY_LENGTH(self), k);
+}
+
+static int32_t intarray_dot(value_t self, value_t other) {
+    int32_t n = INTARRAY_LENGTH(self);
+    bulk_range_check(0, n, INTARRAY_LENGTH(other), "Array<integer>.dot");
+    return int32_dot(INTARRAY_ELEMENTS(self), INTARRAY_ELEMENTS(other), n);
+}
+
+static int32_t intarray_sum(value_t self) {
+    return int32_sum(INTARRAY_ELEMENTS(self), INTARRAY_LENGTH(self));
+}
+
+static int32_t intarray_min(value_t self) {
+    bulk_empty_check(INTARRAY_LENGTH(self), "Array<integer>.min");
+    return int32_min_max(INTARRAY_ELEMENTS(self), INTARRAY_LENGTH(self), false);
+}
+
+static int32_t intarray_max(value_t self) {
+    bulk_empty_check(INTARRAY_LENGTH(self), "Array<integer>.max");
+    return int32_min_max(INTARRAY_ELEMENTS(self), INTARRAY_LENGTH(self), true);
+}
+
+static value_t floatarray_fill(value_t self, float v) {
+    float_fill(FLOATARRAY_ELEMENTS(self), INTARRAY_LENGTH(self), v);
+    return self;
+}
+
+static void floatarray_set(value_t self, value_t src, int32_t offset) {
+    int32_t n = INTARRAY_LENGTH(src);
+    bulk_range_check(offset, n, INTARRAY_LENGTH(self), "Array<float>.set");
+    memmove(FLOATARRAY_ELEMENTS(self) + offset, FLOATARRAY_ELEMENTS(src), n * sizeof(float));
+}
+
+static void floatarray_add(value_t self, value_t other) {
+    int32_t n = INTARRAY_LENGTH(self);
+    bulk_range_check(0, n, INTARRAY_LENGTH(other), "Array<float>.add");
+    float_add(FLOATARRAY_ELEMENTS(self), FLOATARRAY_ELEMENTS(other), n);
+}
+
+static void floatarray_scale(value_t self, float k) {
+    float_scale(FLOATARRAY_ELEMENTS(self), INTARRAY_LENGTH(self), k);
+}
+
+static float floatarray_dot(value_t self, value_t other) {
+    int32_t n = INTARRAY_LENGTH(self);
+    bulk_range_check(0, n, INTARRAY_LENGTH(other), "Array<float>.dot");
+    return float_dot(FLOATARRAY_ELEMENTS(self), FLOATARRAY_ELEMENTS(other), n);
+}
+
+static float floatarray_sum(value_t self) {
+    return float_sum(FLOATARRAY_ELEMENTS(self), INTARRAY_LENGTH(self));
+}
+
+static float floatarray_min(value_t self) {
+    bulk_empty_check(INTARRAY_LENGTH(self), "Array<float>.min");
+    return float_min_max(FLOATARRAY_ELEMENTS(self), INTARRAY_LENGTH(self), false);
+}
+
+static float floatarray_max(value_t self) {
+    bulk_empty_check(INTARRAY_LENGTH(self), "Array<float>.max");
+    return float_min_max(FLOATARRAY_ELEMENTS(self), INTARRAY_LENGTH(self), true);
+}
+
+static value_t bytearray_fill(value_t self, int32_t v) {
+    memset(BYTEARRAY_ELEMENTS(self), v & 0xff, BYTEARRAY_LENGTH(self));
+    return self;
+}
+
+static void bytearray_set(value_t self, value_t src, int32_t offset) {
+    int32_t n = BYTEARRAY_LENGTH(src);
+    bulk_range_check(offset, n, BYTEARRAY_LENGTH(self), "Uint8Array.set");
+    memmove(BYTEARRAY_ELEMENTS(self) + offset, BYTEARRAY_ELEMENTS(src), n);
+}
+
+static void bytearray_add(value_t self, value_t other) {
+    int32_t n = BYTEARRAY_LENGTH(self);
+    bulk_range_check(0, n, BYTEARRAY_LENGTH(other), "Uint8Array.add");
+    uint8_add(BYTEARRAY_ELEMENTS(self), BYTEARRAY_ELEMENTS(other), n);
+}
+
+static void bytearray_scale(value_t self, int32_t k) {
+    uint8_scale(BYTEARRAY_ELEMENTS(self), BYTEARRAY_LENGTH(self), k);
+}
+
+static int32_t bytearray_dot(value_t self, value_t other) {
+    int32_t n = BYTEARRAY_LENGTH(self);
+    bulk_range_check(0, n, BYTEARRAY_LENGTH(other), "Uint8Array.dot");
+    return uint8_dot(BYTEARRAY_ELEMENTS(self), BYTEARRAY_ELEMENTS(other), n);
+}
+
+static int32_t bytearray_sum(value_t self) {
+    return uint8_sum(BYTEARRAY_ELEMENTS(self), BYTEARRAY_LENGTH(self));
+}
+
+static int32_t bytearray_min(value_t self) {
+    bulk_empty_check(BYTEARRAY_LENGTH(self), "Uint8Array.min");
+    return uint8_min_max(BYTEARRAY_ELEMENTS(self), BYTEARRAY_LENGTH(self), false);
+}
+
+static int32_t bytearray_max(value_t self) {
+    bulk_empty_check(BYTEARRAY_LENGTH(self), "Uint8Array.max");
+    return uint8_min_max(BYTEARRAY_ELEMENTS(self), BYTEARRAY_LENGTH(self), true);
+}
+
+/*
+  Sorting and searching on integer[], float[], and Uint8Array.
+  integer[] and float[] are sorted by introsort: quicksort with a median-of-three pivot,
+  which switches to heapsort when the recursion gets too deep, and insertion sort
+  for short ranges.  Uint8Array is sorted by counting sort.
+  A NaN is greater than any other float, so NaNs are moved to the end.
+  binarySearch() returns the index of the given value if it is found in a sorted array.
+  Otherwise, it returns -(i + 1), where i is the index at which the value would be inserted.
+*/
+
+#define SORT_THRESHOLD      16
+
+#define NUMBER_LESS(a, b)   ((a) < (b))
+#define FLOAT_LESS(a, b)    ((a) < (b) || ((b) != (b) && (a) == (a)))
+
+#define SORT_KERNELS(name, type, less) \
+static void name##_insertion_sort(type* a, int32_t n) { \
+    for (int32_t i = 1; i < n; i++) { \
+        type v = a[i]; \
+        int32_t j = i; \
+        for (; j > 0 && less(v, a[j - 1]); j--) \
+            a[j] = a[j - 1]; \
+        a[j] = v; \
+    } \
+} \
+\
+static void name##_sift_down(type* a, int32_t i, int32_t n) { \
+    type v = a[i]; \
+    for (int32_t c; (c = 2 * i + 1) < n; i = c) { \
+        if (c + 1 < n && less(a[c], a[c + 1])) \
+            c++; \
+        if (!less(v, a[c])) \
+            break; \
+        a[i] = a[c]; \
+    } \
+    a[i] = v; \
+} \
+\
+static void name##_heap_sort(type* a, int32_t n) { \
+    for (int32_t i = n / 2 - 1; i >= 0; i--) \
+        name##_sift_down(a, i, n); \
+    for (int32_t i = n - 1; i > 0; i--) { \
+        type t = a[0]; a[0] = a[i]; a[i] = t; \
+        name##_sift_down(a, 0, i); \
+    } \
+} \
+\
+static void name##_introsort(type* a, int32_t n, int32_t depth) { \
+    while (n > SORT_THRESHOLD) { \
+        if (depth-- <= 0) { \
+            name##_heap_sort(a, n); \
+            return; \
+        } \
+        type* m = a + n / 2; \
+        type* last = a + n - 1; \
+        type t; \
+        if (less(*m, *a)) { t = *m; *m = *a; *a = t; } \
+        if (less(*last, *m)) { \
+            t = *m; *m = *last; *last = t; \
+            if (less(*m, *a)) { t = *m; *m = *a; *a = t; } \
+        } \
+        type pivot = *m; \
+        int32_t i = -1, j = n; \
+        for (;;) { \
+            do i++; while (less(a[i], pivot)); \
+            do j--; while (less(pivot, a[j])); \
+            if (i >= j) \
+                break; \
+            t = a[i]; a[i] = a[j]; a[j] = t; \
+        } \
+        int32_t left = j + 1;   /* sort the shorter part first */ \
+        if (left < n - left) { \
+            name##_introsort(a, left, depth); \
+            a += left; \
+            n -= left; \
+        } \
+        else { \
+            name##_introsort(a + left, n - left, depth); \
+            n = left; \
+        } \
+    } \
+    name##_insertion_sort(a, n); \
+} \
+\
+static void name##_sort(type* a, int32_t n) { \
+    int32_t depth = 0; \
+    for (int32_t k = n; k > 1; k >>= 1) \
+        depth += 2; \
+    name##_introsort(a, n, depth); \
+}
+
+// vtype is the type of a value searched for.
+#define SEARCH_KERNELS(name, type, vtype, less) \
+static int32_t name##_binary_search(const type* a, int32_t n, vtype v) { \
+    int32_t low = 0, high = n; \
+    while (low < high) { \
+        int32_t mid = low + (high - low) / 2; \
+        if (less(a[mid], v)) \
+            low = mid + 1; \
+        else \
+            high = mid; \
+    } \
+    return low < n && !less(v, a[low]) ? low : -(low + 1); \
+} \
+\
+static int32_t name##_index_of(const type* a, int32_t n, vtype v) { \
+    for (int32_t i = 0; i < n; i++) \
+        if (a[i] == v) \
+            return i; \
+    return -1; \
+} \
+\
+static void name##_reverse(type* a, int32_t n) { \
+    for (int32_t i = 0, j = n - 1; i < j; i++, j--) { \
+        type t = a[i]; a[i] = a[j]; a[j] = t; \
+    } \
+}
+
+SORT_KERNELS(int32, int32_t, NUMBER_LESS)
+SEARCH_KERNELS(int32, int32_t, int32_t, NUMBER_LESS)
+SORT_KERNELS(float, float, FLOAT_LESS)
+SEARCH_KERNELS(float, float, float, FLOAT_LESS)
+SEARCH_KERNELS(uint8, uint8_t, int32_t, NUMBER_LESS)
+
+static void uint8_sort(uint8_t* a, int32_t n) {
+    if (n <= SORT_THRESHOLD) {
+        for (int32_t i = 1; i < n; i++) {
+            uint8_t v = a[i];
+            int32_t j = i;
+            for (; j > 0 && v < a[j - 1]; j--)
+                a[j] = a[j - 1];
+            a[j] = v;
+        }
+        return;
+    }
+
+    int32_t counts[256] = { 0 };
+    for (int32_t i = 0; i < n; i++)
+        counts[a[i]]++;
+
+    for (int32_t v = 0, i = 0; v < 256; v++) {
+        memset(a + i, v, counts[v]);
+        i += counts[v];
+    }
+}
+
+static value_t intarray_sort(value_t self) {
+    int32_sort(INTARRAY_ELEMENTS(self), INTARRAY_LENGTH(self));
+    return self;
+}
+
+static int32_t intarray_binary_search(value_t self, int32_t v) {
+    return int32_binary_search(INTARRAY_ELEMENTS(self), INTARRAY_LENGTH(self), v);
+}
+
+static int32_t intarray_index_of(value_t self, int32_t v) {
+    return int32_index_of(INTARRAY_ELEMENTS(self), INTARRAY_LENGTH(self), v);
+}
+
+static value_t intarray_reverse(value_t self) {
+    int32_reverse(INTARRAY_ELEMENTS(self), INTARRAY_LENGTH(self));
+    return self;
+}
+
+static value_t floatarray_sort(value_t self) {
+    float_sort(FLOATARRAY_ELEMENTS(self), INTARRAY_LENGTH(self));
+    return self;
+}
+
+static int32_t floatarray_binary_search(value_t self, float v) {
+    return float_binary_search(FLOATARRAY_ELEMENTS(self), INTARRAY_LENGTH(self), v);
+}
+
+static int32_t floatarray_index_of(value_t self, float v) {
+    return float_index_of(FLOATARRAY_ELEMENTS(self), INTARRAY_LENGTH(self), v);
+}
+
+static value_t floatarray_reverse(value_t self) {
+    float_reverse(FLOATARRAY_ELEMENTS(self), INTARRAY_LENGTH(self));
+    return self;
+}
+
+static value_t bytearray_sort(value_t self) {
+    uint8_sort(BYTEARRAY_ELEMENTS(self), BYTEARRAY_LENGTH(self));
+    return self;
+}
+
+static int32_t bytearray_binary_search(value_t self, int32_t v) {
+    return uint8_binary_search(BYTEARRAY_ELEMENTS(self), BYTEARRAY_LENGTH(self), v);
+}
+
+static int32_t bytearray_index_of(value_t self, int32_t v) {
+    return uint8_index_of(BYTEARRAY_ELEMENTS(self), BYTEARRAY_LENGTH(self), v);
+}
+
+static value_t bytearray_reverse(value_t self) {
+    uint8_reverse(BYTEARRAY_ELEMENTS(self), BYTEARRAY_LENGTH(self));
+    return self;
+}
+
+#define BULK_METHOD_TABLE(...)  { .size = 14, \
+    .names = (const uint16_t[]){ /* fill */ 10, /* set */ 11, /* add */ 12, /* scale */ 13, \
+                                 /* dot */ 14, /* sum */ 15, /* min */ 16, /* max */ 17, \
+                                 /* push */ 4, /* pop */ 5, /* sort */ 22, /* binarySearch */ 23, \
+                                 /* indexOf */ 24, /* reverse */ 25 }, \
+    .signatures = (const char* const[]){ __VA_ARGS__ }, \
+    .sorted = (const uint16_t[]){ 8, 9, 0, 1, 2, 3, 4, 5, 6, 7, 10, 11, 12, 13 } }
+
+// push() and pop() on a typed array whose length is fixed.
+// Only a growable array accepts them.  See gc_new_growable_array().
+static void fixed_length_error() {
+    runtime_error("push/pop on a fixed-length array");
+}
+
+static int32_t fixed_intarray_push(value_t self, int32_t v) {
+    fixed_length_error();
+    return 0;
+}
+
+static int32_t fixed_intarray_pop(value_t self) {
+    fixed_length_error();
+    return 0;
+}
+
+static int32_t fixed_floatarray_push(value_t self, float v) {
+    fixed_length_error();
+    return 0;
+}
+
+static float fixed_floatarray_pop(value_t self) {
+    fixed_length_error();
+    return 0.0f;
+}
+
+// An int32_t array
+
+static CLASS_OBJECT(intarray_object, 14) = {
+    .body = { .s = -1, .i = SIZE_NO_POINTER, .cn = "integer[]", .sc = &object_class.clazz, .an = "[i", .pt = DEFAULT_PTABLE,
+              .mt = BULK_METHOD_TABLE("(i)[i", "([ii)v", "([i)v", "(i)v", "([i)i", "()i", "()i", "()i", "(i)i", "()i",
+                                      "()[i", "(i)i", "(i)i", "()[i"),
+              .vtbl = { intarray_fill, intarray_set, intarray_add, intarray_scale,
+                        intarray_dot, intarray_sum, intarray_min, intarray_max,
+                        fixed_intarray_push, fixed_intarray_pop,
+                        intarray_sort, intarray_binary_search, intarray_index_of, intarray_reverse } }};
+
+value_t safe_value_to_intarray(bool nullable, value_t v) {
+    return safe_value_to_value(nullable, &intarray_object.clazz, v);
+}
+
+static pointer_t gc_new_intarray_base(int32_t n) {
+    if (n < 0)
+        n = 0;
+
+    pointer_t obj = allocate_heap(n + 1);
+    set_object_header(obj, &intarray_object.clazz);
+    obj->body[0] = n;
+    return obj;
+}
+
+/*
+  An int32_t array.  It cannot contain a pointer.
+  n: the number of elements. n >= 0.
+
+  1st word is the number of elements.
+  2nd, 3rd, ... words hold elements.
+*/
+value_t gc_new_intarray(int32_t n, int32_t init_value) {
+    pointer_t obj = gc_new_intarray_base(n);
+    for (int32_t i = 1; i <= n; i++)
+        obj->body[i] = init_value;
 
     return ptr_to_value(obj);
 }
@@ -1074,11 +2506,9 @@ value_t gc_copy_intarray(value_t src) {
     rootset.values[0] = src;
     pointer_t destp;
     if (gc_is_instance_of(&intarray_object.clazz, src)) {
-        pointer_t srcp = value_to_ptr(src);
-        int32_t n = srcp->body[0];
+        int32_t n = value_to_ptr(src)->body[0];
         destp = gc_new_intarray_base(n);
-        for (int32_t i = 1; i <= n; i++)
-            destp->body[i] = srcp->body[i];
+        memcpy(&destp->body[1], intarray_elements(src), n * sizeof(int32_t));
     }
     else {
         int32_t n = gc_array_length(safe_value_to_anyarray(false, src));
@@ -1103,6 +2533,14 @@ value_t gc_make_intarray(int32_t n, ...) {
     return ptr_to_value(arrayp);
 }
 
+// makes an array from n elements stored in a C array.
+// The code generator uses it for an array literal whose elements are constants.
+value_t gc_make_intarray_from(int32_t n, const int32_t* elements) {
+    pointer_t arrayp = gc_new_intarray_base(n);
+    memcpy(&arrayp->body[1], elements, n * sizeof(int32_t));
+    return ptr_to_value(arrayp);
+}
+
 int32_t gc_intarray_length(value_t obj) {
     pointer_t objp = value_to_ptr(obj);
     return objp->body[0];
@@ -1112,7 +2550,7 @@ int32_t* gc_intarray_get(value_t obj, int32_t index) {
     pointer_t objp = value_to_ptr(obj);
     int32_t len = objp->body[0];
     if (0 <= index && index < len)
-        return (int32_t*)&objp->body[index + 1];
+        return intarray_elements(obj) + index;
     else {
         runtime_index_error(index, len, "Array<integer>.get/set");
         return 0;
@@ -1120,15 +2558,19 @@ int32_t* gc_intarray_get(value_t obj, int32_t index) {
 }
 
 bool gc_is_intarray(value_t v) {
-    const class_object* type = gc_get_class_of(v);
-    return type == &intarray_object.clazz;
+    return gc_is_instance_of(&intarray_object.clazz, v);
 }
 
 // A float array
 
-static CLASS_OBJECT(floatarray_object, 1) = {
-    .clazz = { .size = -1, .start_index = SIZE_NO_POINTER, .name = "float[]",
-               .superclass = &object_class.clazz, .array_type_name = "[f", .table = DEFAULT_PTABLE, .mtable = DEFAULT_MTABLE }};
+static CLASS_OBJECT(floatarray_object, 14) = {
+    .body = { .s = -1, .i = SIZE_NO_POINTER, .cn = "float[]", .sc = &object_class.clazz, .an = "[f", .pt = DEFAULT_PTABLE,
+              .mt = BULK_METHOD_TABLE("(f)[f", "([fi)v", "([f)v", "(f)v", "([f)f", "()f", "()f", "()f", "(f)i", "()f",
+                                      "()[f", "(f)i", "(f)i", "()[f"),
+              .vtbl = { floatarray_fill, floatarray_set, floatarray_add, floatarray_scale,
+                        floatarray_dot, floatarray_sum, floatarray_min, floatarray_max,
+                        fixed_floatarray_push, fixed_floatarray_pop,
+                        floatarray_sort, floatarray_binary_search, floatarray_index_of, floatarray_reverse } }};
 
 value_t safe_value_to_floatarray(bool nullable, value_t v) {
     return safe_value_to_value(nullable, &floatarray_object.clazz, v);
@@ -1155,6 +2597,8 @@ value_t gc_new_floatarray(int32_t n, float init_value) {
     return ptr_to_value(obj);
 }
 
+static void array_to_floats(float* dest, value_t src);
+
 value_t gc_copy_floatarray(value_t src) {
     if (is_int_value(src))
         return gc_new_floatarray(value_to_int(src), 0);
@@ -1163,17 +2607,14 @@ value_t gc_copy_floatarray(value_t src) {
     rootset.values[0] = src;
     pointer_t destp;
     if (gc_is_instance_of(&floatarray_object.clazz, src)) {
-        pointer_t srcp = value_to_ptr(src);
-        int32_t n = srcp->body[0];
+        int32_t n = value_to_ptr(src)->body[0];
         destp = gc_new_floatarray_base(n);
-        for (int32_t i = 1; i <= n; i++)
-            destp->body[i] = srcp->body[i];
+        memcpy(&destp->body[1], floatarray_elements(src), n * sizeof(float));
     }
     else {
         int32_t n = gc_array_length(safe_value_to_anyarray(false, src));
         destp = gc_new_floatarray_base(n);
-        for (int32_t i = 0; i < n; i++)
-            *(float*)&destp->body[i + 1] = safe_value_to_float(*gc_array_get(src, i));
+        array_to_floats((float*)&destp->body[1], src);
     }
 
     DELETE_ROOT_SET(rootset)
@@ -1195,6 +2636,13 @@ value_t gc_make_floatarray(int32_t n, ...) {
     return ptr_to_value(arrayp);
 }
 
+// see gc_make_intarray_from().
+value_t gc_make_floatarray_from(int32_t n, const float* elements) {
+    pointer_t arrayp = gc_new_floatarray_base(n);
+    memcpy(&arrayp->body[1], elements, n * sizeof(float));
+    return ptr_to_value(arrayp);
+}
+
 int32_t gc_floatarray_length(value_t obj) {
     pointer_t objp = value_to_ptr(obj);
     return objp->body[0];
@@ -1204,23 +2652,133 @@ float* gc_floatarray_get(value_t obj, int32_t index) {
     pointer_t objp = value_to_ptr(obj);
     int32_t len = objp->body[0];
     if (0 <= index && index < len)
-        return (float*)&objp->body[index + 1];
+        return floatarray_elements(obj) + index;
     else {
         runtime_index_error(index, len, "Array<float>.get/set");
         return 0;
     }
 }
 
-bool gc_is_floatarray(value_t v) {
-    const class_object* type = gc_get_class_of(v);
-    return type == &floatarray_object.clazz;
+bool gc_is_floatarray(value_t v) {
+    return gc_is_instance_of(&floatarray_object.clazz, v);
+}
+
+// Read-only arrays of integer and float
+
+/*
+  A read-only integer[] or float[] object is not allocated in the heap memory.
+  On microcontrollers, it is a constant object in the read-only data section (flash memory).
+  See STATIC_INTARRAY in c-runtime.h.  Its layout is the same as the layout of
+  a fixed-length integer[] or float[] object.  The garbage collector does not
+  mark or sweep it.  Assignment to its elements throws an error.
+*/
+static void readonly_array_error() {
+    runtime_error("assignment to a read-only array");
+}
+
+static value_t readonly_intarray_fill(value_t self, int32_t v) {
+    readonly_array_error();
+    return self;
+}
+
+static value_t readonly_floatarray_fill(value_t self, float v) {
+    readonly_array_error();
+    return self;
+}
+
+static void readonly_array_set(value_t self, value_t src, int32_t offset) { readonly_array_error(); }
+
+static void readonly_array_add(value_t self, value_t other) { readonly_array_error(); }
+
+static void readonly_intarray_scale(value_t self, int32_t k) { readonly_array_error(); }
+
+static void readonly_floatarray_scale(value_t self, float k) { readonly_array_error(); }
+
+// sort() and reverse() on a read-only array.
+static value_t readonly_array_reorder(value_t self) {
+    readonly_array_error();
+    return self;
+}
+
+CLASS_OBJECT(readonly_intarray, 14) = {
+    .body = { .s = -1, .i = SIZE_NO_POINTER, .cn = "integer[]", .sc = &intarray_object.clazz, .an = "[i", .pt = DEFAULT_PTABLE,
+              .mt = BULK_METHOD_TABLE("(i)[i", "([ii)v", "([i)v", "(i)v", "([i)i", "()i", "()i", "()i", "(i)i", "()i",
+                                      "()[i", "(i)i", "(i)i", "()[i"),
+              .vtbl = { readonly_intarray_fill, readonly_array_set, readonly_array_add, readonly_intarray_scale,
+                        intarray_dot, intarray_sum, intarray_min, intarray_max,
+                        fixed_intarray_push, fixed_intarray_pop,
+                        readonly_array_reorder, intarray_binary_search, intarray_index_of, readonly_array_reorder } }};
+
+CLASS_OBJECT(readonly_floatarray, 14) = {
+    .body = { .s = -1, .i = SIZE_NO_POINTER, .cn = "float[]", .sc = &floatarray_object.clazz, .an = "[f", .pt = DEFAULT_PTABLE,
+              .mt = BULK_METHOD_TABLE("(f)[f", "([fi)v", "([f)v", "(f)v", "([f)f", "()f", "()f", "()f", "(f)i", "()f",
+                                      "()[f", "(f)i", "(f)i", "()[f"),
+              .vtbl = { readonly_floatarray_fill, readonly_array_set, readonly_array_add, readonly_floatarray_scale,
+                        floatarray_dot, floatarray_sum, floatarray_min, floatarray_max,
+                        fixed_floatarray_push, fixed_floatarray_pop,
+                        readonly_array_reorder, floatarray_binary_search, floatarray_index_of, readonly_array_reorder } }};
+
+// returns a read-only array that the garbage collector does not manage.
+// This is called only on LINUX64; the object is allocated once and recorded in *cache.
+// See STATIC_INTARRAY_VALUE in c-runtime.h.  On microcontrollers, the object is statically
+// allocated in the read-only data section.
+// It throws an error if there is no room for the object since a heap object
+// recorded in *cache would not be read-only or reachable from the root set.
+static value_t gc_static_array(value_t* cache, const class_object* clazz, int32_t n, const void* elements) {
+#ifdef LINUX64
+    int32_t size = (n + 3) & ~1;    // the header and the length.  an even number.
+    if (static_arrays_num >= STATIC_ARRAYS_NUM || static_arrays_used + size > STATIC_ARRAYS_SIZE)
+        return runtime_memory_allocation_error("too many constant arrays");
+
+    pointer_t obj = (pointer_t)&static_arrays[static_arrays_used];
+    static_arrays_used += size;
+    static_array_caches[static_arrays_num++] = cache;
+    set_object_header(obj, clazz);
+    obj->body[0] = n;
+    memcpy(&obj->body[1], elements, n * sizeof(int32_t));
+    return *cache = ptr_to_value(obj);
+#else
+    return runtime_error("a constant array is not statically allocated");
+#endif
+}
+
+value_t gc_static_intarray(value_t* cache, int32_t n, const int32_t* elements) {
+    return gc_static_array(cache, &readonly_intarray.clazz, n, elements);
+}
+
+value_t gc_static_floatarray(value_t* cache, int32_t n, const float* elements) {
+    return gc_static_array(cache, &readonly_floatarray.clazz, n, elements);
+}
+
+// the address of an element that a value is assigned to.
+// It throws an error if the array is a read-only array.
+int32_t* gc_intarray_lval(value_t obj, int32_t index) {
+    int32_t* elem = gc_intarray_get(obj, index);
+    if (!gc_is_heap_object(value_to_ptr(obj)))
+        readonly_array_error();
+
+    return elem;
+}
+
+float* gc_floatarray_lval(value_t obj, int32_t index) {
+    float* elem = gc_floatarray_get(obj, index);
+    if (!gc_is_heap_object(value_to_ptr(obj)))
+        readonly_array_error();
+
+    return elem;
 }
 
 // A byte array and a boolean array
 
-CLASS_OBJECT(class_Uint8Array, 1) = {
-    .clazz = { .size = -1, .start_index = SIZE_NO_POINTER, .name = "Uint8Array",
-               .superclass = &object_class.clazz, .array_type_name = "'Uint8Array'", .table = DEFAULT_PTABLE, .mtable = DEFAULT_MTABLE }};
+CLASS_OBJECT(class_Uint8Array, 14) = {
+    .body = { .s = -1, .i = SIZE_NO_POINTER, .cn = "Uint8Array", .sc = &object_class.clazz, .an = "'Uint8Array'", .pt = DEFAULT_PTABLE,
+              .mt = BULK_METHOD_TABLE("(i)'Uint8Array'", "('Uint8Array'i)v", "('Uint8Array')v", "(i)v",
+                                      "('Uint8Array')i", "()i", "()i", "()i", "(i)i", "()i",
+                                      "()'Uint8Array'", "(i)i", "(i)i", "()'Uint8Array'"),
+              .vtbl = { bytearray_fill, bytearray_set, bytearray_add, bytearray_scale,
+                        bytearray_dot, bytearray_sum, bytearray_min, bytearray_max,
+                        fixed_intarray_push, fixed_intarray_pop,
+                        bytearray_sort, bytearray_binary_search, bytearray_index_of, bytearray_reverse } }};
 
 static CLASS_OBJECT(boolarray_object, 1) = {
     .clazz = { .size = -1, .start_index = SIZE_NO_POINTER, .name = "boolean[]",
@@ -1271,12 +2829,9 @@ value_t gc_copy_bytearray(bool is_boolean, value_t src) {
     pointer_t destp;
     if (gc_is_instance_of(&boolarray_object.clazz, src)
              || gc_is_instance_of(&class_Uint8Array.clazz, src)) {
-        pointer_t srcp = value_to_ptr(src);
-        int32_t m = srcp->body[0];
-        int32_t n = srcp->body[1];
+        int32_t n = value_to_ptr(src)->body[1];
         destp = gc_new_bytearray_base(n, is_boolean ? &boolarray_object.clazz : &class_Uint8Array.clazz);
-        for (int32_t i = 1; i <= m; i++)
-            destp->body[i] = srcp->body[i];
+        memcpy(&destp->body[2], bytearray_elements(src), n);
     }
     else {
         int32_t n = gc_array_length(safe_value_to_anyarray(false, src));
@@ -1316,13 +2871,35 @@ int32_t gc_bytearray_length(value_t obj) {
     return objp->body[1];
 }
 
+// returns a pointer to the bytes of a Uint8Array object or the characters of a string
+// without copying them, and stores the number of the bytes in *len.
+// A rope is flattened if it has not been.  The characters may not end with the null character.
+// It returns NULL if obj is neither a Uint8Array object nor a string.
+const uint8_t* gc_bytes_of(value_t obj, int32_t* len) {
+    if (gc_is_instance_of(&class_Uint8Array.clazz, obj)) {
+        *len = value_to_ptr(obj)->body[1];
+        return bytearray_elements(obj);
+    }
+    else if (gc_is_string_object(obj)) {
+        if (gc_is_string_rope(obj))
+            flatten_rope(obj);
+
+        *len = string_object_length(obj);
+        return (const uint8_t*)flat_string_chars(obj);
+    }
+    else {
+        *len = 0;
+        return NULL;
+    }
+}
+
 // Obtains an unsigned 8bit value of the byte element at index.
 // When index is 2, the 2nd element of an 8bit array is returned.
 uint8_t* gc_bytearray_get(value_t obj, int32_t idx) {
     pointer_t objp = value_to_ptr(obj);
     int32_t len = objp->body[1];
     if (0 <= idx && idx < len)
-        return (uint8_t*)&objp->body[2] + idx;
+        return bytearray_elements(obj) + idx;
     else {
         if (gc_is_instance_of(&boolarray_object.clazz, obj))
             runtime_index_error(idx, len, "Array<boolean>.get/set");
@@ -1337,6 +2914,206 @@ bool gc_is_boolarray(value_t v) {
     return type == &boolarray_object.clazz;
 }
 
+// Int8Array, Int16Array, Uint16Array, and Uint32Array
+
+#define COMPACT_ARRAY_CLASS(cname, type_name)  CLASS_OBJECT(cname, 1) = { \
+    .clazz = { .size = -1, .start_index = SIZE_NO_POINTER, .name = type_name, \
+               .superclass = &object_class.clazz, .array_type_name = "'" type_name "'", .table = DEFAULT_PTABLE, .mtable = DEFAULT_MTABLE }}
+
+COMPACT_ARRAY_CLASS(class_Int8Array, "Int8Array");
+COMPACT_ARRAY_CLASS(class_Int16Array, "Int16Array");
+COMPACT_ARRAY_CLASS(class_Uint16Array, "Uint16Array");
+COMPACT_ARRAY_CLASS(class_Uint32Array, "Uint32Array");
+
+/*
+  An array of 8, 16, or 32 bit integers.  We call it a compact array.
+  It cannot contain a pointer.  Its layout is the same as a byte array's.
+  1st word is the size of this array in words.
+  2nd word is the number of elements.
+  3rd, 4th, ... words hold elements.
+
+  The elements are read as integer values.  An element of Uint32Array
+  larger than 0x7fffffff is read as a negative integer since an integer
+  is a signed 32 bit value.
+*/
+static pointer_t gc_new_compact_array_base(int32_t n, int32_t elem_size, const struct class_object* clazz) {
+    if (n < 0)
+        n = 0;
+
+    int32_t m = (n * elem_size + 3) / 4 + 1;
+    pointer_t obj = allocate_heap(m + 1);
+    set_object_header(obj, clazz);
+    obj->body[0] = m;
+    obj->body[1] = n;
+    return obj;
+}
+
+static void* compact_array_get(value_t obj, int32_t idx, int32_t elem_size, char* name) {
+    pointer_t objp = value_to_ptr(obj);
+    int32_t len = objp->body[1];
+    if (0 <= idx && idx < len)
+        return (uint8_t*)&objp->body[2] + idx * elem_size;
+    else {
+        runtime_index_error(idx, len, name);
+        return 0;
+    }
+}
+
+value_t gc_new_int8array(int32_t n, int32_t init_value) {
+    pointer_t obj = gc_new_compact_array_base(n, sizeof(int8_t), &class_Int8Array.clazz);
+    memset(&obj->body[2], init_value & 0xff, obj->body[1]);
+    return ptr_to_value(obj);
+}
+
+int8_t* gc_int8array_get(value_t obj, int32_t idx) {
+    return (int8_t*)compact_array_get(obj, idx, sizeof(int8_t), "Int8Array.get/set");
+}
+
+int8_t* gc_int8array_base(value_t obj) {
+    return (int8_t*)&value_to_ptr(obj)->body[2];
+}
+
+value_t gc_new_int16array(int32_t n, int32_t init_value) {
+    pointer_t obj = gc_new_compact_array_base(n, sizeof(int16_t), &class_Int16Array.clazz);
+    int16_t* elements = (int16_t*)&obj->body[2];
+    for (int32_t i = 0; i < obj->body[1]; i++)
+        elements[i] = (int16_t)init_value;
+
+    return ptr_to_value(obj);
+}
+
+int16_t* gc_int16array_get(value_t obj, int32_t idx) {
+    return (int16_t*)compact_array_get(obj, idx, sizeof(int16_t), "Int16Array.get/set");
+}
+
+int16_t* gc_int16array_base(value_t obj) {
+    return (int16_t*)&value_to_ptr(obj)->body[2];
+}
+
+value_t gc_new_uint16array(int32_t n, int32_t init_value) {
+    pointer_t obj = gc_new_compact_array_base(n, sizeof(uint16_t), &class_Uint16Array.clazz);
+    uint16_t* elements = (uint16_t*)&obj->body[2];
+    for (int32_t i = 0; i < obj->body[1]; i++)
+        elements[i] = (uint16_t)init_value;
+
+    return ptr_to_value(obj);
+}
+
+uint16_t* gc_uint16array_get(value_t obj, int32_t idx) {
+    return (uint16_t*)compact_array_get(obj, idx, sizeof(uint16_t), "Uint16Array.get/set");
+}
+
+uint16_t* gc_uint16array_base(value_t obj) {
+    return (uint16_t*)&value_to_ptr(obj)->body[2];
+}
+
+// The elements of Uint32Array are accessed through int32_t*.
+// See the comment on gc_new_compact_array_base().
+value_t gc_new_uint32array(int32_t n, int32_t init_value) {
+    pointer_t obj = gc_new_compact_array_base(n, sizeof(uint32_t), &class_Uint32Array.clazz);
+    int32_fill((int32_t*)&obj->body[2], obj->body[1], init_value);
+    return ptr_to_value(obj);
+}
+
+int32_t* gc_uint32array_get(value_t obj, int32_t idx) {
+    return (int32_t*)compact_array_get(obj, idx, sizeof(uint32_t), "Uint32Array.get/set");
+}
+
+int32_t* gc_uint32array_base(value_t obj) {
+    return (int32_t*)&value_to_ptr(obj)->body[2];
+}
+
+// true if the class is Int8Array, Int16Array, Uint16Array, or Uint32Array.
+static bool is_compact_array_class(const class_object* clazz) {
+    return clazz == &class_Int8Array.clazz || clazz == &class_Int16Array.clazz
+           || clazz == &class_Uint16Array.clazz || clazz == &class_Uint32Array.clazz;
+}
+
+// StringBuilder
+
+static value_t string_builder_append(value_t self, value_t v);
+static value_t string_builder_to_string(value_t self);
+
+/*
+  A string builder.  body[0] is the length of the string and body[1] is a buffer,
+  a Uint8Array object.  The capacity of the buffer doubles when it is full.
+*/
+CLASS_OBJECT(class_StringBuilder, 2) = {
+    .body = { .s = 2, .i = 1, .cn = "StringBuilder", .sc = &object_class.clazz, .an = NULL, .pt = DEFAULT_PTABLE,
+              .mt = { .size = 2,
+                      .names = (const uint16_t[]){ /* append */ 8, /* toString */ 9 },
+                      .signatures = (const char* const[]){ "(a)'StringBuilder'", "()s" },
+                      .sorted = (const uint16_t[]){ 0, 1 } },
+              .vtbl = { string_builder_append, string_builder_to_string } }};
+
+#define STRING_BUILDER_CAPACITY     32
+
+value_t gc_new_string_builder() {
+    ROOT_SET(rootset, 1)
+    value_t self = rootset.values[0] = gc_new_object(&class_StringBuilder.clazz);
+    value_t buf = ptr_to_value(gc_new_bytearray_base(STRING_BUILDER_CAPACITY, &class_Uint8Array.clazz));
+    pointer_t selfp = value_to_ptr(self);
+    selfp->body[0] = 0;
+    gc_write_barrier(selfp, buf);
+    selfp->body[1] = buf;
+    DELETE_ROOT_SET(rootset)
+    return self;
+}
+
+// appends the string representation of v.
+static value_t string_builder_append(value_t self, value_t v) {
+    ROOT_SET(rootset, 2)
+    rootset.values[0] = self;
+    rootset.values[1] = v;
+    pointer_t selfp = value_to_ptr(self);
+    int32_t len = selfp->body[0];
+    char buf2[NUMBER_STRING_SIZE];
+    int32_t len2 = string_length_with_buffer(v, buf2);
+    pointer_t buf = value_to_ptr(selfp->body[1]);
+    int32_t capacity = buf->body[1];
+    if (len + len2 + 1 > capacity) {
+        // the null character is also stored in the buffer.
+        do {
+            capacity *= 2;
+        } while (len + len2 + 1 > capacity);
+
+        pointer_t new_buf = gc_new_bytearray_base(capacity, &class_Uint8Array.clazz);
+        buf = value_to_ptr(selfp->body[1]);
+        memcpy(&new_buf->body[2], &buf->body[2], len);
+        value_t new_bufv = ptr_to_value(new_buf);
+        gc_write_barrier(selfp, new_bufv);
+        selfp->body[1] = new_bufv;
+        buf = new_buf;
+    }
+
+    append_to_cstring((char*)&buf->body[2] + len, v, len2, buf2);
+    selfp->body[0] = len + len2;
+    DELETE_ROOT_SET(rootset)
+    return self;
+}
+
+value_t gc_string_builder_append(value_t self, value_t v) {
+    return string_builder_append(self, v);
+}
+
+// returns a String object containing a copy of the current string.
+static value_t string_builder_to_string(value_t self) {
+    ROOT_SET(rootset, 1)
+    rootset.values[0] = self;
+    int32_t len = value_to_ptr(self)->body[0];
+    pointer_t str = make_string_object(len);
+    pointer_t buf = value_to_ptr(value_to_ptr(self)->body[1]);
+    char* chars = string_instance_chars(str);
+    memcpy(chars, &buf->body[2], len);
+    chars[len] = '\0';
+    DELETE_ROOT_SET(rootset)
+    return ptr_to_value(str);
+}
+
+value_t gc_string_builder_to_string(value_t self) {
+    return string_builder_to_string(self);
+}
+
 // A fixed-length array
 
 CLASS_OBJECT(class_FixedArray, 1) = {
@@ -1380,73 +3157,512 @@ inline static void fast_fixedarray_set(value_t obj, uint32_t index, value_t new_
     objp->body[index + 1] = new_value;
 }
 
-static value_t duplicate_fixedarray(int32_t n, int32_t offset, value_t vec) {
+int32_t gc_fixedarray_length(value_t obj) {
+    pointer_t objp = value_to_ptr(obj);
+    return objp->body[0];
+}
+
+value_t gc_fixedarray_get(value_t obj, int32_t idx) {
+    pointer_t objp = value_to_ptr(obj);
+    int32_t len = objp->body[0];
+    if (0 <= idx && idx < len)
+        return objp->body[idx + 1];
+    else {
+        runtime_index_error(idx, len, "FixedArray.get");
+        return VALUE_UNDEF;
+    }
+}
+
+value_t gc_fixedarray_set(value_t obj, int32_t index, value_t new_value) {
+    pointer_t objp = value_to_ptr(obj);
+    int32_t len = objp->body[0];
+    if (0 <= index && index < len) {
+        gc_write_barrier(objp, new_value);
+        objp->body[index + 1] = new_value;
+        return new_value;
+    }
+    else {
+        runtime_index_error(index, len, "FixedArray.set");
+        return 0;
+    }
+}
+
+/* The given array elements are not stored in a root set.
+   A caller function must guarantee that they are reachable
+   from the root.
+*/
+value_t gc_make_fixedarray(int32_t n, ...) {
+    va_list args;
+    value_t array = gc_new_fixedarray(n, VALUE_UNDEF);
+    va_start(args, n);
+    for (int32_t i = 0; i < n; i++)
+        fast_fixedarray_set(array, i, va_arg(args, value_t));
+    va_end(args);
+    return array;
+}
+
+// Map and Set
+
+/*
+  A hash table for Map<K, V> and Set<K>.  K is integer or string.  V is integer, float, or any.
+  It is implemented by open addressing with linear probing.
+
+  body[0] is the number of elements, body[1] is the number of the slots used in the current table
+  including deleted ones, body[2] is the number of the slots in the old table that have been
+  moved to the current table, and body[3] is HT_STRING_KEYS etc.
+  body[4], body[5], and body[6] are the current table.  They are arrays of the hash codes, the keys,
+  and the values.  The array of the keys (or the values) is a FixedArray if the keys are strings
+  (or the values are of the any type).  Otherwise, it is an int32_t array.  A float value is
+  stored as its bit pattern.  body[6] is not used by a Set.
+  body[7], body[8], and body[9] are the old table.  They are VALUE_UNDEF if there is no old table.
+
+  The hash code of a slot is HT_EMPTY or HT_DELETED if the slot does not hold an element.
+  The hash code of a string key is cached in the table as well as in the string object.
+
+  When the current table is full, it becomes the old table and a new table twice as large
+  becomes the current table.  The elements in the old table are not moved at once.
+  Every insertion or deletion moves a few of them, so that growing a large table never
+  pauses the program for a long time.  Until all of them are moved, a key is searched for
+  in both tables.
+*/
+
+#define HT_SIZE         0
+#define HT_USED         1
+#define HT_MOVED        2
+#define HT_FLAGS        3
+#define HT_TABLE        4
+#define HT_OLD_TABLE    7
+
+#define HT_STRING_KEYS      1
+#define HT_BOXED_VALUES     2
+#define HT_NO_VALUES        4
+
+#define HT_EMPTY            0
+#define HT_DELETED          1
+
+#define HT_MIN_CAPACITY     8
+#define HT_MAX_CAPACITY     (1 << 14)
+#define HT_MOVES_PER_UPDATE 8
+
+static value_t intintmap_set(value_t self, int32_t key, int32_t value);
+static int32_t intintmap_get(value_t self, int32_t key);
+static value_t intfloatmap_set(value_t self, int32_t key, float value);
+static float intfloatmap_get(value_t self, int32_t key);
+static value_t intanymap_set(value_t self, int32_t key, value_t value);
+static value_t intanymap_get(value_t self, int32_t key);
+static value_t stringintmap_set(value_t self, value_t key, int32_t value);
+static int32_t stringintmap_get(value_t self, value_t key);
+static value_t stringfloatmap_set(value_t self, value_t key, float value);
+static float stringfloatmap_get(value_t self, value_t key);
+static value_t stringanymap_set(value_t self, value_t key, value_t value);
+static value_t stringanymap_get(value_t self, value_t key);
+static value_t intset_add(value_t self, int32_t key);
+static value_t stringset_add(value_t self, value_t key);
+static int32_t intkey_has(value_t self, int32_t key);
+static int32_t intkey_delete(value_t self, int32_t key);
+static int32_t stringkey_has(value_t self, value_t key);
+static int32_t stringkey_delete(value_t self, value_t key);
+static void hash_table_clear(value_t self);
+
+// key and value are int or string, and int, float, or any.  They are the prefixes of the method functions.
+// key_sig and value_sig are their encoded types.
+#define MAP_CLASS(cname, type_name, key, key_sig, value, value_sig) \
+CLASS_OBJECT(cname, 5) = { \
+    .body = { .s = 10, .i = 4, .cn = type_name, .sc = &object_class.clazz, .an = NULL, .pt = DEFAULT_PTABLE, \
+              .mt = { .size = 5, \
+                      .names = (const uint16_t[]){ /* set */ 11, /* get */ 18, /* has */ 19, /* delete */ 20, /* clear */ 21 }, \
+                      .signatures = (const char* const[]){ "(" key_sig value_sig ")'" type_name "'", "(" key_sig ")" value_sig, \
+                                                           "(" key_sig ")b", "(" key_sig ")b", "()v" }, \
+                      .sorted = (const uint16_t[]){ 0, 1, 2, 3, 4 } }, \
+              .vtbl = { key##value##map_set, key##value##map_get, key##key_has, key##key_delete, hash_table_clear } }}
+
+#define SET_CLASS(cname, type_name, key, key_sig) \
+CLASS_OBJECT(cname, 4) = { \
+    .body = { .s = 10, .i = 4, .cn = type_name, .sc = &object_class.clazz, .an = NULL, .pt = DEFAULT_PTABLE, \
+              .mt = { .size = 4, \
+                      .names = (const uint16_t[]){ /* add */ 12, /* has */ 19, /* delete */ 20, /* clear */ 21 }, \
+                      .signatures = (const char* const[]){ "(" key_sig ")'" type_name "'", "(" key_sig ")b", "(" key_sig ")b", "()v" }, \
+                      .sorted = (const uint16_t[]){ 0, 1, 2, 3 } }, \
+              .vtbl = { key##set_add, key##key_has, key##key_delete, hash_table_clear } }}
+
+// The class names must match the ones in lang/src/transpiler/types.ts.
+MAP_CLASS(class_IntIntMap, "IntIntMap", int, "i", int, "i");
+MAP_CLASS(class_IntFloatMap, "IntFloatMap", int, "i", float, "f");
+MAP_CLASS(class_IntAnyMap, "IntAnyMap", int, "i", any, "a");
+MAP_CLASS(class_StringIntMap, "StringIntMap", string, "s", int, "i");
+MAP_CLASS(class_StringFloatMap, "StringFloatMap", string, "s", float, "f");
+MAP_CLASS(class_StringAnyMap, "StringAnyMap", string, "s", any, "a");
+SET_CLASS(class_IntSet, "IntSet", int, "i");
+SET_CLASS(class_StringSet, "StringSet", string, "s");
+
+static uint32_t hash_table_flags(const class_object* clazz) {
+    if (clazz == &class_IntIntMap.clazz || clazz == &class_IntFloatMap.clazz)
+        return 0;
+    else if (clazz == &class_IntAnyMap.clazz)
+        return HT_BOXED_VALUES;
+    else if (clazz == &class_StringIntMap.clazz || clazz == &class_StringFloatMap.clazz)
+        return HT_STRING_KEYS;
+    else if (clazz == &class_StringAnyMap.clazz)
+        return HT_STRING_KEYS | HT_BOXED_VALUES;
+    else if (clazz == &class_IntSet.clazz)
+        return HT_NO_VALUES;
+    else
+        return HT_STRING_KEYS | HT_NO_VALUES;
+}
+
+// a hash code of a key.  It is neither HT_EMPTY nor HT_DELETED.
+static uint32_t int_key_hash(int32_t key) {
+    uint32_t h = (uint32_t)key * 0x9e3779b1u;
+    h ^= h >> 16;
+    return h > HT_DELETED ? h : h + 2;
+}
+
+static uint32_t string_key_hash(value_t key) {
+    uint32_t h = gc_string_hash(key);
+    return h > HT_DELETED ? h : h + 2;
+}
+
+// makes a current table with the given capacity.  self must be protected against garbage collection.
+static void hash_table_new_table(value_t self, int32_t capacity) {
+    pointer_t selfp = value_to_ptr(self);
+    uint32_t flags = selfp->body[HT_FLAGS];
+    value_t hashes = gc_new_intarray(capacity, HT_EMPTY);
+    gc_write_barrier(selfp, hashes);
+    selfp->body[HT_TABLE] = hashes;
+    value_t keys = flags & HT_STRING_KEYS ? gc_new_fixedarray(capacity, VALUE_UNDEF) : gc_new_intarray(capacity, 0);
+    gc_write_barrier(selfp, keys);
+    selfp->body[HT_TABLE + 1] = keys;
+    if (!(flags & HT_NO_VALUES)) {
+        value_t values = flags & HT_BOXED_VALUES ? gc_new_fixedarray(capacity, VALUE_UNDEF) : gc_new_intarray(capacity, 0);
+        gc_write_barrier(selfp, values);
+        selfp->body[HT_TABLE + 2] = values;
+    }
+
+    selfp->body[HT_USED] = 0;
+}
+
+// makes an empty Map or Set object.  clazz is one of the classes above.
+value_t gc_new_hash_table(const class_object* clazz) {
     ROOT_SET(rootset, 1)
-    rootset.values[0] = vec;
-    int32_t len = gc_fixedarray_length(vec);
-    if (n < 0)
-        n = 0;
-    else if (n < len + offset)
-        n = len + offset;
+    value_t self = rootset.values[0] = gc_new_object(clazz);
+    pointer_t selfp = value_to_ptr(self);
+    selfp->body[HT_SIZE] = 0;
+    selfp->body[HT_MOVED] = 0;
+    selfp->body[HT_FLAGS] = hash_table_flags(clazz);
+    hash_table_new_table(self, HT_MIN_CAPACITY);
+    DELETE_ROOT_SET(rootset)
+    return self;
+}
 
-    pointer_t obj = allocate_heap(n + 1);
-    set_object_header(obj, &class_FixedArray.clazz);
-    obj->body[0] = n;
-    for (int i = 1; i <= offset; i++)
-        obj->body[i] = VALUE_UNDEF;
+// returns the index of the slot holding the key in the table starting at body[table],
+// or -1 if the key is not found.
+static int32_t hash_table_find(pointer_t selfp, int table, uint32_t hash, value_t key) {
+    value_t hashes = selfp->body[table];
+    if (hashes == VALUE_UNDEF)
+        return -1;
+
+    pointer_t hashesp = value_to_ptr(hashes);
+    pointer_t keysp = value_to_ptr(selfp->body[table + 1]);
+    bool string_keys = selfp->body[HT_FLAGS] & HT_STRING_KEYS;
+    uint32_t mask = hashesp->body[0] - 1;
+    for (uint32_t i = hash & mask; true; i = (i + 1) & mask) {
+        uint32_t h = hashesp->body[i + 1];
+        if (h == HT_EMPTY)
+            return -1;
+        else if (h == hash) {
+            value_t k = keysp->body[i + 1];
+            if (k == key || (string_keys && gc_string_equals(k, key)))
+                return i;
+        }
+    }
+}
+
+// stores an element in the current table.  The key must not be found in the table.
+// The table must have an empty slot.
+static void hash_table_add_slot(pointer_t selfp, uint32_t hash, value_t key, uint32_t value) {
+    uint32_t flags = selfp->body[HT_FLAGS];
+    pointer_t hashesp = value_to_ptr(selfp->body[HT_TABLE]);
+    uint32_t mask = hashesp->body[0] - 1;
+    uint32_t i = hash & mask;
+    while (hashesp->body[i + 1] > HT_DELETED)
+        i = (i + 1) & mask;
+
+    if (hashesp->body[i + 1] == HT_EMPTY)
+        selfp->body[HT_USED]++;
+
+    hashesp->body[i + 1] = hash;
+    pointer_t keysp = value_to_ptr(selfp->body[HT_TABLE + 1]);
+    if (flags & HT_STRING_KEYS)
+        gc_write_barrier(keysp, key);
+
+    keysp->body[i + 1] = key;
+    if (!(flags & HT_NO_VALUES)) {
+        pointer_t valuesp = value_to_ptr(selfp->body[HT_TABLE + 2]);
+        if (flags & HT_BOXED_VALUES)
+            gc_write_barrier(valuesp, value);
+
+        valuesp->body[i + 1] = value;
+    }
+}
+
+// moves at most n slots in the old table to the current table.
+// The moved slots are marked as deleted ones in the old table.
+static void hash_table_move(pointer_t selfp, int32_t n) {
+    value_t old = selfp->body[HT_OLD_TABLE];
+    if (old == VALUE_UNDEF)
+        return;
+
+    pointer_t hashesp = value_to_ptr(old);
+    pointer_t keysp = value_to_ptr(selfp->body[HT_OLD_TABLE + 1]);
+    pointer_t valuesp = selfp->body[HT_FLAGS] & HT_NO_VALUES ? NULL : value_to_ptr(selfp->body[HT_OLD_TABLE + 2]);
+    int32_t capacity = hashesp->body[0];
+    int32_t i = selfp->body[HT_MOVED];
+    for (; i < capacity && n > 0; i++, n--) {
+        uint32_t h = hashesp->body[i + 1];
+        if (h > HT_DELETED) {
+            hash_table_add_slot(selfp, h, keysp->body[i + 1], valuesp == NULL ? 0 : valuesp->body[i + 1]);
+            hashesp->body[i + 1] = HT_DELETED;
+        }
+    }
+
+    if (i < capacity)
+        selfp->body[HT_MOVED] = i;
+    else {
+        selfp->body[HT_MOVED] = 0;
+        for (int j = 0; j < 3; j++)
+            selfp->body[HT_OLD_TABLE + j] = VALUE_UNDEF;
+    }
+}
+
+// makes a new current table.  The current one becomes the old table.
+// self must be protected against garbage collection.
+static void hash_table_grow(value_t self) {
+    pointer_t selfp = value_to_ptr(self);
+    hash_table_move(selfp, HT_MAX_CAPACITY);
+    int32_t capacity = value_to_ptr(selfp->body[HT_TABLE])->body[0];
+    // if most of the used slots are deleted ones, the capacity is not changed.
+    if (selfp->body[HT_SIZE] * 2 >= capacity) {
+        if (capacity >= HT_MAX_CAPACITY)
+            runtime_error("too many elements in a Map or a Set");
+
+        capacity *= 2;
+    }
+
+    for (int j = 0; j < 3; j++) {
+        selfp->body[HT_OLD_TABLE + j] = selfp->body[HT_TABLE + j];
+        selfp->body[HT_TABLE + j] = VALUE_UNDEF;
+    }
+
+    selfp->body[HT_MOVED] = 0;
+    hash_table_new_table(self, capacity);
+}
+
+// returns the index of the table holding the key, HT_TABLE or HT_OLD_TABLE,
+// or -1 if the key is not found.  *index is set to the index of the slot.
+static int hash_table_lookup(pointer_t selfp, uint32_t hash, value_t key, int32_t* index) {
+    if ((*index = hash_table_find(selfp, HT_TABLE, hash, key)) >= 0)
+        return HT_TABLE;
+    else if ((*index = hash_table_find(selfp, HT_OLD_TABLE, hash, key)) >= 0)
+        return HT_OLD_TABLE;
+    else
+        return -1;
+}
+
+static uint32_t hash_table_key_hash(pointer_t selfp, value_t key) {
+    return selfp->body[HT_FLAGS] & HT_STRING_KEYS ? string_key_hash(key) : int_key_hash((int32_t)key);
+}
 
-    pointer_t src = value_to_ptr(vec);
-    memmove(&obj->body[offset + 1], &src->body[1], len * sizeof(value_t));
+// key is an int32_t value or a string.  value is an int32_t value, a float value's bit pattern,
+// or a value_t value.
+static void hash_table_put(value_t self, value_t key, uint32_t value) {
+    pointer_t selfp = value_to_ptr(self);
+    uint32_t flags = selfp->body[HT_FLAGS];
+    ROOT_SET(rootset, 3)
+    rootset.values[0] = self;
+    rootset.values[1] = flags & HT_STRING_KEYS ? key : VALUE_UNDEF;
+    rootset.values[2] = flags & HT_BOXED_VALUES ? value : VALUE_UNDEF;
+    uint32_t hash = hash_table_key_hash(selfp, key);
+    hash_table_move(selfp, HT_MOVES_PER_UPDATE);
+    int32_t i;
+    int table = hash_table_lookup(selfp, hash, key, &i);
+    if (table >= 0) {
+        if (!(flags & HT_NO_VALUES)) {
+            pointer_t valuesp = value_to_ptr(selfp->body[table + 2]);
+            if (flags & HT_BOXED_VALUES)
+                gc_write_barrier(valuesp, value);
+
+            valuesp->body[i + 1] = value;
+        }
+    }
+    else {
+        int32_t capacity = value_to_ptr(selfp->body[HT_TABLE])->body[0];
+        if ((selfp->body[HT_USED] + 1) * 4 > capacity * 3)
+            hash_table_grow(self);
+
+        hash_table_add_slot(selfp, hash, key, value);
+        selfp->body[HT_SIZE]++;
+    }
+
+    DELETE_ROOT_SET(rootset)
+}
+
+// returns true if the key is found.  If value is not NULL, the value for the key is stored in it.
+static bool hash_table_get(value_t self, value_t key, uint32_t* value) {
+    pointer_t selfp = value_to_ptr(self);
+    ROOT_SET(rootset, 2)
+    rootset.values[0] = self;
+    rootset.values[1] = selfp->body[HT_FLAGS] & HT_STRING_KEYS ? key : VALUE_UNDEF;
+    int32_t i;
+    int table = hash_table_lookup(selfp, hash_table_key_hash(selfp, key), key, &i);
+    if (table >= 0 && value != NULL)
+        *value = value_to_ptr(selfp->body[table + 2])->body[i + 1];
+
+    DELETE_ROOT_SET(rootset)
+    return table >= 0;
+}
+
+static bool hash_table_delete(value_t self, value_t key) {
+    pointer_t selfp = value_to_ptr(self);
+    uint32_t flags = selfp->body[HT_FLAGS];
+    ROOT_SET(rootset, 2)
+    rootset.values[0] = self;
+    rootset.values[1] = flags & HT_STRING_KEYS ? key : VALUE_UNDEF;
+    uint32_t hash = hash_table_key_hash(selfp, key);
+    hash_table_move(selfp, HT_MOVES_PER_UPDATE);
+    int32_t i;
+    int table = hash_table_lookup(selfp, hash, key, &i);
+    if (table >= 0) {
+        // the key and the value are cleared so that they can be reclaimed.
+        value_to_ptr(selfp->body[table])->body[i + 1] = HT_DELETED;
+        value_to_ptr(selfp->body[table + 1])->body[i + 1] = flags & HT_STRING_KEYS ? VALUE_UNDEF : 0;
+        if (!(flags & HT_NO_VALUES))
+            value_to_ptr(selfp->body[table + 2])->body[i + 1] = flags & HT_BOXED_VALUES ? VALUE_UNDEF : 0;
+
+        selfp->body[HT_SIZE]--;
+    }
+
+    DELETE_ROOT_SET(rootset)
+    return table >= 0;
+}
+
+static void hash_table_clear(value_t self) {
+    ROOT_SET(rootset, 1)
+    rootset.values[0] = self;
+    pointer_t selfp = value_to_ptr(self);
+    for (int j = 0; j < 3; j++)
+        selfp->body[HT_TABLE + j] = selfp->body[HT_OLD_TABLE + j] = VALUE_UNDEF;
+
+    selfp->body[HT_SIZE] = 0;
+    selfp->body[HT_MOVED] = 0;
+    hash_table_new_table(self, HT_MIN_CAPACITY);
+    DELETE_ROOT_SET(rootset)
+}
+
+static void no_such_key_error() {
+    runtime_error("no such key is found in a Map");
+}
+
+static uint32_t hash_table_get_unboxed(value_t self, value_t key) {
+    uint32_t value = 0;
+    if (!hash_table_get(self, key, &value))
+        no_such_key_error();
+
+    return value;
+}
+
+static value_t hash_table_get_boxed(value_t self, value_t key) {
+    uint32_t value;
+    return hash_table_get(self, key, &value) ? value : VALUE_UNDEF;
+}
+
+static float bits_to_float(uint32_t bits) {
+    float_or_uint v = { .u = bits };
+    return v.f;
+}
+
+static uint32_t float_to_bits(float f) {
+    float_or_uint v = { .f = f };
+    return v.u;
+}
+
+static value_t intintmap_set(value_t self, int32_t key, int32_t value) {
+    hash_table_put(self, (value_t)key, (uint32_t)value);
+    return self;
+}
+
+static int32_t intintmap_get(value_t self, int32_t key) {
+    return (int32_t)hash_table_get_unboxed(self, (value_t)key);
+}
+
+static value_t intfloatmap_set(value_t self, int32_t key, float value) {
+    hash_table_put(self, (value_t)key, float_to_bits(value));
+    return self;
+}
+
+static float intfloatmap_get(value_t self, int32_t key) {
+    return bits_to_float(hash_table_get_unboxed(self, (value_t)key));
+}
+
+static value_t intanymap_set(value_t self, int32_t key, value_t value) {
+    hash_table_put(self, (value_t)key, value);
+    return self;
+}
+
+static value_t intanymap_get(value_t self, int32_t key) {
+    return hash_table_get_boxed(self, (value_t)key);
+}
+
+static value_t stringintmap_set(value_t self, value_t key, int32_t value) {
+    hash_table_put(self, key, (uint32_t)value);
+    return self;
+}
+
+static int32_t stringintmap_get(value_t self, value_t key) {
+    return (int32_t)hash_table_get_unboxed(self, key);
+}
+
+static value_t stringfloatmap_set(value_t self, value_t key, float value) {
+    hash_table_put(self, key, float_to_bits(value));
+    return self;
+}
+
+static float stringfloatmap_get(value_t self, value_t key) {
+    return bits_to_float(hash_table_get_unboxed(self, key));
+}
+
+static value_t stringanymap_set(value_t self, value_t key, value_t value) {
+    hash_table_put(self, key, value);
+    return self;
+}
+
+static value_t stringanymap_get(value_t self, value_t key) {
+    return hash_table_get_boxed(self, key);
+}
 
-    for (int i = len + offset + 1; i <= n; i++)
-        obj->body[i] = VALUE_UNDEF;
+static value_t intset_add(value_t self, int32_t key) {
+    hash_table_put(self, (value_t)key, 0);
+    return self;
+}
 
-    DELETE_ROOT_SET(rootset)
-    return ptr_to_value(obj);
+static value_t stringset_add(value_t self, value_t key) {
+    hash_table_put(self, key, 0);
+    return self;
 }
 
-int32_t gc_fixedarray_length(value_t obj) {
-    pointer_t objp = value_to_ptr(obj);
-    return objp->body[0];
+static int32_t intkey_has(value_t self, int32_t key) {
+    return hash_table_get(self, (value_t)key, NULL);
 }
 
-value_t gc_fixedarray_get(value_t obj, int32_t idx) {
-    pointer_t objp = value_to_ptr(obj);
-    int32_t len = objp->body[0];
-    if (0 <= idx && idx < len)
-        return objp->body[idx + 1];
-    else {
-        runtime_index_error(idx, len, "FixedArray.get");
-        return VALUE_UNDEF;
-    }
+static int32_t intkey_delete(value_t self, int32_t key) {
+    return hash_table_delete(self, (value_t)key);
 }
 
-value_t gc_fixedarray_set(value_t obj, int32_t index, value_t new_value) {
-    pointer_t objp = value_to_ptr(obj);
-    int32_t len = objp->body[0];
-    if (0 <= index && index < len) {
-        gc_write_barrier(objp, new_value);
-        objp->body[index + 1] = new_value;
-        return new_value;
-    }
-    else {
-        runtime_index_error(index, len, "FixedArray.set");
-        return 0;
-    }
+static int32_t stringkey_has(value_t self, value_t key) {
+    return hash_table_get(self, key, NULL);
 }
 
-/* The given array elements are not stored in a root set.
-   A caller function must guarantee that they are reachable
-   from the root.
-*/
-value_t gc_make_fixedarray(int32_t n, ...) {
-    va_list args;
-    value_t array = gc_new_fixedarray(n, VALUE_UNDEF);
-    va_start(args, n);
-    for (int32_t i = 0; i < n; i++)
-        fast_fixedarray_set(array, i, va_arg(args, value_t));
-    va_end(args);
-    return array;
+static int32_t stringkey_delete(value_t self, value_t key) {
+    return hash_table_delete(self, key);
 }
 
 // any-type and other arrays
@@ -1457,12 +3673,16 @@ bool gc_is_instance_of_array(value_t obj) {
     return IS_ARRAY_TYPE(clazz);
 }
 
-static CLASS_OBJECT(anyarray_object, 4) = {
-    .body = { .s = 2, .i = 1, .cn = "any[]", .sc = &object_class.clazz, .an = "[a", .pt = DEFAULT_PTABLE,
-              .mt = { .size = 4,
-                      .names = (const uint16_t[]){ /* push */ 4, /* pop */ 5, /* unshift */ 6, /* shift */ 7, },
-                      .signatures = (const char* const[]){ "(a)i", "()a", "(a)i", "()a" }},
-              .vtbl = { gc_array_push, gc_array_pop, gc_array_unshift, gc_array_shift } }};
+static CLASS_OBJECT(anyarray_object, 8) = {
+    .body = { .s = 3, .i = 2, .cn = "any[]", .sc = &object_class.clazz, .an = "[a", .pt = DEFAULT_PTABLE,
+              .mt = { .size = 8,
+                      .names = (const uint16_t[]){ /* push */ 4, /* pop */ 5, /* unshift */ 6, /* shift */ 7,
+                                                   /* sort */ 22, /* binarySearch */ 23, /* indexOf */ 24, /* reverse */ 25 },
+                      .signatures = (const char* const[]){ "(a)i", "()a", "(a)i", "()a",
+                                                           "((aa)i)[a", "(a(aa)i)i", "(a)i", "()[a" },
+                      .sorted = (const uint16_t[]){ 0, 1, 2, 3, 4, 5, 6, 7 } },
+              .vtbl = { gc_array_push, gc_array_pop, gc_array_unshift, gc_array_shift,
+                        gc_array_sort, gc_array_binary_search, gc_array_index_of, gc_array_reverse } }};
 
 value_t safe_value_to_anyarray(bool nullable, value_t v) {
     if (nullable && v == VALUE_NULL)
@@ -1483,8 +3703,93 @@ value_t safe_anyarray_to_anyarrayobj(value_t v) {
     return v;
 }
 
+/*
+  An array of value_t, such as any[] and string[].
+  body[0] is the number of elements.  body[2] is a fixed array used as a ring buffer.
+  body[1] is the index of the first element in the fixed array, so that
+  the i-th element is stored at (body[1] + i) modulo the capacity of the fixed array.
+  The unused elements of the fixed array are always VALUE_UNDEF.
+
+  The capacity grows by 1.5 times when push() or unshift() fills the fixed array,
+  and it is halved when pop() or shift() makes the array less than a quarter full.
+  So these methods run in amortized constant time.
+*/
+
+#define ARRAY_MIN_SHRINK    32      // the fixed array is not shrunk if its capacity is less than this.
+
 static inline int32_t real_array_length(int32_t n) { return ((n + 1) & ~7) + 7; }
 
+static inline int32_t array_capacity(pointer_t objp) {
+    return value_to_ptr(objp->body[2])->body[0];
+}
+
+// the index in the fixed array of the idx-th element.  0 <= idx < the capacity.
+static inline int32_t array_slot_index(pointer_t objp, int32_t idx) {
+    int32_t i = objp->body[1] + idx;
+    int32_t capacity = array_capacity(objp);
+    return i < capacity ? i : i - capacity;
+}
+
+static inline value_t* array_slot(pointer_t objp, int32_t idx) {
+    return fast_fixedarray_get(objp->body[2], array_slot_index(objp, idx));
+}
+
+// the number of the elements stored before the end of the fixed array.
+static inline int32_t array_first_segment(pointer_t objp) {
+    int32_t rest = array_capacity(objp) - objp->body[1];
+    return objp->body[0] < rest ? objp->body[0] : rest;
+}
+
+// moves the elements into a new fixed array with the given capacity.
+// The first element is moved to the beginning of the new fixed array.
+static void resize_array(value_t obj, int32_t capacity) {
+    ROOT_SET(rootset, 1)
+    rootset.values[0] = obj;
+    value_t vec = gc_new_fixedarray(capacity, VALUE_UNDEF);
+    pointer_t objp = value_to_ptr(obj);
+    pointer_t vecp = value_to_ptr(vec);
+    pointer_t old_vecp = value_to_ptr(objp->body[2]);
+    int32_t n = objp->body[0];
+    int32_t first = array_first_segment(objp);
+    memcpy(&vecp->body[1], &old_vecp->body[objp->body[1] + 1], first * sizeof(value_t));
+    memcpy(&vecp->body[first + 1], &old_vecp->body[1], (n - first) * sizeof(value_t));
+    gc_write_barrier(objp, vec);
+    objp->body[2] = vec;
+    objp->body[1] = 0;
+    DELETE_ROOT_SET(rootset)
+}
+
+// makes room for one more element.
+static void grow_array(value_t obj) {
+    pointer_t objp = value_to_ptr(obj);
+    int32_t capacity = array_capacity(objp);
+    if (objp->body[0] >= capacity) {
+        int32_t new_capacity = real_array_length(capacity + (capacity >> 1));
+        resize_array(obj, new_capacity);
+    }
+}
+
+// halves the capacity if the array is less than a quarter full.
+// value is protected against garbage collection.
+static void shrink_array(value_t obj, value_t value) {
+    pointer_t objp = value_to_ptr(obj);
+    int32_t capacity = array_capacity(objp);
+    if (capacity >= ARRAY_MIN_SHRINK && objp->body[0] < capacity / 4) {
+        ROOT_SET(rootset, 1)
+        rootset.values[0] = value;
+        resize_array(obj, real_array_length(capacity / 2));
+        DELETE_ROOT_SET(rootset)
+    }
+}
+
+// converts the elements of an array of value_t into floats.
+static void array_to_floats(float* dest, value_t src) {
+    pointer_t srcp = value_to_ptr(src);
+    int32_t first = array_first_segment(srcp);
+    values_to_floats(dest, array_slot(srcp, 0), first);
+    values_to_floats(dest + first, fast_fixedarray_get(srcp->body[2], 0), srcp->body[0] - first);
+}
+
 value_t gc_new_array(const class_object* clazz, int32_t n, value_t init_value) {
     ROOT_SET(rootset, 2)
     rootset.values[0] = init_value;
@@ -1500,8 +3805,9 @@ value_t gc_new_array(const class_object* clazz, int32_t n, value_t init_value) {
         for (int i = n + 1; i <= size; i++)
             arrp->body[i] = VALUE_UNDEF;
 
-    obj->body[1] = arr;
-    // the length must be less than or equal to the length of the .
+    obj->body[2] = arr;
+    obj->body[1] = 0;
+    // the length must be less than or equal to the length of the fixed array.
     obj->body[0] = n;
     DELETE_ROOT_SET(rootset)
     return ptr_to_value(obj);
@@ -1509,6 +3815,16 @@ value_t gc_new_array(const class_object* clazz, int32_t n, value_t init_value) {
 
 static bool is_subtype_of(value_t obj, const char** sig);
 
+// copies the elements of src into dest.  They are arrays of the same class.
+// dest is a new array whose elements start at the beginning of its fixed array.
+// gc_write_barrier() is not needed since the elements are also reachable from src.
+static void copy_array_elements(pointer_t destp, pointer_t srcp) {
+    value_t* elements = fast_fixedarray_get(destp->body[2], 0);
+    int32_t first = array_first_segment(srcp);
+    memcpy(elements, array_slot(srcp, 0), first * sizeof(value_t));
+    memcpy(elements + first, fast_fixedarray_get(srcp->body[2], 0), (srcp->body[0] - first) * sizeof(value_t));
+}
+
 value_t gc_copy_array(const class_object* clazz, value_t src) {
     if (is_int_value(src)) {
         if (clazz == NULL)
@@ -1525,7 +3841,18 @@ value_t gc_copy_array(const class_object* clazz, value_t src) {
         rootset.values[0] = src;
         int32_t n = get_all_array_length(src);
         value_t dest = gc_new_array(clazz, n, VALUE_UNDEF);
-        if (clazz == NULL)
+        if (src_class == (clazz == NULL ? &anyarray_object.clazz : clazz))
+            copy_array_elements(value_to_ptr(dest), value_to_ptr(src));
+        else if (clazz == NULL && gc_is_instance_of(&intarray_object.clazz, src)) {
+            value_t* elements = fast_fixedarray_get(value_to_ptr(dest)->body[2], 0);
+            const int32_t* src_elements = intarray_elements(src);
+            for (int32_t i = 0; i < n; i++)
+                elements[i] = int_to_value(src_elements[i]);
+        }
+        else if (clazz == NULL && gc_is_instance_of(&floatarray_object.clazz, src))
+            floats_to_values(fast_fixedarray_get(value_to_ptr(dest)->body[2], 0),
+                             floatarray_elements(src), n);
+        else if (clazz == NULL)
             for (int32_t i = 0; i < n; i++)
                 gc_array_set(dest, i, gc_safe_array_get(src, i));
         else
@@ -1543,37 +3870,6 @@ value_t gc_copy_array(const class_object* clazz, value_t src) {
     }
 }
 
-static value_t gc_grow_array(value_t obj, int32_t addedElements, int32_t offset) {
-    ROOT_SET(rootset, 1)
-    rootset.values[0] = obj;
-    pointer_t objp = value_to_ptr(obj);
-    int32_t n = objp->body[0];
-    int32_t new_n = n + addedElements;
-    value_t vec = objp->body[1];
-    pointer_t vecp = value_to_ptr(vec);
-    int32_t size = vecp->body[0];
-    if (new_n > size) {
-        int32_t new_size = real_array_length(new_n);
-        value_t new_vec = duplicate_fixedarray(new_size, offset, vec);
-        objp->body[1] = new_vec;
-    }
-    else
-        if (offset > 0) {
-            memmove(&vecp->body[offset + 1], &vecp->body[1], n * sizeof(value_t));
-            for (int i = 1; i <= offset; i++)
-                vecp->body[i] = VALUE_UNDEF;
-        }
-        else if (offset < 0) {
-            memmove(&vecp->body[1], &vecp->body[1 - offset], (n + offset) * sizeof(value_t));
-            for (int i = n + offset + 1; i <= n; i++)
-                vecp->body[i] = VALUE_UNDEF;
-        }
-
-    objp->body[0] = new_n;
-    DELETE_ROOT_SET(rootset)
-    return obj;
-}
-
 /* The given array elements are not stored in a root set.
    A caller function must guarantee that they are reachable
    from the root.
@@ -1585,7 +3881,7 @@ value_t gc_make_array(const class_object* clazz, int32_t n, ...) {
     va_start(args, n);
 
     for (int32_t i = 0; i < n; i++)
-        fast_fixedarray_set(arrayp->body[1], i, va_arg(args, value_t));
+        fast_fixedarray_set(arrayp->body[2], i, va_arg(args, value_t));
 
     va_end(args);
     return array;
@@ -1600,7 +3896,7 @@ value_t* gc_array_get(value_t obj, int32_t idx) {
     pointer_t objp = value_to_ptr(obj);
     int32_t len = objp->body[0];
     if (0 <= idx && idx < len)
-        return fast_fixedarray_get(objp->body[1], idx);
+        return array_slot(objp, idx);
     else {
         runtime_index_error(idx, len, "Array.get");
         return 0;
@@ -1611,7 +3907,7 @@ value_t gc_array_set(value_t obj, int32_t index, value_t new_value) {
     pointer_t objp = value_to_ptr(obj);
     int32_t len = objp->body[0];
     if (0 <= index && index < len) {
-        fast_fixedarray_set(objp->body[1], index, new_value);
+        fast_fixedarray_set(objp->body[2], array_slot_index(objp, index), new_value);
         return new_value;
     } else {
         runtime_index_error(index, len, "Array.set");
@@ -1623,12 +3919,13 @@ int32_t gc_array_push(value_t obj, value_t new_value) {
     ROOT_SET(rootset, 2)
     rootset.values[0] = obj;
     rootset.values[1] = new_value;
-    gc_grow_array(obj, 1, 0);
+    grow_array(obj);
     pointer_t objp = value_to_ptr(obj);
     int32_t len = objp->body[0];
-    fast_fixedarray_set(objp->body[1], len - 1, new_value);
+    fast_fixedarray_set(objp->body[2], array_slot_index(objp, len), new_value);
+    objp->body[0] = len + 1;
     DELETE_ROOT_SET(rootset)
-    return len;
+    return len + 1;
 }
 
 value_t gc_array_pop(value_t obj) {
@@ -1637,9 +3934,11 @@ value_t gc_array_pop(value_t obj) {
     if (len == 0)
         return VALUE_UNDEF;
 
-    value_t value = gc_fixedarray_get(objp->body[1], len - 1);
-    gc_fixedarray_set(objp->body[1], len - 1, VALUE_UNDEF);
+    value_t* slot = array_slot(objp, len - 1);
+    value_t value = *slot;
+    *slot = VALUE_UNDEF;
     objp->body[0] = len - 1;
+    shrink_array(obj, value);
     return value;
 }
 
@@ -1647,9 +3946,12 @@ int32_t gc_array_unshift(value_t obj, value_t new_value) {
     ROOT_SET(rootset, 2)
     rootset.values[0] = obj;
     rootset.values[1] = new_value;
-    gc_grow_array(obj, 1, 1);
+    grow_array(obj);
     pointer_t objp = value_to_ptr(obj);
-    fast_fixedarray_set(objp->body[1], 0, new_value);
+    int32_t head = objp->body[1] == 0 ? array_capacity(objp) - 1 : objp->body[1] - 1;
+    fast_fixedarray_set(objp->body[2], head, new_value);
+    objp->body[1] = head;
+    objp->body[0] += 1;
     DELETE_ROOT_SET(rootset)
     return objp->body[0];
 }
@@ -1660,15 +3962,416 @@ value_t gc_array_shift(value_t obj) {
     if (len == 0)
         return VALUE_UNDEF;
 
-    value_t value = gc_fixedarray_get(objp->body[1], 0);
-    gc_grow_array(obj, -1, -1);
+    value_t* slot = array_slot(objp, 0);
+    value_t value = *slot;
+    *slot = VALUE_UNDEF;
+    objp->body[1] = array_slot_index(objp, 1);
+    objp->body[0] = len - 1;
+    shrink_array(obj, value);
     return value;
 }
 
+/*
+  sort(), binarySearch(), indexOf(), and reverse() on an array of value_t.
+  sort() and binarySearch() take a comparator, a function object of type (a: T, b: T) => integer,
+  and call its function directly.  sort() is a stable merge sort.
+  Since the comparator may allocate objects and run the garbage collector,
+  every element being sorted is kept reachable from the fixed array of the array object
+  or from a temporary fixed array, which are in a root set.
+*/
+
+typedef int32_t (*array_comparator)(value_t, value_t, value_t);
+
+static inline int32_t array_compare(value_t compare, value_t a, value_t b) {
+    return ((array_comparator)gc_function_object_ptr(compare, 0))(compare, a, b);
+}
+
+static void values_reverse(value_t* a, int32_t n) {
+    for (int32_t i = 0, j = n - 1; i < j; i++, j--) {
+        value_t t = a[i];
+        a[i] = a[j];
+        a[j] = t;
+    }
+}
+
+// rotates the fixed array so that the first element is at the beginning of the fixed array.
+// It returns the address of the first element.
+static value_t* array_linear_elements(pointer_t objp) {
+    int32_t first = objp->body[1];
+    value_t* elements = fast_fixedarray_get(objp->body[2], 0);
+    if (first > 0) {
+        int32_t capacity = array_capacity(objp);
+        values_reverse(elements, first);
+        values_reverse(elements + first, capacity - first);
+        values_reverse(elements, capacity);
+        objp->body[1] = 0;
+    }
+
+    return elements;
+}
+
+// *held is an element in a root set.  It keeps the element removed from a[] during comparison.
+static void array_insertion_sort(value_t* a, int32_t n, value_t compare, value_t* held) {
+    for (int32_t i = 1; i < n; i++) {
+        value_t v = *held = a[i];
+        int32_t j = i;
+        for (; j > 0 && array_compare(compare, v, a[j - 1]) < 0; j--)
+            a[j] = a[j - 1];
+
+        a[j] = v;
+    }
+
+    *held = VALUE_UNDEF;
+}
+
+// tmp[] is a temporary array whose length is at least n / 2.
+static void array_merge_sort(value_t* a, value_t* tmp, int32_t n, value_t compare, value_t* held) {
+    if (n <= SORT_THRESHOLD) {
+        array_insertion_sort(a, n, compare, held);
+        return;
+    }
+
+    int32_t half = n / 2;
+    array_merge_sort(a, tmp, half, compare, held);
+    array_merge_sort(a + half, tmp, n - half, compare, held);
+    if (array_compare(compare, a[half - 1], a[half]) <= 0)
+        return;     // already sorted
+
+    memcpy(tmp, a, half * sizeof(value_t));
+    int32_t i = 0, j = half, k = 0;
+    while (i < half && j < n)
+        if (array_compare(compare, a[j], tmp[i]) < 0)
+            a[k++] = a[j++];
+        else
+            a[k++] = tmp[i++];
+
+    while (i < half)
+        a[k++] = tmp[i++];
+}
+
+value_t gc_array_sort(value_t obj, value_t compare) {
+    ROOT_SET(rootset, 5)
+    rootset.values[0] = obj;
+    rootset.values[1] = compare;
+    pointer_t objp = value_to_ptr(obj);
+    int32_t n = objp->body[0];
+    value_t* elements = array_linear_elements(objp);
+    // the comparator may replace the fixed array by push() etc.  So the fixed array is also kept.
+    rootset.values[2] = objp->body[2];
+    value_t* tmp = NULL;
+    if (n > SORT_THRESHOLD) {
+        rootset.values[3] = gc_new_fixedarray(n / 2, VALUE_UNDEF);
+        tmp = fast_fixedarray_get(rootset.values[3], 0);
+    }
+
+    array_merge_sort(elements, tmp, n, compare, &rootset.values[4]);
+    DELETE_ROOT_SET(rootset)
+    return obj;
+}
+
+// the array must be sorted in the order given by the comparator.
+int32_t gc_array_binary_search(value_t obj, value_t v, value_t compare) {
+    ROOT_SET(rootset, 3)
+    rootset.values[0] = obj;
+    rootset.values[1] = v;
+    rootset.values[2] = compare;
+    int32_t n = value_to_ptr(obj)->body[0];
+    int32_t low = 0, high = n;
+    while (low < high) {
+        int32_t mid = low + (high - low) / 2;
+        if (array_compare(compare, *gc_array_get(obj, mid), v) < 0)
+            low = mid + 1;
+        else
+            high = mid;
+    }
+
+    // gc_array_get() checks the index since the comparator may shrink the array.
+    if (!(low < n && array_compare(compare, *gc_array_get(obj, low), v) == 0))
+        low = -(low + 1);
+
+    DELETE_ROOT_SET(rootset)
+    return low;
+}
+
+// strings are compared by their contents.  Other values are compared by identity.
+int32_t gc_array_index_of(value_t obj, value_t v) {
+    pointer_t objp = value_to_ptr(obj);
+    if (!gc_is_string_object(v)) {
+        for (int32_t i = 0; i < objp->body[0]; i++)
+            if (*array_slot(objp, i) == v)
+                return i;
+
+        return -1;
+    }
+
+    int32_t found = -1;
+    ROOT_SET(rootset, 2)
+    rootset.values[0] = obj;
+    rootset.values[1] = v;
+    for (int32_t i = 0; i < objp->body[0]; i++)
+        if (any_eq(*array_slot(objp, i), v)) {
+            found = i;
+            break;
+        }
+
+    DELETE_ROOT_SET(rootset)
+    return found;
+}
+
+value_t gc_array_reverse(value_t obj) {
+    pointer_t objp = value_to_ptr(obj);
+    for (int32_t i = 0, j = objp->body[0] - 1; i < j; i++, j--) {
+        value_t* a = array_slot(objp, i);
+        value_t* b = array_slot(objp, j);
+        value_t t = *a;
+        *a = *b;
+        *b = t;
+    }
+
+    return obj;
+}
+
+// Growable arrays of integer, float, and byte
+
+/*
+  A growable typed array.  It is an integer[], float[], or Uint8Array object
+  accepting push() and pop().  Its class is a subclass of the class of
+  the fixed-length array so that it is accepted where the fixed one is expected.
+
+  1st and 2nd words are the number of elements.  They hold the same value
+  since the length is at body[0] in integer[] and float[] but at body[1] in Uint8Array.
+  3rd word is a fixed-length typed array holding the elements without boxing.
+  Its length is the capacity of the growable array.
+*/
+
+#define GROWABLE_MIN_CAPACITY   4
+
+static void set_growable_length(pointer_t objp, int32_t n) {
+    objp->body[0] = n;
+    objp->body[1] = n;
+}
+
+// the capacity of a growable array.  elem_size is the size of an element in bytes.
+static int32_t growable_capacity(pointer_t objp, int32_t elem_size) {
+    pointer_t storage = value_to_ptr(objp->body[2]);
+    return elem_size == 1 ? storage->body[1] : storage->body[0];
+}
+
+// replaces the fixed-length array holding the elements with a new one.
+static void resize_growable_array(value_t obj, int32_t capacity, int32_t elem_size) {
+    ROOT_SET(rootset, 1)
+    rootset.values[0] = obj;
+    pointer_t storage;
+    if (elem_size == 1)
+        storage = gc_new_bytearray_base(capacity, &class_Uint8Array.clazz);
+    else {
+        // an integer[] or float[] object
+        storage = gc_new_intarray_base(capacity);
+        set_object_header(storage, get_objects_class(value_to_ptr(value_to_ptr(obj)->body[2])));
+    }
+
+    pointer_t objp = value_to_ptr(obj);
+    int32_t first = elem_size == 1 ? 2 : 1;     // the index of the first element
+    memcpy(&storage->body[first], &value_to_ptr(objp->body[2])->body[first], objp->body[0] * elem_size);
+    value_t new_storage = ptr_to_value(storage);
+    gc_write_barrier(objp, new_storage);
+    objp->body[2] = new_storage;
+    DELETE_ROOT_SET(rootset)
+}
+
+// makes room for one more element.
+static void grow_growable_array(value_t obj, int32_t elem_size) {
+    pointer_t objp = value_to_ptr(obj);
+    int32_t capacity = growable_capacity(objp, elem_size);
+    if (objp->body[0] >= capacity) {
+        int32_t new_capacity = capacity < GROWABLE_MIN_CAPACITY ? GROWABLE_MIN_CAPACITY : capacity + (capacity >> 1);
+        resize_growable_array(obj, new_capacity, elem_size);
+    }
+}
+
+// halves the capacity if the array is less than a quarter full.
+static void shrink_growable_array(value_t obj, int32_t elem_size) {
+    pointer_t objp = value_to_ptr(obj);
+    int32_t capacity = growable_capacity(objp, elem_size);
+    if (capacity >= ARRAY_MIN_SHRINK && objp->body[0] < capacity / 4)
+        resize_growable_array(obj, capacity / 2, elem_size);
+}
+
+static int32_t growable_intarray_push(value_t self, int32_t v) {
+    grow_growable_array(self, sizeof(int32_t));
+    pointer_t objp = value_to_ptr(self);
+    int32_t len = objp->body[0];
+    value_to_ptr(objp->body[2])->body[len + 1] = v;
+    set_growable_length(objp, len + 1);
+    return len + 1;
+}
+
+static int32_t growable_intarray_pop(value_t self) {
+    pointer_t objp = value_to_ptr(self);
+    int32_t len = objp->body[0];
+    bulk_empty_check(len, "Array<integer>.pop");
+    int32_t v = value_to_ptr(objp->body[2])->body[len];
+    set_growable_length(objp, len - 1);
+    shrink_growable_array(self, sizeof(int32_t));
+    return v;
+}
+
+static int32_t growable_floatarray_push(value_t self, float v) {
+    grow_growable_array(self, sizeof(float));
+    pointer_t objp = value_to_ptr(self);
+    int32_t len = objp->body[0];
+    *(float*)&value_to_ptr(objp->body[2])->body[len + 1] = v;
+    set_growable_length(objp, len + 1);
+    return len + 1;
+}
+
+static float growable_floatarray_pop(value_t self) {
+    pointer_t objp = value_to_ptr(self);
+    int32_t len = objp->body[0];
+    bulk_empty_check(len, "Array<float>.pop");
+    float v = *(float*)&value_to_ptr(objp->body[2])->body[len];
+    set_growable_length(objp, len - 1);
+    shrink_growable_array(self, sizeof(float));
+    return v;
+}
+
+static int32_t growable_bytearray_push(value_t self, int32_t v) {
+    grow_growable_array(self, 1);
+    pointer_t objp = value_to_ptr(self);
+    int32_t len = objp->body[0];
+    ((uint8_t*)&value_to_ptr(objp->body[2])->body[2])[len] = (uint8_t)v;
+    set_growable_length(objp, len + 1);
+    return len + 1;
+}
+
+static int32_t growable_bytearray_pop(value_t self) {
+    pointer_t objp = value_to_ptr(self);
+    int32_t len = objp->body[0];
+    bulk_empty_check(len, "Uint8Array.pop");
+    int32_t v = ((uint8_t*)&value_to_ptr(objp->body[2])->body[2])[len - 1];
+    set_growable_length(objp, len - 1);
+    shrink_growable_array(self, 1);
+    return v;
+}
+
+static CLASS_OBJECT(growable_intarray_object, 14) = {
+    .body = { .s = 3, .i = 2, .cn = "integer[]", .sc = &intarray_object.clazz, .an = "[i", .pt = DEFAULT_PTABLE,
+              .mt = BULK_METHOD_TABLE("(i)[i", "([ii)v", "([i)v", "(i)v", "([i)i", "()i", "()i", "()i", "(i)i", "()i",
+                                      "()[i", "(i)i", "(i)i", "()[i"),
+              .vtbl = { intarray_fill, intarray_set, intarray_add, intarray_scale,
+                        intarray_dot, intarray_sum, intarray_min, intarray_max,
+                        growable_intarray_push, growable_intarray_pop,
+                        intarray_sort, intarray_binary_search, intarray_index_of, intarray_reverse } }};
+
+static CLASS_OBJECT(growable_floatarray_object, 14) = {
+    .body = { .s = 3, .i = 2, .cn = "float[]", .sc = &floatarray_object.clazz, .an = "[f", .pt = DEFAULT_PTABLE,
+              .mt = BULK_METHOD_TABLE("(f)[f", "([fi)v", "([f)v", "(f)v", "([f)f", "()f", "()f", "()f", "(f)i", "()f",
+                                      "()[f", "(f)i", "(f)i", "()[f"),
+              .vtbl = { floatarray_fill, floatarray_set, floatarray_add, floatarray_scale,
+                        floatarray_dot, floatarray_sum, floatarray_min, floatarray_max,
+                        growable_floatarray_push, growable_floatarray_pop,
+                        floatarray_sort, floatarray_binary_search, floatarray_index_of, floatarray_reverse } }};
+
+static CLASS_OBJECT(growable_bytearray_object, 14) = {
+    .body = { .s = 3, .i = 2, .cn = "Uint8Array", .sc = &class_Uint8Array.clazz, .an = "'Uint8Array'", .pt = DEFAULT_PTABLE,
+              .mt = BULK_METHOD_TABLE("(i)'Uint8Array'", "('Uint8Array'i)v", "('Uint8Array')v", "(i)v",
+                                      "('Uint8Array')i", "()i", "()i", "()i", "(i)i", "()i",
+                                      "()'Uint8Array'", "(i)i", "(i)i", "()'Uint8Array'"),
+              .vtbl = { bytearray_fill, bytearray_set, bytearray_add, bytearray_scale,
+                        bytearray_dot, bytearray_sum, bytearray_min, bytearray_max,
+                        growable_bytearray_push, growable_bytearray_pop,
+                        bytearray_sort, bytearray_binary_search, bytearray_index_of, bytearray_reverse } }};
+
+static bool is_growable_array(pointer_t objp) {
+    class_object* clazz = get_objects_class(objp);
+    return clazz == &growable_intarray_object.clazz || clazz == &growable_floatarray_object.clazz
+           || clazz == &growable_bytearray_object.clazz;
+}
+
+static int32_t* intarray_elements(value_t obj) {
+    pointer_t objp = value_to_ptr(obj);
+    if (get_objects_class(objp) == &growable_intarray_object.clazz)
+        objp = value_to_ptr(objp->body[2]);
+
+    return (int32_t*)&objp->body[1];
+}
+
+static float* floatarray_elements(value_t obj) {
+    pointer_t objp = value_to_ptr(obj);
+    if (get_objects_class(objp) == &growable_floatarray_object.clazz)
+        objp = value_to_ptr(objp->body[2]);
+
+    return (float*)&objp->body[1];
+}
+
+static uint8_t* bytearray_elements(value_t obj) {
+    pointer_t objp = value_to_ptr(obj);
+    if (get_objects_class(objp) == &growable_bytearray_object.clazz)
+        objp = value_to_ptr(objp->body[2]);
+
+    return (uint8_t*)&objp->body[2];
+}
+
+/*
+  makes a growable array from an integer[], float[], or Uint8Array object.
+  The given array holds the elements of the growable array.  It must not be
+  accessed later except through the growable array.
+*/
+value_t gc_new_growable_array(value_t array) {
+    class_object* clazz = gc_get_class_of(array);
+    const class_object* growable;
+    if (clazz == &intarray_object.clazz)
+        growable = &growable_intarray_object.clazz;
+    else if (clazz == &floatarray_object.clazz)
+        growable = &growable_floatarray_object.clazz;
+    else if (clazz == &class_Uint8Array.clazz)
+        growable = &growable_bytearray_object.clazz;
+    else
+        return runtime_type_error("gc_new_growable_array");
+
+    ROOT_SET(rootset, 1)
+    rootset.values[0] = array;
+    pointer_t obj = gc_allocate_object(growable);
+    set_growable_length(obj, clazz == &class_Uint8Array.clazz ? value_to_ptr(array)->body[1]
+                                                               : value_to_ptr(array)->body[0]);
+    obj->body[2] = array;
+    DELETE_ROOT_SET(rootset)
+    return ptr_to_value(obj);
+}
+
+// the address of the first element of a fixed-length or growable array.
+// The address of a growable array changes when the array grows or shrinks.
+int32_t* gc_intarray_base(value_t obj) { return intarray_elements(obj); }
+
+float* gc_floatarray_base(value_t obj) { return floatarray_elements(obj); }
+
+uint8_t* gc_bytearray_base(value_t obj) { return bytearray_elements(obj); }
+
+// the length of a typed array.  It returns zero if obj is null or a growable array.
+// The code generator uses it instead of gc_length_or_zero() when the length of
+// an array may change, for example, when a loop calls a function.
+int32_t gc_fixed_length_or_zero(value_t obj, int index) {
+    if (obj == VALUE_NULL || is_growable_array(value_to_ptr(obj)))
+        return 0;
+    else
+        return value_to_ptr(obj)->body[index];
+}
+
+// the length of a typed array.  It returns zero if obj is null, a growable array,
+// or a read-only array.  The code generator uses it when a loop assigns values to
+// the array elements.  Then an assignment to a read-only array is checked by
+// gc_intarray_lval() etc. and throws an error.
+int32_t gc_writable_length_or_zero(value_t obj, int index) {
+    if (obj == VALUE_NULL || !gc_is_heap_object(value_to_ptr(obj)) || is_growable_array(value_to_ptr(obj)))
+        return 0;
+    else
+        return value_to_ptr(obj)->body[index];
+}
+
 int32_t get_all_array_length(value_t obj) {
     class_object* clazz = gc_get_class_of(obj);
     if (IS_ARRAY_TYPE(clazz))
-        if (clazz == &class_Uint8Array.clazz || clazz == &boolarray_object.clazz)
+        if (clazz == &class_Uint8Array.clazz || clazz == &boolarray_object.clazz || is_compact_array_class(clazz))
             return value_to_ptr(obj)->body[1];
         else
             return value_to_ptr(obj)->body[0];
@@ -1689,14 +4392,24 @@ value_t get_anyobj_length_property(value_t obj, int property) {
 
 value_t gc_safe_array_get(value_t obj, int32_t idx) {
     class_object* clazz = gc_get_class_of(obj);
-    if (clazz == &intarray_object.clazz)
+    if (clazz == &intarray_object.clazz || clazz == &growable_intarray_object.clazz
+        || clazz == &readonly_intarray.clazz)
         return int_to_value(*gc_intarray_get(obj, idx));
-    else if (clazz == &floatarray_object.clazz)
+    else if (clazz == &floatarray_object.clazz || clazz == &growable_floatarray_object.clazz
+             || clazz == &readonly_floatarray.clazz)
         return float_to_value(*gc_floatarray_get(obj, idx));
-    else if (clazz == &class_Uint8Array.clazz)
+    else if (clazz == &class_Uint8Array.clazz || clazz == &growable_bytearray_object.clazz)
         return int_to_value(*gc_bytearray_get(obj, idx));
     else if (clazz == &boolarray_object.clazz)
         return bool_to_value(*gc_bytearray_get(obj, idx));
+    else if (clazz == &class_Int8Array.clazz)
+        return int_to_value(*gc_int8array_get(obj, idx));
+    else if (clazz == &class_Int16Array.clazz)
+        return int_to_value(*gc_int16array_get(obj, idx));
+    else if (clazz == &class_Uint16Array.clazz)
+        return int_to_value(*gc_uint16array_get(obj, idx));
+    else if (clazz == &class_Uint32Array.clazz)
+        return int_to_value(*gc_uint32array_get(obj, idx));
     else if (clazz == &class_FixedArray.clazz)
         return gc_fixedarray_get(obj, idx);
     else if (IS_ARRAY_TYPE(clazz))   // for arrays of value_t
@@ -1709,16 +4422,26 @@ value_t gc_safe_array_get(value_t obj, int32_t idx) {
 
 value_t gc_safe_array_set(value_t obj, int32_t idx, value_t new_value) {
     class_object* clazz = gc_get_class_of(obj);
-    if (clazz == &intarray_object.clazz)
-        return int_to_value(*gc_intarray_get(obj, idx) = safe_value_to_int(new_value));
-    else if (clazz == &floatarray_object.clazz)
-        return float_to_value(*gc_floatarray_get(obj, idx) = safe_value_to_float(new_value));
-    else if (clazz == &class_Uint8Array.clazz)
+    if (clazz == &intarray_object.clazz || clazz == &growable_intarray_object.clazz
+        || clazz == &readonly_intarray.clazz)
+        return int_to_value(*gc_intarray_lval(obj, idx) = safe_value_to_int(new_value));
+    else if (clazz == &floatarray_object.clazz || clazz == &growable_floatarray_object.clazz
+             || clazz == &readonly_floatarray.clazz)
+        return float_to_value(*gc_floatarray_lval(obj, idx) = safe_value_to_float(new_value));
+    else if (clazz == &class_Uint8Array.clazz || clazz == &growable_bytearray_object.clazz)
         return int_to_value(*gc_bytearray_get(obj, idx) = safe_value_to_int(new_value));
     else if (clazz == &boolarray_object.clazz) {
         uint8_t v = *gc_bytearray_get(obj, idx) = safe_value_to_bool(new_value);
         return bool_to_value(v);
     }
+    else if (clazz == &class_Int8Array.clazz)
+        return int_to_value(*gc_int8array_get(obj, idx) = safe_value_to_int(new_value));
+    else if (clazz == &class_Int16Array.clazz)
+        return int_to_value(*gc_int16array_get(obj, idx) = safe_value_to_int(new_value));
+    else if (clazz == &class_Uint16Array.clazz)
+        return int_to_value(*gc_uint16array_get(obj, idx) = safe_value_to_int(new_value));
+    else if (clazz == &class_Uint32Array.clazz)
+        return int_to_value(*gc_uint32array_get(obj, idx) = safe_value_to_int(new_value));
     else if (clazz == &class_FixedArray.clazz)
         return gc_fixedarray_set(obj, idx, new_value);
     else if (IS_ARRAY_TYPE(clazz))  // for arrays of value_t
@@ -1872,6 +4595,35 @@ static bool is_subtype_of(value_t obj, const char** sig) {
     return false;
 }
 
+// finds a method by its name.  It returns the index of the method
+// in the virtual function table, or -1 if not found.
+static int32_t find_method(const struct method_table* mtable, uint32_t name) {
+    const uint16_t* names = mtable->names;
+    const uint16_t* sorted = mtable->sorted;
+    if (sorted == NULL) {
+        for (int32_t i = 0; i < mtable->size; i++)
+            if (names[i] == name)
+                return i;
+
+        return -1;
+    }
+
+    int32_t low = 0;
+    int32_t high = mtable->size - 1;
+    while (low <= high) {
+        int32_t mid = (low + high) / 2;
+        int32_t i = sorted[mid];
+        if (names[i] == name)
+            return i;
+        else if (names[i] < name)
+            low = mid + 1;
+        else
+            high = mid - 1;
+    }
+
+    return -1;
+}
+
 value_t gc_dynamic_method_call(value_t obj, uint32_t index, uint32_t num, ...) {
     value_t args[12];
     if (num > sizeof(args) / sizeof(args[0]))
@@ -1887,13 +4639,13 @@ value_t gc_dynamic_method_call(value_t obj, uint32_t index, uint32_t num, ...) {
         fptr = gc_function_object_ptr(obj, 0);
         sig = gc_function_object_ptr(obj, 1);
     }
-    else
-        for (int32_t i = 0; i < clazz->mtable.size; i++)
-            if (clazz->mtable.names[i] == index) {
-                fptr = clazz->vtbl[i];
-                sig = clazz->mtable.signatures[i];
-                break;
-            }
+    else {
+        int32_t i = find_method(&clazz->mtable, index);
+        if (i >= 0) {
+            fptr = clazz->vtbl[i];
+            sig = clazz->mtable.signatures[i];
+        }
+    }
 
     if (fptr == NULL)
         runtime_error("no such method is found");
@@ -1944,6 +4696,11 @@ value_t gc_dynamic_method_call(value_t obj, uint32_t index, uint32_t num, ...) {
                         (obj, args[0], args[1], args[2], args[3], args[4], args[5], args[6], args[7], args[8], args[9], args[10], args[11], fargs[0], fargs[1], fargs[2], fargs[3]);
         return float_to_value(r);
     }
+    else if (t == 'v') {
+        ((void (*)(value_t, value_t, value_t, value_t, value_t, value_t, value_t, value_t, value_t, value_t, value_t, value_t, value_t, float, float, float, float))fptr)
+            (obj, args[0], args[1], args[2], args[3], args[4], args[5], args[6], args[7], args[8], args[9], args[10], args[11], fargs[0], fargs[1], fargs[2], fargs[3]);
+        return VALUE_UNDEF;
+    }
     else {
         value_t r = ((value_t (*)(value_t, value_t, value_t, value_t, value_t, value_t, value_t, value_t, value_t, value_t, value_t, value_t, value_t, float, float, float, float))fptr)
                         (obj, args[0], args[1], args[2], args[3], args[4], args[5], args[6], args[7], args[8], args[9], args[10], args[11], fargs[0], fargs[1], fargs[2], fargs[3]);
@@ -2083,7 +4840,7 @@ void gc_write_barrier(pointer_t obj, value_t value) {
         if (is_ptr_value(value)) {
             uint32_t mark = current_no_mark ? 0 : 1;
             pointer_t ptr = value_to_ptr(value);
-            if (IS_WHITE(ptr, mark) && (obj == NULL || IS_BLACK(obj, mark))) {
+            if (gc_is_heap_object(ptr) && IS_WHITE(ptr, mark) && (obj == NULL || IS_BLACK(obj, mark))) {
                 GC_ENTER_CRITICAL(gc_mux);
                 if (gc_intr_stack_top < ISTACK_SIZE) 
                     gc_intr_stack[gc_intr_stack_top++] = ptr;
@@ -2131,7 +4888,7 @@ static void trace_from_an_object(uint32_t mark) {
                 value_t next = obj->body[j];
                 if (is_ptr_value(next) && next != VALUE_NULL) {
                     pointer_t nextp = value_to_ptr(next);
-                    if (GET_MARK_BIT(nextp) != mark) {    // not visisted yet
+                    if (gc_is_heap_object(nextp) && GET_MARK_BIT(nextp) != mark) {    // not visisted yet
                         push_object_to_stack(nextp, mark);
                     }
                 }
@@ -2180,7 +4937,7 @@ static void mark_objects(struct gc_root_set* root_set, uint32_t mark) {
             value_t v = root_set->values[i];
             if (is_ptr_value(v) && v != VALUE_NULL) {
                 pointer_t rootp = value_to_ptr(v);
-                if (GET_MARK_BIT(rootp) != mark) {    // not visisted yet
+                if (gc_is_heap_object(rootp) && GET_MARK_BIT(rootp) != mark) {    // not visisted yet
                     WRITE_MARK_BIT(rootp, mark);
                     SET_GRAY_BIT(rootp);
                     gc_stack[0] = rootp;
@@ -2298,6 +5055,8 @@ extern CR_SECTION int32_t value_to_int(value_t v);
 extern CR_SECTION value_t int_to_value(int32_t v);
 extern CR_SECTION bool is_int_value(value_t v);
 
+extern CR_SECTION value_t float_to_value(float f);
+extern CR_SECTION float value_to_float(value_t v);
 extern CR_SECTION bool is_float_value(value_t v);
 
 extern CR_SECTION pointer_t value_to_ptr(value_t v);
@@ -2309,7 +5068,18 @@ extern CR_SECTION bool value_to_bool(value_t v);
 extern CR_SECTION bool is_bool_value(value_t v);
 extern CR_SECTION bool safe_value_to_bool(value_t v);
 
+extern CR_SECTION int32_t* gc_intarray_elem(value_t obj, int32_t* base, int32_t len, int32_t index);
+extern CR_SECTION float* gc_floatarray_elem(value_t obj, float* base, int32_t len, int32_t index);
+extern CR_SECTION int32_t* gc_intarray_elem_lval(value_t obj, int32_t* base, int32_t len, int32_t index);
+extern CR_SECTION float* gc_floatarray_elem_lval(value_t obj, float* base, int32_t len, int32_t index);
+extern CR_SECTION uint8_t* gc_bytearray_elem(value_t obj, uint8_t* base, int32_t len, int32_t index);
+extern CR_SECTION int8_t* gc_int8array_elem(value_t obj, int8_t* base, int32_t len, int32_t index);
+extern CR_SECTION int16_t* gc_int16array_elem(value_t obj, int16_t* base, int32_t len, int32_t index);
+extern CR_SECTION uint16_t* gc_uint16array_elem(value_t obj, uint16_t* base, int32_t len, int32_t index);
+extern CR_SECTION int32_t* gc_uint32array_elem(value_t obj, int32_t* base, int32_t len, int32_t index);
+
 extern CR_SECTION value_t gc_new_object(const class_object* clazz);
+extern CR_SECTION int32_t gc_length_or_zero(value_t obj, int index);
 extern CR_SECTION value_t get_obj_property(value_t obj, int index);
 extern CR_SECTION value_t set_obj_property(value_t obj, int index, value_t new_value);
 extern CR_SECTION value_t set_global_variable(value_t* ptr, value_t new_value);
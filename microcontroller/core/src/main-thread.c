@@ -11,6 +11,7 @@
 
 #include "../include/main-thread.h"
 #include "../include/protocol.h"
+#include "../include/profiler.h"
 
 # define TASK_ITEM_QUEUE_LENGTH   5
 
@@ -35,14 +36,10 @@ typedef union {
         value_t fn;
     } call_event;
 
-    struct task_send_profile {
-        task_t task;
-        uint8_t fid;
-        char* profile;
-    } send_profile;
 } task_item_u;
 
 static QueueHandle_t task_item_queue;
+static uint8_t profile_records[BS_PROFILER_BATCH_SIZE];
 
 static void main_thread_init(bs_memory_layout_t* memory_layout) {
     BS_LOG_INFO("Initialize main thread")
@@ -58,6 +55,7 @@ static void main_thread_reset() {
     bs_memory_reset();
     gc_initialize();
     bs_stdmodule_main();
+    bs_profiler_reset();
     xQueueReset(task_item_queue);
 }
 
@@ -74,10 +72,12 @@ static void task_call_event(value_t fn) {
     ((void (*)(value_t))gc_function_object_ptr(fn, 0))(get_obj_property(fn, 2));
 }
 
-static void task_send_profile(uint8_t fid, char* profile) {
+// sends the profile records in batches.
+static void task_send_profile() {
     BS_LOG_INFO("Send profile")
-    bs_protocol_write_profile(fid, profile);
-    free(profile);
+    uint32_t len;
+    while ((len = bs_profiler_read(profile_records, sizeof(profile_records))) > 0)
+        bs_protocol_write_profile(profile_records, len);
 }
 
 void main_thread(void *arg) {
@@ -97,7 +97,7 @@ void main_thread(void *arg) {
                 task_call_event(task_item.call_event.fn);
                 break;
             case TASK_SEND_PROFILE:
-                task_send_profile(task_item.send_profile.fid, task_item.send_profile.profile);
+                task_send_profile();
                 break;
             case TASK_RESET:
                 main_thread_reset();
@@ -143,14 +143,9 @@ void bs_main_thread_set_event_from_isr(void* fn) {
     xQueueSendFromISR(task_item_queue, &task_item, &yield);
 }
 
-void bs_main_thread_set_profile(uint8_t fid, char* profile) {
-    uint32_t len = strlen(profile) + 1;
-    char* profile2 = (char*)malloc(len);
-    strcpy(profile2, profile);
-    portBASE_TYPE yield = pdFALSE;
+// This is called on the main thread.  It does not wait if the queue is full.
+bool bs_main_thread_set_profile() {
     task_item_u task_item;
-    task_item.call_event.task = TASK_SEND_PROFILE;
-    task_item.send_profile.fid = fid;
-    task_item.send_profile.profile = profile2;
-    xQueueSendFromISR(task_item_queue, &task_item, &yield);
+    task_item.task = TASK_SEND_PROFILE;
+    return xQueueSend(task_item_queue, &task_item, 0) == pdTRUE;
 }
\ No newline at end of file
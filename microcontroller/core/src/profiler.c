@@ -1,6 +1,5 @@
 #include <string.h>
 #include <stdio.h>
-#include <stdlib.h>
 
 #include "../include/profiler.h"
 #include "../include/c-runtime.h"
@@ -12,15 +11,95 @@
 
 #define BS_PROFILER_TAG        "BS_PROFILER"
 
-#define TYPEINT_SIZE             sizeof(typeint_t)
-#define PARAMS_NUM               4
-#define TYPE_PROFILE_COLUMN      (PARAMS_NUM + 1)
-#define TYPE_PROFILE_ROW         5
-#define TYPE_PROFILE_SIZE        TYPEINT_SIZE * TYPE_PROFILE_COLUMN * TYPE_PROFILE_ROW
-#define TYPE_COUNT_THRESHOLD     5
-#define CALL_COUNT_THRESHOLD     5
+#define PROFILE_DONE             UINT16_MAX     // the call count after profiling finishes
 
-char types_str[128];
+// the result of the return-type profiling
+#define RETURN_NONE              0      // no value has been returned yet
+#define RETURN_MONOMORPHIC       1      // every returned value is of return_type
+#define RETURN_MIXED             2      // values of different types have been returned
+
+/*
+  A type profile is a table of the types of the arguments.
+  Every row is [count, t1, t2, ..., tn], where n is the number of the profiled parameters.
+  Profiling stops when a row is dominant, or when the function turns out
+  to be megamorphic since the table overflows or no row is dominant.
+
+  Type profiles are allocated from a fixed-size arena, so profiling never calls malloc.
+  When the arena is full, the profile least recently used is recycled if it has not been
+  used for max_samples calls to other profiled functions.  Its function restarts counting
+  calls.  Otherwise, the new profile is dropped and the function restarts counting calls.
+*/
+struct bs_type_profile {
+    bs_type_profile** owner;    // the variable pointing to this profile.  NULL if this is free.
+    uint16_t* call_count;       // the call counter of the owner
+    uint32_t last_used;         // the value of profile_clock when this was used last time
+    uint16_t samples;           // the number of the profiled calls
+    uint8_t params;             // the number of the profiled parameters
+    uint8_t capacity;           // the number of the rows
+    uint8_t return_state;
+    typeint_t return_type;
+    typeint_t rows[(BS_PROFILER_MAX_PARAMS + 1) * BS_PROFILER_MAX_ROWS];
+};
+
+static bs_type_profile profile_arena[BS_PROFILER_MAX_PROFILES];
+static uint32_t profile_clock = 0;      // the number of the profiled calls to any function
+static uint32_t dropped_profiles = 0;
+
+/*
+  Profiles are reported as binary records in a ring buffer.
+
+  | PROFILE_RECORD | fid | n | flags | type id * n | return type id (if RECORD_RETURN) |
+  | CLASS_RECORD | type id | length | class name (length bytes) |
+  | HITS_RECORD | fid | version | hits (2 bytes, little endian) |
+
+  Every field is 1 byte unless its size is given.  Type ids 0 to 3 are integer, float, boolean, and undefined.
+  The other ids are given to classes.  A class record is written before
+  the first profile record using the class.  A megamorphic profile record has no type id.
+*/
+#define PROFILE_RECORD           0
+#define CLASS_RECORD             1
+#define HITS_RECORD              2
+#define RECORD_MEGAMORPHIC       1
+#define RECORD_RETURN            2
+#define PROFILE_HEADER_SIZE      4
+#define CLASS_HEADER_SIZE        3
+#define HITS_RECORD_SIZE         5
+#define MAX_CLASS_NAME           63
+#define FIRST_CLASS_ID           4
+#define TYPE_ID_ANY              0xff   // mixed types, or a class not given an id
+
+static uint8_t records[BS_PROFILER_BUFFER_SIZE];
+static uint32_t records_head = 0;       // the next index to write
+static uint32_t records_tail = 0;       // the next index to read
+static bool records_notified = false;   // true if the main thread has been requested to send records
+static const class_object* known_classes[BS_PROFILER_MAX_CLASSES];
+static uint32_t num_known_classes = 0;
+
+static bs_profiler_config config = {
+    .call_threshold = 16,
+    .type_threshold = 32,
+    .max_samples = 128,
+    .dominance = 90,
+    .rows = BS_PROFILER_MAX_ROWS,
+};
+
+void bs_profiler_configure(const bs_profiler_config* c) {
+    config = *c;
+    if (config.call_threshold >= PROFILE_DONE)
+        config.call_threshold = PROFILE_DONE - 1;
+
+    if (config.type_threshold == 0)
+        config.type_threshold = 1;
+
+    if (config.max_samples < config.type_threshold)
+        config.max_samples = config.type_threshold;
+
+    if (config.dominance > 100)
+        config.dominance = 100;
+
+    if (config.rows == 0 || config.rows > BS_PROFILER_MAX_ROWS)
+        config.rows = BS_PROFILER_MAX_ROWS;
+}
 
 static typeint_t value_to_typeint(value_t p) {
     uint32_t last_2bit = p & 3;
@@ -46,80 +125,338 @@ static const char* typeint_to_str(typeint_t typeint) {
 	}
 }
 
+// allocates a type profile for the function.  It returns NULL if the arena is full.
+static bs_type_profile* new_type_profile(bs_type_profile** owner, uint16_t* call_count, uint8_t params) {
+    bs_type_profile* profile = NULL;
+    for (int i = 0; i < BS_PROFILER_MAX_PROFILES; i++) {
+        bs_type_profile* p = &profile_arena[i];
+        if (p->owner == NULL) {
+            profile = p;
+            break;
+        }
+        else if (profile == NULL || p->last_used < profile->last_used)
+            profile = p;
+    }
+
+    if (profile->owner != NULL) {
+        if (profile_clock - profile->last_used < config.max_samples) {
+            dropped_profiles++;
+            return NULL;
+        }
+
+        *profile->owner = NULL;
+        *profile->call_count = 0;
+    }
+
+    memset(profile, 0, sizeof(bs_type_profile));
+    profile->owner = owner;
+    profile->call_count = call_count;
+    profile->last_used = profile_clock;
+    profile->params = params;
+    profile->capacity = config.rows;
+    return profile;
+}
+
+static void free_type_profile(bs_type_profile* profile) {
+    profile->owner = NULL;
+}
+
+uint32_t bs_profiler_dropped() {
+    return dropped_profiles;
+}
+
+static inline typeint_t* get_row(bs_type_profile* profile, int i) {
+    return profile->rows + (profile->params + 1) * i;
+}
+
 static inline bool row_is_empty(typeint_t* type_profile_row) {
     return *type_profile_row == 0;
 }
 
-static inline void increment_row_count(typeint_t* type_profile_row) {
-    *type_profile_row += 1;   
+static bool row_match_param_types(bs_type_profile* profile, typeint_t* type_profile_row, const value_t* params) {
+    for (int i = 0; i < profile->params; i++)
+        if (value_to_typeint(params[i]) != type_profile_row[i + 1])
+            return false;
+
+    return true;
 }
 
-static void set_initial_row(typeint_t* type_profile_row, value_t p1, value_t p2, value_t p3, value_t p4) {
-    *type_profile_row = 1;
-    *(type_profile_row + 1) = value_to_typeint(p1);
-    *(type_profile_row + 2) = value_to_typeint(p2);
-    *(type_profile_row + 3) = value_to_typeint(p3);
-    *(type_profile_row + 4) = value_to_typeint(p4);
+// records the types of the arguments and returns the row for them.
+// It returns NULL if the table is full.
+static typeint_t* record_param_types(bs_type_profile* profile, const value_t* params) {
+    profile->samples += 1;
+    profile->last_used = ++profile_clock;
+    for (int i = 0; i < profile->capacity; i++) {
+        typeint_t* row = get_row(profile, i);
+        if (row_is_empty(row)) {
+            *row = 1;
+            for (int j = 0; j < profile->params; j++)
+                row[j + 1] = value_to_typeint(params[j]);
+
+            return row;
+        } else if (row_match_param_types(profile, row, params)) {
+            *row += 1;
+            return row;
+        }
+    }
+
+    return NULL;
 }
 
-static bool row_match_param_types(typeint_t* type_profile_row, value_t p1, value_t p2, value_t p3, value_t p4) {
-    bool p1_match = value_to_typeint(p1) == *(type_profile_row + 1);
-    bool p2_match = value_to_typeint(p2) == *(type_profile_row + 2);
-    bool p3_match = value_to_typeint(p3) == *(type_profile_row + 3);
-    bool p4_match = value_to_typeint(p4) == *(type_profile_row + 4);
-    return p1_match && p2_match && p3_match && p4_match;
+static inline bool row_is_dominant(bs_type_profile* profile, typeint_t* row) {
+    return *row >= config.type_threshold && *row * 100 >= (typeint_t)config.dominance * profile->samples;
 }
 
-static char* row_to_str(typeint_t* type_profile_row) {
-    const char* p1_str = typeint_to_str(*(type_profile_row + 1));
-    const char* p2_str = typeint_to_str(*(type_profile_row + 2));
-    const char* p3_str = typeint_to_str(*(type_profile_row + 3));
-    const char* p4_str = typeint_to_str(*(type_profile_row + 4));
-    snprintf(types_str, sizeof(types_str), "%s, %s, %s, %s", p1_str, p2_str, p3_str, p4_str);
-    return types_str;
+static inline bool is_megamorphic(bs_type_profile* profile, typeint_t* row) {
+    return row == NULL || profile->samples >= config.max_samples;
 }
 
-static void send_row(uint8_t fid, typeint_t* type_profile_row) {
-    char* s = row_to_str(type_profile_row);
-#ifdef LINUX64
-    printf("%s\n", s);
-#else 
-    bs_main_thread_set_profile(fid, s);
-#endif
+static inline uint32_t records_free() {
+    return BS_PROFILER_BUFFER_SIZE - (records_head - records_tail);
 }
 
-static typeint_t* get_row_on_threshold(uint8_t fid, typeint_t* type_profile, value_t p1, value_t p2, value_t p3, value_t p4) {
-    for (int i = 0; i < TYPE_PROFILE_ROW; i++) {
-        typeint_t* row = type_profile + TYPE_PROFILE_COLUMN * i;
-        if(row_is_empty(row)) {
-            set_initial_row(row, p1, p2, p3, p4);
-            return NULL;
-        } else if (row_match_param_types(row, p1, p2, p3, p4)) {
-            increment_row_count(row);
-            return *row == TYPE_COUNT_THRESHOLD ? row : NULL;
+static inline void put_record_byte(uint8_t b) {
+    records[records_head++ & (BS_PROFILER_BUFFER_SIZE - 1)] = b;
+}
+
+// the size of the record starting with the given header.
+static uint32_t record_size(const uint8_t* header) {
+    if (header[0] == CLASS_RECORD)
+        return CLASS_HEADER_SIZE + header[2];
+    else if (header[0] == HITS_RECORD)
+        return HITS_RECORD_SIZE;
+    else
+        return PROFILE_HEADER_SIZE + header[2] + (header[3] & RECORD_RETURN ? 1 : 0);
+}
+
+// returns the type id of the given type.  When a class is seen for the first time,
+// it writes a class record.  It returns -1 if the buffer is full.
+static int32_t type_to_id(typeint_t t) {
+    if (t < FIRST_CLASS_ID)
+        return (int32_t)t;
+
+    const class_object* clazz = (const class_object*)t;
+    for (uint32_t i = 0; i < num_known_classes; i++)
+        if (known_classes[i] == clazz)
+            return FIRST_CLASS_ID + i;
+
+    if (num_known_classes >= BS_PROFILER_MAX_CLASSES || FIRST_CLASS_ID + num_known_classes >= TYPE_ID_ANY)
+        return TYPE_ID_ANY;
+
+    uint32_t len = strlen(clazz->name);
+    if (len > MAX_CLASS_NAME)
+        len = MAX_CLASS_NAME;
+
+    if (records_free() < CLASS_HEADER_SIZE + len)
+        return -1;
+
+    uint32_t id = FIRST_CLASS_ID + num_known_classes;
+    known_classes[num_known_classes++] = clazz;
+    put_record_byte(CLASS_RECORD);
+    put_record_byte(id);
+    put_record_byte(len);
+    for (uint32_t i = 0; i < len; i++)
+        put_record_byte(clazz->name[i]);
+
+    return id;
+}
+
+// writes a profile record.  If row is NULL, the function is megamorphic.
+// It returns false if the buffer is full.
+static bool write_profile_record(uint8_t fid, bs_type_profile* profile, typeint_t* row) {
+    uint8_t ids[BS_PROFILER_MAX_PARAMS + 1];
+    uint8_t n = 0;
+    uint8_t flags = 0;
+    uint32_t num_ids = 0;
+    if (row == NULL)
+        flags = RECORD_MEGAMORPHIC;
+    else {
+        for (n = 0; n < profile->params; n++) {
+            int32_t id = type_to_id(row[n + 1]);
+            if (id < 0)
+                return false;
+
+            ids[num_ids++] = id;
+        }
+
+        if (profile->return_state != RETURN_NONE) {
+            int32_t id = profile->return_state == RETURN_MIXED ? TYPE_ID_ANY : type_to_id(profile->return_type);
+            if (id < 0)
+                return false;
+
+            ids[num_ids++] = id;
+            flags |= RECORD_RETURN;
         }
     }
-    return NULL;
+
+    if (records_free() < PROFILE_HEADER_SIZE + num_ids)
+        return false;
+
+    put_record_byte(PROFILE_RECORD);
+    put_record_byte(fid);
+    put_record_byte(n);
+    put_record_byte(flags);
+    for (uint32_t i = 0; i < num_ids; i++)
+        put_record_byte(ids[i]);
+
+    return true;
+}
+
+/*
+  Copies as many whole records as possible into the buffer.
+  It returns the number of the copied bytes.  The size of the buffer
+  should be BS_PROFILER_BATCH_SIZE.
+*/
+uint32_t bs_profiler_read(uint8_t* buffer, uint32_t size) {
+    uint32_t len = 0;
+    while (records_tail != records_head) {
+        uint8_t header[PROFILE_HEADER_SIZE];
+        for (int i = 0; i < PROFILE_HEADER_SIZE; i++)
+            header[i] = records[(records_tail + i) & (BS_PROFILER_BUFFER_SIZE - 1)];
+
+        uint32_t rsize = record_size(header);
+        if (len + rsize > size)
+            return len;
+
+        for (uint32_t i = 0; i < rsize; i++)
+            buffer[len++] = records[records_tail++ & (BS_PROFILER_BUFFER_SIZE - 1)];
+    }
+
+    records_notified = false;
+    return len;
+}
+
+// This must be called when the profiled functions are unloaded.
+void bs_profiler_reset() {
+    for (int i = 0; i < BS_PROFILER_MAX_PROFILES; i++)
+        free_type_profile(&profile_arena[i]);
+
+    profile_clock = 0;
+    records_head = records_tail = 0;
+    records_notified = false;
+    num_known_classes = 0;
+}
+
+#ifdef LINUX64
+
+static char types_str[64 * (BS_PROFILER_MAX_PARAMS + 1)];
+
+static const char* type_id_to_str(uint8_t id) {
+    if (id < FIRST_CLASS_ID)
+        return typeint_to_str(id);
+    else if (id == TYPE_ID_ANY)
+        return "any";
+    else
+        return known_classes[id - FIRST_CLASS_ID]->name;
+}
+
+// converts a profile record into "t1, t2, ..., tn", "t1, t2, ..., tn -> r", or "megamorphic".
+static char* record_to_str(const uint8_t* record) {
+    if (record[3] & RECORD_MEGAMORPHIC)
+        return strcpy(types_str, "megamorphic");
+
+    uint8_t n = record[2];
+    int len = 0;
+    types_str[0] = '\0';
+    for (int i = 0; i < n && len < sizeof(types_str); i++)
+        len += snprintf(types_str + len, sizeof(types_str) - len, i == 0 ? "%s" : ", %s",
+                        type_id_to_str(record[PROFILE_HEADER_SIZE + i]));
+
+    if (record[3] & RECORD_RETURN && len < sizeof(types_str))
+        snprintf(types_str + len, sizeof(types_str) - len, " -> %s", type_id_to_str(record[PROFILE_HEADER_SIZE + n]));
+
+    return types_str;
+}
+
+static void print_records() {
+    uint8_t buffer[BS_PROFILER_BATCH_SIZE];
+    uint32_t len;
+    while ((len = bs_profiler_read(buffer, sizeof(buffer))) > 0)
+        for (uint32_t i = 0; i < len; i += record_size(buffer + i))
+            if (buffer[i] == PROFILE_RECORD)
+                printf("%s\n", record_to_str(buffer + i));
 }
 
-void bs_profiler_profile(uint8_t fid, uint8_t* call_count, typeint_t** type_profile, value_t p1, value_t p2, value_t p3, value_t p4) {
-    if (*call_count < CALL_COUNT_THRESHOLD) {
+#endif
+
+// requests the main thread to send the records.
+static void flush_records() {
+#ifdef LINUX64
+    print_records();
+#else
+    if (!records_notified)
+        records_notified = bs_main_thread_set_profile();
+#endif
+}
+
+void bs_profiler_profile(uint8_t fid, uint16_t* call_count, bs_type_profile** type_profile,
+                         uint8_t n, const value_t* params) {
+    if (*call_count < config.call_threshold) {
         *call_count += 1;
         return;
-    } else if (*call_count == CALL_COUNT_THRESHOLD) {
+    } else if (*call_count == config.call_threshold) {
+        *type_profile = new_type_profile(type_profile, call_count, n > BS_PROFILER_MAX_PARAMS ? BS_PROFILER_MAX_PARAMS : n);
+        if (*type_profile == NULL) {
+            *call_count = 0;
+            return;
+        }
+
         *call_count += 1;
-        *type_profile = malloc(TYPE_PROFILE_SIZE);
-		memset(*type_profile, 0, TYPE_PROFILE_SIZE);
+    }
+
+    bs_type_profile* profile = *type_profile;
+    if (profile == NULL)
         return;
-    } else if (*type_profile) {
-        typeint_t* result_row = get_row_on_threshold(fid, *type_profile, p1, p2, p3, p4);
-        if (result_row != NULL) {
-            send_row(fid, result_row);
-            free(*type_profile);
-            *type_profile = NULL;
-        }
+
+    typeint_t* row = record_param_types(profile, params);
+    if (row == NULL || !row_is_dominant(profile, row)) {
+        if (!is_megamorphic(profile, row))
+            return;
+
+        row = NULL;
+    }
+
+    bool written = write_profile_record(fid, profile, row);
+    flush_records();
+    if (!written)
+        return;     // the buffer is full.  Retry when the function is called next time.
+
+    free_type_profile(profile);
+    *type_profile = NULL;
+    *call_count = PROFILE_DONE;
+}
+
+void bs_profiler_profile_return(bs_type_profile** type_profile, value_t result) {
+    bs_type_profile* profile = *type_profile;
+    if (profile == NULL)
         return;
+
+    typeint_t t = value_to_typeint(result);
+    if (profile->return_state == RETURN_NONE) {
+        profile->return_state = RETURN_MONOMORPHIC;
+        profile->return_type = t;
     }
-    return;
+    else if (profile->return_state == RETURN_MONOMORPHIC && profile->return_type != t)
+        profile->return_state = RETURN_MIXED;
 }
 
+/*
+  Counts the calls to a specialized version of a function.
+  The count is reported by a hits record every BS_PROFILER_HITS_INTERVAL calls,
+  so that the compiler can tell hot versions from cold ones.
+*/
+void bs_profiler_count_hits(uint8_t fid, uint8_t version, uint16_t* hits) {
+    if (*hits < UINT16_MAX)
+        *hits += 1;
+
+    if (*hits < BS_PROFILER_HITS_INTERVAL || records_free() < HITS_RECORD_SIZE)
+        return;     // if the buffer is full, retry when the version is called next time.
+
+    put_record_byte(HITS_RECORD);
+    put_record_byte(fid);
+    put_record_byte(version);
+    put_record_byte(*hits & 0xff);
+    put_record_byte(*hits >> 8);
+    *hits = 0;
+    flush_records();
+}
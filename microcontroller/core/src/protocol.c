@@ -4,6 +4,7 @@
 #include "memory.h"
 #include "../include/protocol.h"
 #include "../include/main-thread.h"
+#include "../include/profiler.h"
 
 
 #define PROTOCOL_LEN 1
@@ -64,19 +65,17 @@ void bs_protocol_write_error(char* message) {
     }
 }
 
-void bs_protocol_write_profile(uint8_t fid, char* profile) {
-    uint32_t len = strlen(profile);
-    uint32_t buffer_len = PROTOCOL_LEN + sizeof(uint8_t) + len + sizeof(uint8_t); // size of fid + len + size of null
-    uint8_t* buffer = (uint8_t*)malloc(buffer_len);
-    if (buffer != NULL) {
-        buffer[0] = PROTOCOL_PROFILE;
-        buffer[1] = fid;
-        strcpy((char*)(buffer + PROTOCOL_LEN + sizeof(uint8_t)), profile);
-        send_buffer(buffer, buffer_len);
-        free(buffer);
-    } else {
-        BS_LOG_ERROR("Could not get buffer.");
-    }   
+// | cmd(1byte) | profile records(len) |
+void bs_protocol_write_profile(uint8_t* records, uint32_t len) {
+    static uint8_t buffer[PROTOCOL_LEN + BS_PROFILER_BATCH_SIZE];
+    if (len > BS_PROFILER_BATCH_SIZE) {
+        BS_LOG_ERROR("Too many profile records.");
+        return;
+    }
+
+    buffer[0] = PROTOCOL_PROFILE;
+    memcpy(buffer + PROTOCOL_LEN, records, len);
+    send_buffer(buffer, PROTOCOL_LEN + len);
 }
 
 void bs_protocol_write_execution_time(int32_t id, float time) {
@@ -0,0 +1,46 @@
+// Copyright (C) 2026- Shigeru Chiba.  All rights reserved.
+
+#include "../include/sampler.h"
+
+/*
+  A lock-free ring buffer with a single producer and a single consumer.
+  Only the producer writes sampler_head, and only the consumer writes sampler_tail.
+  The producer drops a sample if the buffer is full.
+*/
+static uintptr_t samples[BS_SAMPLER_BUFFER_SIZE];
+static volatile uint32_t sampler_head = 0;      // the next index to write
+static volatile uint32_t sampler_tail = 0;      // the next index to read
+static volatile uint32_t sampler_dropped = 0;
+
+void bs_sampler_record(uintptr_t pc) {
+    uint32_t head = sampler_head;
+    if (head - __atomic_load_n(&sampler_tail, __ATOMIC_ACQUIRE) >= BS_SAMPLER_BUFFER_SIZE) {
+        sampler_dropped = sampler_dropped + 1;
+        return;
+    }
+
+    samples[head & (BS_SAMPLER_BUFFER_SIZE - 1)] = pc;
+    __atomic_store_n(&sampler_head, head + 1, __ATOMIC_RELEASE);
+}
+
+// copies the samples into the buffer and returns the number of the copied samples.
+uint32_t bs_sampler_read(uintptr_t* buffer, uint32_t size) {
+    uint32_t tail = sampler_tail;
+    uint32_t head = __atomic_load_n(&sampler_head, __ATOMIC_ACQUIRE);
+    uint32_t n = 0;
+    while (tail != head && n < size)
+        buffer[n++] = samples[tail++ & (BS_SAMPLER_BUFFER_SIZE - 1)];
+
+    __atomic_store_n(&sampler_tail, tail, __ATOMIC_RELEASE);
+    return n;
+}
+
+uint32_t bs_sampler_dropped() {
+    return sampler_dropped;
+}
+
+// This must not be called while samples are being recorded.
+void bs_sampler_reset() {
+    sampler_head = sampler_tail = 0;
+    sampler_dropped = 0;
+}
@@ -0,0 +1,261 @@
+// Throughput of the bulk operations on typed arrays in c-runtime.c
+// compared with loops calling the element accessors.
+// To compile,
+// cc -O2 -DLINUX64 array-ops-bench.c -lm
+// Add -mavx2 to use AVX2 instructions, or -DBULK_NO_VECTOR to use
+// the portable implementation.
+
+#include <stdio.h>
+#include <time.h>
+#include "../src/c-runtime.c"
+
+#define LEN     1024
+#define R       20000
+
+static double now() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static volatile float fsink;
+static volatile int32_t isink;
+
+static void report(const char* name, double t0, double t1) {
+    printf("%-24s %8.3f ns/element\n", name, (t1 - t0) * 1e9 / ((double)LEN * R));
+}
+
+int main() {
+#ifdef LINUX64
+    initialize_pointer_table();
+#endif
+    gc_initialize();
+    ROOT_SET(root_set, 5)
+    value_t a = root_set.values[0] = gc_new_intarray(LEN, 0);
+    value_t b = root_set.values[1] = gc_new_intarray(LEN, 0);
+    value_t f = root_set.values[2] = gc_new_floatarray(LEN, 0.0);
+    value_t g = root_set.values[3] = gc_new_floatarray(LEN, 0.0);
+    value_t u = root_set.values[4] = gc_new_bytearray(false, LEN, 0);
+    uint32_t seed = 1;
+    for (int i = 0; i < LEN; i++) {
+        seed = seed * 1103515245 + 12345;
+        *gc_intarray_get(a, i) = (int32_t)seed >> 20;
+        *gc_intarray_get(b, i) = (int32_t)seed % 7;
+        *gc_floatarray_get(f, i) = (float)((int32_t)seed >> 8) / (1 << 16);
+        *gc_floatarray_get(g, i) = (float)(seed % 13) / 8;
+        *gc_bytearray_get(u, i) = (uint8_t)seed;
+    }
+
+    double t0, t1;
+
+    t0 = now();
+    for (int r = 0; r < R; r++) {
+        float s = 0.0f;
+        for (int i = 0; i < LEN; i++)
+            s += *gc_floatarray_get(f, i);
+        fsink = s;
+    }
+    t1 = now();
+    report("float[] sum (loop)", t0, t1);
+
+    t0 = now();
+    for (int r = 0; r < R; r++)
+        fsink = floatarray_sum(f);
+    t1 = now();
+    report("float[] sum", t0, t1);
+
+    t0 = now();
+    for (int r = 0; r < R; r++) {
+        float s = 0.0f;
+        for (int i = 0; i < LEN; i++)
+            s += *gc_floatarray_get(f, i) * *gc_floatarray_get(g, i);
+        fsink = s;
+    }
+    t1 = now();
+    report("float[] dot (loop)", t0, t1);
+
+    t0 = now();
+    for (int r = 0; r < R; r++)
+        fsink = floatarray_dot(f, g);
+    t1 = now();
+    report("float[] dot", t0, t1);
+
+    t0 = now();
+    for (int r = 0; r < R; r++) {
+        float m = *gc_floatarray_get(f, 0);
+        for (int i = 1; i < LEN; i++) {
+            float e = *gc_floatarray_get(f, i);
+            m = e > m ? e : m;
+        }
+        fsink = m;
+    }
+    t1 = now();
+    report("float[] max (loop)", t0, t1);
+
+    t0 = now();
+    for (int r = 0; r < R; r++)
+        fsink = floatarray_max(f);
+    t1 = now();
+    report("float[] max", t0, t1);
+
+    t0 = now();
+    for (int r = 0; r < R; r++)
+        for (int i = 0; i < LEN; i++)
+            *gc_floatarray_get(g, i) += *gc_floatarray_get(f, i);
+    t1 = now();
+    report("float[] add (loop)", t0, t1);
+
+    t0 = now();
+    for (int r = 0; r < R; r++)
+        floatarray_add(g, f);
+    t1 = now();
+    report("float[] add", t0, t1);
+
+    t0 = now();
+    for (int r = 0; r < R; r++)
+        for (int i = 0; i < LEN; i++)
+            *gc_floatarray_get(g, i) *= 0.5f;
+    t1 = now();
+    report("float[] scale (loop)", t0, t1);
+
+    t0 = now();
+    for (int r = 0; r < R; r++)
+        floatarray_scale(g, 0.5f);
+    t1 = now();
+    report("float[] scale", t0, t1);
+
+    t0 = now();
+    for (int r = 0; r < R; r++)
+        for (int i = 0; i < LEN; i++)
+            *gc_floatarray_get(g, i) = (float)r;
+    t1 = now();
+    report("float[] fill (loop)", t0, t1);
+
+    t0 = now();
+    for (int r = 0; r < R; r++)
+        floatarray_fill(g, (float)r);
+    t1 = now();
+    report("float[] fill", t0, t1);
+
+    t0 = now();
+    for (int r = 0; r < R; r++)
+        for (int i = 0; i < LEN; i++)
+            *gc_floatarray_get(g, i) = *gc_floatarray_get(f, i);
+    t1 = now();
+    report("float[] set (loop)", t0, t1);
+
+    t0 = now();
+    for (int r = 0; r < R; r++)
+        floatarray_set(g, f, 0);
+    t1 = now();
+    report("float[] set", t0, t1);
+
+    t0 = now();
+    for (int r = 0; r < R; r++) {
+        int32_t s = 0;
+        for (int i = 0; i < LEN; i++)
+            s += *gc_intarray_get(a, i);
+        isink = s;
+    }
+    t1 = now();
+    report("integer[] sum (loop)", t0, t1);
+
+    t0 = now();
+    for (int r = 0; r < R; r++)
+        isink = intarray_sum(a);
+    t1 = now();
+    report("integer[] sum", t0, t1);
+
+    t0 = now();
+    for (int r = 0; r < R; r++) {
+        int32_t s = 0;
+        for (int i = 0; i < LEN; i++)
+            s += *gc_intarray_get(a, i) * *gc_intarray_get(b, i);
+        isink = s;
+    }
+    t1 = now();
+    report("integer[] dot (loop)", t0, t1);
+
+    t0 = now();
+    for (int r = 0; r < R; r++)
+        isink = intarray_dot(a, b);
+    t1 = now();
+    report("integer[] dot", t0, t1);
+
+    t0 = now();
+    for (int r = 0; r < R; r++) {
+        int32_t m = *gc_intarray_get(a, 0);
+        for (int i = 1; i < LEN; i++) {
+            int32_t e = *gc_intarray_get(a, i);
+            m = e < m ? e : m;
+        }
+        isink = m;
+    }
+    t1 = now();
+    report("integer[] min (loop)", t0, t1);
+
+    t0 = now();
+    for (int r = 0; r < R; r++)
+        isink = intarray_min(a);
+    t1 = now();
+    report("integer[] min", t0, t1);
+
+    t0 = now();
+    for (int r = 0; r < R; r++)
+        for (int i = 0; i < LEN; i++)
+            *gc_intarray_get(b, i) += *gc_intarray_get(a, i);
+    t1 = now();
+    report("integer[] add (loop)", t0, t1);
+
+    t0 = now();
+    for (int r = 0; r < R; r++)
+        intarray_add(b, a);
+    t1 = now();
+    report("integer[] add", t0, t1);
+
+    t0 = now();
+    for (int r = 0; r < R; r++)
+        for (int i = 0; i < LEN; i++)
+            *gc_intarray_get(b, i) *= 3;
+    t1 = now();
+    report("integer[] scale (loop)", t0, t1);
+
+    t0 = now();
+    for (int r = 0; r < R; r++)
+        intarray_scale(b, 3);
+    t1 = now();
+    report("integer[] scale", t0, t1);
+
+    t0 = now();
+    for (int r = 0; r < R; r++) {
+        int32_t s = 0;
+        for (int i = 0; i < LEN; i++)
+            s += *gc_bytearray_get(u, i);
+        isink = s;
+    }
+    t1 = now();
+    report("Uint8Array sum (loop)", t0, t1);
+
+    t0 = now();
+    for (int r = 0; r < R; r++)
+        isink = bytearray_sum(u);
+    t1 = now();
+    report("Uint8Array sum", t0, t1);
+
+    t0 = now();
+    for (int r = 0; r < R; r++)
+        for (int i = 0; i < LEN; i++)
+            *gc_bytearray_get(u, i) = (uint8_t)(*gc_bytearray_get(u, i) + *gc_bytearray_get(u, i));
+    t1 = now();
+    report("Uint8Array add (loop)", t0, t1);
+
+    t0 = now();
+    for (int r = 0; r < R; r++)
+        bytearray_add(u, u);
+    t1 = now();
+    report("Uint8Array add", t0, t1);
+
+    printf("checksum: %f %f\n", floatarray_sum(f), floatarray_dot(f, f));
+    DELETE_ROOT_SET(root_set)
+    return 0;
+}
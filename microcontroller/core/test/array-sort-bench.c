@@ -0,0 +1,174 @@
+// Throughput of sort() on arrays in c-runtime.c compared with
+// the sorting functions written in BlueScript, such as the quicksort below.
+// The "(loop)" versions are the C code that the compiler generates for them.
+// To compile,
+// cc -O2 -DLINUX64 array-sort-bench.c -lm
+
+#include <stdio.h>
+#include <time.h>
+#include "../src/c-runtime.c"
+
+#define LEN     1024
+#define R       200
+
+static double now() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void report(const char* name, double t0, double t1) {
+    printf("%-28s %8.3f us/sort\n", name, (t1 - t0) * 1e6 / R);
+}
+
+static uint32_t seed = 1;
+
+static int32_t next_random() {
+    seed = seed * 1103515245 + 12345;
+    return (int32_t)(seed >> 8);
+}
+
+/*
+  function quicksort(a: integer[], lo: integer, hi: integer) {
+    if (lo >= hi) return
+    const p = a[(lo + hi) >> 1]
+    let i = lo, j = hi
+    while (i <= j) {
+      while (a[i] < p) i++
+      while (a[j] > p) j--
+      if (i <= j) { const t = a[i]; a[i] = a[j]; a[j] = t; i++; j-- }
+    }
+    quicksort(a, lo, j); quicksort(a, i, hi)
+  }
+*/
+static void quicksort_loop(value_t a, int32_t lo, int32_t hi) {
+    if (lo >= hi)
+        return;
+
+    int32_t p = *gc_intarray_get(a, (lo + hi) >> 1);
+    int32_t i = lo, j = hi;
+    while (i <= j) {
+        while (*gc_intarray_get(a, i) < p) i++;
+        while (*gc_intarray_get(a, j) > p) j--;
+        if (i <= j) {
+            int32_t t = *gc_intarray_get(a, i);
+            *gc_intarray_get(a, i) = *gc_intarray_get(a, j);
+            *gc_intarray_get(a, j) = t;
+            i++;
+            j--;
+        }
+    }
+
+    quicksort_loop(a, lo, j);
+    quicksort_loop(a, i, hi);
+}
+
+// the same quicksort on any[] calling a comparator function object.
+static void quicksort_any_loop(value_t a, int32_t lo, int32_t hi, value_t cmp) {
+    if (lo >= hi)
+        return;
+
+    value_t p = *gc_array_get(a, (lo + hi) >> 1);
+    int32_t i = lo, j = hi;
+    int32_t (*f)(value_t, value_t, value_t) = (int32_t (*)(value_t, value_t, value_t))gc_function_object_ptr(cmp, 0);
+    while (i <= j) {
+        while (f(cmp, *gc_array_get(a, i), p) < 0) i++;
+        while (f(cmp, *gc_array_get(a, j), p) > 0) j--;
+        if (i <= j) {
+            value_t t = *gc_array_get(a, i);
+            gc_array_set(a, i, *gc_array_get(a, j));
+            gc_array_set(a, j, t);
+            i++;
+            j--;
+        }
+    }
+
+    quicksort_any_loop(a, lo, j, cmp);
+    quicksort_any_loop(a, i, hi, cmp);
+}
+
+static int32_t compare_ints(value_t self, value_t a, value_t b) {
+    return value_to_int(a) - value_to_int(b);
+}
+
+static void fill_ints(value_t a) {
+    for (int i = 0; i < LEN; i++)
+        *gc_intarray_get(a, i) = next_random() % 100000;
+}
+
+static void fill_any(value_t a) {
+    for (int i = 0; i < LEN; i++)
+        gc_array_set(a, i, int_to_value(next_random() % 100000));
+}
+
+int main() {
+#ifdef LINUX64
+    initialize_pointer_table();
+#endif
+    gc_initialize();
+    ROOT_SET(root_set, 4)
+    value_t a = root_set.values[0] = gc_new_intarray(LEN, 0);
+    value_t f = root_set.values[1] = gc_new_floatarray(LEN, 0.0);
+    value_t any = root_set.values[2] = gc_new_array(NULL, LEN, VALUE_UNDEF);
+    value_t cmp = root_set.values[3] = gc_new_function(compare_ints, "(aa)i", VALUE_UNDEF);
+    double t0, t1, total;
+
+    total = 0.0;
+    for (int r = 0; r < R; r++) {
+        fill_ints(a);
+        t0 = now();
+        quicksort_loop(a, 0, LEN - 1);
+        total += now() - t0;
+    }
+    report("integer[] quicksort (loop)", 0.0, total);
+
+    total = 0.0;
+    for (int r = 0; r < R; r++) {
+        fill_ints(a);
+        t0 = now();
+        intarray_sort(a);
+        total += now() - t0;
+    }
+    report("integer[] sort", 0.0, total);
+
+    total = 0.0;
+    for (int r = 0; r < R; r++) {
+        for (int i = 0; i < LEN; i++)
+            *gc_floatarray_get(f, i) = (float)next_random() / 1024.0f;
+
+        t0 = now();
+        floatarray_sort(f);
+        total += now() - t0;
+    }
+    report("float[] sort", 0.0, total);
+
+    total = 0.0;
+    for (int r = 0; r < R; r++) {
+        fill_any(any);
+        t0 = now();
+        quicksort_any_loop(any, 0, LEN - 1, cmp);
+        total += now() - t0;
+    }
+    report("any[] quicksort (loop)", 0.0, total);
+
+    total = 0.0;
+    for (int r = 0; r < R; r++) {
+        fill_any(any);
+        t0 = now();
+        gc_array_sort(any, cmp);
+        total += now() - t0;
+    }
+    report("any[] sort", 0.0, total);
+
+    t0 = now();
+    int32_t found = 0;
+    for (int r = 0; r < R; r++)
+        for (int i = 0; i < LEN; i++)
+            found += intarray_binary_search(a, *gc_intarray_get(a, i)) >= 0;
+    t1 = now();
+    report("integer[] binarySearch x1024", t0, t1);
+
+    printf("checksum: %d %d %f\n", found, intarray_sum(a), floatarray_sum(f));
+    DELETE_ROOT_SET(root_set)
+    return 0;
+}
@@ -199,8 +199,6 @@ void test_String() {
     Assert_pequals(gc_get_class_of(s1), &string_literal);
     Assert_pequals(gc_get_class_of(s), &class_String);
     Assert_true(gc_is_string_object(s));
-    Assert_true(gc_is_string_instance(s));
-    Assert_true(!gc_is_string_literal(s));
     Assert_true(!is_int_value(s));
     Assert_true(!is_float_value(s));
     Assert_true(is_ptr_value(s));
@@ -498,6 +496,30 @@ void test_copy_array() {
     root_set.values[0] = v;
     Assert_equals(gc_array_length(v), 0);
 
+    // Test 6: Copy an array whose elements wrap around the end of its fixed array
+    src = gc_make_array(NULL, 3, int_to_value(1), int_to_value(2), int_to_value(3));
+    root_set.values[0] = src;
+    gc_array_unshift(src, int_to_value(0));
+    Assert_true(value_to_ptr(src)->body[1] != 0);
+    value_t arr6 = gc_copy_array(NULL, src);
+    root_set.values[1] = arr6;
+    Assert_equals(gc_array_length(arr6), 4);
+    for (int32_t i = 0; i < 4; i++)
+        Assert_equals(*gc_array_get(arr6, i), int_to_value(i));
+
+    // Test 7: Make arrays from C arrays
+    static const int32_t ints[] = { 3, -1, 4 };
+    static const float floats[] = { 1.5f, -2.0f };
+    v = gc_make_intarray_from(3, ints);
+    root_set.values[0] = v;
+    Assert_equals(gc_intarray_length(v), 3);
+    Assert_equals(*gc_intarray_get(v, 1), -1);
+    Assert_equals(*gc_intarray_get(v, 2), 4);
+    v = gc_make_floatarray_from(2, floats);
+    root_set.values[0] = v;
+    Assert_equals(gc_floatarray_length(v), 2);
+    Assert_fequals(*gc_floatarray_get(v, 1), -2.0);
+
     DELETE_ROOT_SET(root_set);
 }
 
@@ -628,9 +650,9 @@ void test_root_set() {
         obj = gc_new_fixedarray2(4);
 
     gc_run();
-    Assert_equals(heap_memory[0], 4);
-    Assert_equals(heap_memory[4], heap_size);
-    Assert_equals(heap_memory[5], heap_size - 4);
+    Assert_equals(heap_memory[0], 6);
+    Assert_equals(heap_memory[6], heap_size);
+    Assert_equals(heap_memory[7], heap_size - 6);
     Assert_true(is_live_object(root_set.values[0]));
     Assert_true(!is_live_object(obj));
 
@@ -650,10 +672,10 @@ void test_root_set2() {
     root_set.values[0] = VALUE_NULL;
     gc_run();
     Assert_equals(heap_memory[0], 2);
-    Assert_equals(heap_memory[2], 6);
-    Assert_equals(heap_memory[3], 2);
-    Assert_equals(heap_memory[6], heap_size);
-    Assert_equals(heap_memory[7], heap_size - 6);
+    Assert_equals(heap_memory[2], 10);
+    Assert_equals(heap_memory[3], 4);
+    Assert_equals(heap_memory[10], heap_size);
+    Assert_equals(heap_memory[11], heap_size - 10);
 
     DELETE_ROOT_SET(root_set);
 }
@@ -686,20 +708,20 @@ void test_nested_root_set() {
     test_nested_root_set3();
 
     Assert_equals(heap_memory[0], 2);
-    Assert_equals(heap_memory[2], 6);
-    Assert_equals(heap_memory[3], 2);
-    Assert_equals(heap_memory[6], 32);
-    Assert_equals(heap_memory[7], 22);
-    Assert_pequals(get_objects_class((pointer_t)&heap_memory[28]), &class_FixedArray);
-    Assert_equals(heap_memory[32], heap_size);
-    Assert_equals(heap_memory[33], heap_size - 32);
+    Assert_equals(heap_memory[2], 10);
+    Assert_equals(heap_memory[3], 4);
+    Assert_equals(heap_memory[10], 36);
+    Assert_equals(heap_memory[11], 22);
+    Assert_pequals(get_objects_class((pointer_t)&heap_memory[32]), &class_FixedArray);
+    Assert_equals(heap_memory[36], heap_size);
+    Assert_equals(heap_memory[37], heap_size - 36);
 
     gc_run();
     Assert_equals(heap_memory[0], 2);
-    Assert_equals(heap_memory[2], 6);
-    Assert_equals(heap_memory[3], 2);
-    Assert_equals(heap_memory[6], heap_size);
-    Assert_equals(heap_memory[7], heap_size - 6);
+    Assert_equals(heap_memory[2], 10);
+    Assert_equals(heap_memory[3], 4);
+    Assert_equals(heap_memory[10], heap_size);
+    Assert_equals(heap_memory[11], heap_size - 10);
 
     DELETE_ROOT_SET(root_set);
 }
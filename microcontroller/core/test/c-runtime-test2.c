@@ -175,6 +175,112 @@ void test_array() {
     Assert_true(try_and_catch(test_array2));
 }
 
+void test_hoisted_array_elem2() {
+    value_t arr = test_array_var;
+    gc_intarray_elem(arr, gc_intarray_base(arr), gc_length_or_zero(arr, 0), 3);
+}
+
+void test_hoisted_array_elem() {
+    value_t arr = gc_make_intarray(3, 10, 20, 30);
+    int32_t* base = gc_intarray_base(arr);
+    int32_t len = gc_length_or_zero(arr, 0);
+    Assert_equals(len, 3);
+    Assert_equals(*gc_intarray_elem(arr, base, len, 2), 30);
+    *gc_intarray_elem(arr, base, len, 0) = 11;
+    Assert_equals(*gc_intarray_get(arr, 0), 11);
+
+    value_t farr = gc_make_floatarray(2, 1.5, 2.5);
+    Assert_fequals(*gc_floatarray_elem(farr, gc_floatarray_base(farr), gc_length_or_zero(farr, 0), 1), 2.5);
+
+    value_t barr = gc_make_bytearray(true, 5, 1, 0, 1, 1, 0);
+    Assert_equals(gc_length_or_zero(barr, 1), 5);
+    Assert_equals(*gc_bytearray_elem(barr, gc_bytearray_base(barr), gc_length_or_zero(barr, 1), 3), 1);
+
+    Assert_equals(gc_length_or_zero(VALUE_NULL, 0), 0);
+    test_array_var = arr;
+    Assert_true(try_and_catch(test_hoisted_array_elem2));
+}
+
+void test_bulk_operations2() {
+    intarray_set(test_array_var, test_array_var, 1);
+}
+
+void test_bulk_operations3() {
+    floatarray_min(test_array_var);
+}
+
+void test_bulk_operations() {
+    ROOT_SET(root_set, 4)
+    for (int32_t n = 0; n <= 20; n++) {
+        value_t a = root_set.values[0] = gc_new_intarray(n, 0);
+        value_t b = root_set.values[1] = gc_new_intarray(n + 1, 3);
+        value_t f = root_set.values[2] = gc_new_floatarray(n, 0.0);
+        value_t u = root_set.values[3] = gc_new_bytearray(false, n, 0);
+        int32_t sum = 0, min = 0, max = 0, dot = 0, square = 0, bsum = 0, bmax = 0;
+        float fsum = 0.0f;
+        for (int32_t i = 0; i < n; i++) {
+            int32_t v = (i * 7) % 11 - 5;
+            *gc_intarray_get(a, i) = v;
+            *gc_floatarray_get(f, i) = v * 0.5f;
+            *gc_bytearray_get(u, i) = (uint8_t)(v * 30);
+            sum += v;
+            dot += v * 3;
+            square += v * v;
+            fsum += v * 0.5f;
+            bsum += (uint8_t)(v * 30);
+            bmax = (uint8_t)(v * 30) > bmax ? (uint8_t)(v * 30) : bmax;
+            min = i == 0 || v < min ? v : min;
+            max = i == 0 || v > max ? v : max;
+        }
+
+        Assert_equals(intarray_sum(a), sum);
+        Assert_equals(intarray_dot(a, b), dot);
+        Assert_fequals(floatarray_sum(f), fsum);
+        Assert_equals(bytearray_sum(u), bsum);
+        if (n > 0) {
+            Assert_equals(intarray_min(a), min);
+            Assert_equals(intarray_max(a), max);
+            Assert_fequals(floatarray_min(f), min * 0.5f);
+            Assert_fequals(floatarray_max(f), max * 0.5f);
+            Assert_equals(bytearray_max(u), bmax);
+        }
+
+        intarray_add(a, b);
+        intarray_scale(a, -2);
+        Assert_equals(intarray_sum(a), -2 * (sum + 3 * n));
+        floatarray_scale(f, 2.0f);
+        Assert_fequals(floatarray_sum(f), 2 * fsum);
+        floatarray_add(f, f);
+        Assert_fequals(floatarray_dot(f, f), 4.0f * square);
+        bytearray_add(u, u);
+        bytearray_scale(u, 3);
+        if (n > 0)
+            Assert_equals(*gc_bytearray_get(u, n - 1), (uint8_t)(((n - 1) * 7 % 11 - 5) * 30 * 6));
+
+        Assert_equals(intarray_fill(b, 9), b);
+        intarray_set(b, a, 1);
+        Assert_equals(*gc_intarray_get(b, 0), 9);
+        Assert_equals(intarray_sum(b), intarray_sum(a) + 9);
+        floatarray_fill(f, 0.25f);
+        Assert_fequals(floatarray_sum(f), 0.25f * n);
+        bytearray_fill(u, 257);
+        Assert_equals(bytearray_sum(u), n);
+    }
+
+    value_t a = root_set.values[0] = gc_make_intarray(3, 1, 2, 3);
+    Assert_equals(gc_dynamic_method_call(a, 15, 0), int_to_value(6));
+    Assert_equals(gc_dynamic_method_call(a, 13, 1, int_to_value(10)), VALUE_UNDEF);
+    Assert_equals(gc_dynamic_method_call(a, 17, 0), int_to_value(30));
+    value_t f = root_set.values[1] = gc_make_floatarray(2, 1.5, -2.0);
+    Assert_fequals(value_to_float(gc_dynamic_method_call(f, 14, 1, f)), 6.25);
+
+    test_array_var = a;
+    Assert_true(try_and_catch(test_bulk_operations2));
+    test_array_var = gc_new_floatarray(0, 0.0);
+    Assert_true(try_and_catch(test_bulk_operations3));
+    DELETE_ROOT_SET(root_set)
+}
+
 void test_string_literal() {
     ROOT_SET(root_set, 2)
     value_t str = gc_new_string("foo");
@@ -182,12 +288,230 @@ void test_string_literal() {
     value_t i = int_to_value(3);
     value_t a = gc_make_array(NULL, 2, VALUE_FALSE, VALUE_NULL);
     root_set.values[1] = a;
-    Assert_true(gc_is_string_literal(str));
-    Assert_true(!gc_is_string_literal(i));
-    Assert_true(!gc_is_string_literal(a));
+    Assert_true(gc_get_class_of(str) == &string_literal.clazz);
+    Assert_true(gc_get_class_of(i) == NULL);
+    Assert_true(gc_get_class_of(a) != &string_literal.clazz);
+    DELETE_ROOT_SET(root_set)
+}
+
+STATIC_STRING(test_static_str, "static", 0xd290c23b);
+
+void test_static_string() {
+    ROOT_SET(root_set, 1)
+    value_t str = STATIC_STRING_VALUE(test_static_str);
+    Assert_true(gc_get_class_of(str) == &string_literal.clazz);
+    Assert_true(!gc_is_heap_object(value_to_ptr(str)));
+    Assert_equals(STATIC_STRING_VALUE(test_static_str), str);
+    Assert_true(strcmp(gc_string_to_cstr(str), "static") == 0);
+    Assert_equals(gc_string_length(str), 6);
+    Assert_equals(gc_string_hash(str), 0xd290c23b);
+    Assert_equals(gc_string_hash(gc_new_string("static")), 0xd290c23b);
+
+    // a static string is reachable from a heap object.
+    root_set.values[0] = gc_make_array(NULL, 2, str, str);
+    gc_run();
+    gc_run();
+    Assert_equals(*gc_array_get(root_set.values[0], 1), str);
+    Assert_true(strcmp(gc_string_to_cstr(*gc_array_get(root_set.values[0], 0)), "static") == 0);
+    DELETE_ROOT_SET(root_set)
+}
+
+static value_t test_static_string_caches[STATIC_STRINGS_NUM + 1];
+
+void test_static_string3() {
+    for (int i = 0; i <= STATIC_STRINGS_NUM; i++)
+        gc_static_string(&test_static_string_caches[i], "static", 6, 0);
+}
+
+void test_static_string2() {
+    // no room for another string literal.
+    uint32_t num = static_strings_num;
+    Assert_true(try_and_catch(test_static_string3));
+    Assert_true(test_static_string_caches[STATIC_STRINGS_NUM - num - 1] != 0);
+    Assert_equals(test_static_string_caches[STATIC_STRINGS_NUM - num], 0);
+    Assert_true(gc_get_class_of(test_static_string_caches[0]) == &string_literal.clazz);
+    static_strings_num = num;
+}
+
+void test_string_equality() {
+    ROOT_SET(root_set, 4)
+    value_t s1 = root_set.values[0] = gc_new_string("hello");
+    value_t s2 = root_set.values[1] = gc_new_String(gc_new_string("hel"), gc_new_string("lo"));
+    value_t s3 = root_set.values[2] = gc_new_String(gc_new_string("hel"), gc_new_string("lp"));
+    value_t s4 = root_set.values[3] = gc_new_String(s1, int_to_value(-12));
+    Assert_equals(gc_string_length(s2), 5);
+    Assert_equals(gc_string_length(s4), 8);
+    Assert_true(strcmp(gc_string_to_cstr(s4), "hello-12") == 0);
+    Assert_true(any_eq(s1, s2));
+    Assert_true(any_eq(s2, s1));
+    Assert_true(!any_eq(s1, s3));
+    Assert_true(!any_eq(s1, s4));
+    Assert_true(!any_eq(s1, int_to_value(1)));
+    Assert_equals(gc_string_hash(s1), gc_string_hash(s2));
+    Assert_true(gc_string_hash(s1) != gc_string_hash(s3));
+
+    Assert_true(string_starts_with(s4, s2));
+    Assert_true(!string_starts_with(s2, s4));
+    Assert_true(string_ends_with(s2, gc_new_string("llo")));
+    Assert_true(!string_ends_with(s2, gc_new_string("hhello")));
+    value_t s5 = string_substring(s4, 2, 6);
+    Assert_equals(gc_string_length(s5), 4);
+    Assert_true(strcmp(gc_string_to_cstr(s5), "llo-") == 0);
+    DELETE_ROOT_SET(root_set)
+}
+
+void test_string_rope() {
+    ROOT_SET(root_set, 3)
+    value_t s = root_set.values[0] = gc_new_string("");
+    for (int i = 0; i < 100; i++)
+        s = root_set.values[0] = gc_new_String(s, int_to_value(i % 10));
+
+    Assert_true(gc_is_string_rope(s));
+    Assert_equals(gc_string_length(s), 100);
+    value_t t = root_set.values[1] = gc_new_String(gc_new_string("x"), s);
+    Assert_equals(gc_string_length(t), 101);
+    Assert_true(gc_is_string_rope(t));
+    Assert_true(!gc_is_string_rope(value_to_ptr(t)->body[ROPE_RIGHT_INDEX]));
+    gc_run();
+
+    char buf[128];
+    gc_any_to_cstring(buf, t);
+    Assert_true(gc_is_string_rope(t));
+    Assert_true(strncmp(buf, "x0123456789012", 14) == 0);
+    Assert_equals(strlen(buf), 101);
+
+    const char* cstr = gc_string_to_cstr(s);
+    Assert_true(!gc_is_string_rope(s));
+    Assert_true(gc_is_string_object(s));
+    Assert_equals(strlen(cstr), 100);
+    Assert_true(strcmp(cstr + 90, "0123456789") == 0);
+    Assert_true(strcmp(gc_string_to_cstr(t), buf) == 0);
+    Assert_true(string_ends_with(t, s));
+
+    value_t u = root_set.values[2] = gc_new_String(gc_new_string("x"), s);
+    Assert_true(any_eq(t, u));
+    Assert_true(!any_less(t, u));
+    Assert_true(string_starts_with(u, gc_new_string("x012")));
+    DELETE_ROOT_SET(root_set)
+}
+
+void test_string_slice() {
+    ROOT_SET(root_set, 4)
+    value_t s = root_set.values[0] = gc_new_String(gc_new_string("set led "), int_to_value(12345));
+    value_t s1 = root_set.values[1] = string_substring(s, 4, 7);
+    value_t s2 = root_set.values[2] = string_substring(s, 8, -1);
+    value_t s3 = root_set.values[3] = string_substring(s2, 1, 3);
+    Assert_true(gc_get_class_of(s1) == &string_slice.clazz);
+    Assert_equals(value_to_ptr(s3)->body[SLICE_OFFSET_INDEX], 9);
+    Assert_true(value_to_ptr(s3)->body[SLICE_PARENT_INDEX] == s);
+    Assert_equals(gc_string_length(s1), 3);
+    Assert_equals(gc_string_length(s3), 2);
+    Assert_true(any_eq(s1, gc_new_string("led")));
+    Assert_true(any_less(s1, gc_new_string("lee")));
+    Assert_true(any_greater(s1, gc_new_string("le")));
+    Assert_true(string_starts_with(s2, gc_new_string("123")));
+    Assert_true(string_ends_with(s1, gc_new_string("ed")));
+    Assert_true(!string_ends_with(s1, gc_new_string("led ")));
+
+    char buf[32];
+    gc_any_to_cstring(buf, gc_new_String(s1, s3));
+    Assert_true(strcmp(buf, "led23") == 0);
+    gc_run();
+
+    // s2 ends at the end of s.  It is not materialized.
+    Assert_true(strcmp(gc_string_to_cstr(s2), "12345") == 0);
+    Assert_true(value_to_ptr(s2)->body[SLICE_PARENT_INDEX] == s);
+    Assert_true(strcmp(gc_string_to_cstr(s1), "led") == 0);
+    Assert_true(value_to_ptr(s1)->body[SLICE_PARENT_INDEX] != s);
+    Assert_true(strcmp(gc_string_to_cstr(s3), "23") == 0);
+    Assert_true(strcmp(gc_string_to_cstr(string_substring(gc_new_string("abc"), 1, 9)), "bc") == 0);
     DELETE_ROOT_SET(root_set)
 }
 
+void test_bytes_of() {
+    ROOT_SET(root_set, 3)
+    int32_t len;
+    value_t s = root_set.values[0] = gc_new_String(gc_new_string("0123456789abcdefghijklmnopqrstuv"), gc_new_string("wxyz"));
+    Assert_true(gc_is_string_rope(s));
+    const uint8_t* p = gc_bytes_of(s, &len);
+    Assert_true(!gc_is_string_rope(s));
+    Assert_equals(len, 36);
+    Assert_true(memcmp(p + 32, "wxyz", 4) == 0);
+
+    // a slice shares the characters with its parent.
+    value_t s1 = root_set.values[1] = string_substring(s, 30, 33);
+    Assert_true(gc_bytes_of(s1, &len) == p + 30);
+    Assert_equals(len, 3);
+
+    value_t u = root_set.values[2] = gc_make_bytearray(false, 3, 7, 8, 9);
+    p = gc_bytes_of(u, &len);
+    Assert_equals(len, 3);
+    Assert_equals(p[2], 9);
+    Assert_true(p == gc_bytearray_base(u));
+    Assert_true(gc_bytes_of(int_to_value(3), &len) == NULL);
+    Assert_true(gc_bytes_of(gc_make_bytearray(true, 1, 1), &len) == NULL);
+    DELETE_ROOT_SET(root_set)
+}
+
+void test_string_builder() {
+    ROOT_SET(root_set, 2)
+    value_t sb = root_set.values[0] = gc_new_string_builder();
+    for (int i = 0; i < 50; i++) {
+        gc_string_builder_append(sb, gc_new_string("ab"));
+        gc_dynamic_method_call(sb, 8, 1, int_to_value(i % 10));
+    }
+
+    gc_run();
+    value_t s = root_set.values[1] = gc_string_builder_to_string(sb);
+    Assert_equals(gc_string_length(s), 150);
+    Assert_true(strncmp(gc_string_to_cstr(s), "ab0ab1ab2", 9) == 0);
+    Assert_true(strcmp(gc_string_to_cstr(s) + 144, "ab8ab9") == 0);
+    gc_string_builder_append(sb, VALUE_TRUE);
+    Assert_equals(gc_string_length(gc_dynamic_method_call(sb, 9, 0)), 154);
+    Assert_equals(gc_string_length(s), 150);
+    DELETE_ROOT_SET(root_set)
+}
+
+void test_number_to_string() {
+    char buf[NUMBER_STRING_SIZE], buf2[NUMBER_STRING_SIZE];
+    gc_int_to_cstring(buf, 0);
+    Assert_true(strcmp(buf, "0") == 0);
+    Assert_equals(gc_int_to_cstring(buf, -2147483647 - 1) - buf, 11);
+    Assert_true(strcmp(buf, "-2147483648") == 0);
+    gc_int_to_cstring(buf, 1000900);
+    Assert_true(strcmp(buf, "1000900") == 0);
+
+    const struct { float f; const char* shortest; const char* fixed; } floats[] = {
+        { 0.0f, "0.0", "0.000000" }, { 3.0f, "3.0", "3.000000" }, { -3.5f, "-3.5", "-3.500000" },
+        { 0.1f, "0.1", "0.100000" }, { 1.0f / 3, "0.33333334", "0.333333" }, { 1200.0f, "1200.0", "1200.000000" },
+        { 0.0078125f, "0.0078125", "0.007812" }, { 1.0e-7f, "0.0000001", "0.000000" },
+        { 4.0e9f, "4000000000.0", "4000000000.000000" }, { 16777217.0f, "16777216.0", "16777216.000000" } };
+    for (int i = 0; i < sizeof(floats) / sizeof(floats[0]); i++) {
+        gc_float_to_cstring(buf, floats[i].f);
+        Assert_true(strcmp(buf, floats[i].shortest) == 0);
+        gc_float_to_fixed_cstring(buf, floats[i].f);
+        Assert_true(strcmp(buf, floats[i].fixed) == 0);
+    }
+
+    // the shortest representation is read back as the same float,
+    // and the fixed one is the same as printf("%f").
+    uint32_t seed = 1;
+    for (int i = 0; i < 100000; i++) {
+        seed = seed * 1103515245 + 12345;
+        float f = value_to_float(float_to_value((float)(int32_t)seed / (float)(1 << (seed % 31))));
+        char* end = gc_float_to_cstring(buf, f);
+        Assert_equals(end - buf, strlen(buf));
+        Assert_fequals(strtof(buf, NULL), f);
+        gc_float_to_fixed_cstring(buf, f);
+        sprintf(buf2, "%f", f);
+        Assert_true(strcmp(buf, buf2) == 0);
+    }
+
+    Assert_true(strcmp(gc_string_to_cstr(gc_new_String(gc_new_string("x"), float_to_value(2.5))), "x2.5") == 0);
+    Assert_true(strcmp(gc_string_to_cstr(gc_new_String(int_to_value(-12), gc_new_string("y"))), "-12y") == 0);
+    Assert_equals(gc_string_length(float_to_value(0.25)), 4);
+}
+
 static int32_t test_function_object00(int32_t v) {
     return v + 1;
 }
@@ -284,13 +608,25 @@ void test_is_subtype_of() {
     Assert_true(sig == sig11 + 8);
 }
 
+// the k-th slot counted from the first element of the ring buffer in an array.
+static value_t* array_vec_slot(value_t arr, int k) {
+    pointer_t arrp = value_to_ptr(arr);
+    value_t vec = arrp->body[2];
+    return fast_fixedarray_get(vec, (arrp->body[1] + k) % gc_fixedarray_length(vec));
+}
+
+static int array_capacity_of(value_t arr) {
+    return gc_fixedarray_length(value_to_ptr(arr)->body[2]);
+}
+
 void test_array_push() {
     ROOT_SET(root_set, 1)
     for (int i = 0; i < 16; i++) {
         int real_len = real_array_length(i);
         value_t arr = gc_new_array(&anyarray_object.clazz, i, int_to_value(i));
-        value_t arrvec = value_to_ptr(arr)->body[1];
+        value_t arrvec = value_to_ptr(arr)->body[2];
         Assert_equals(gc_array_length(arr), i);
+        Assert_equals(value_to_ptr(arr)->body[1], 0);
         Assert_equals(gc_fixedarray_length(arrvec), real_len);
         Assert_equals(value_to_ptr(arrvec)->body[0], real_len);
         for (int j = 0; j < i; j++)
@@ -300,22 +636,21 @@ void test_array_push() {
         if (i > 0)
             gc_array_set(arr, 0, int_to_value(70 + i));
         Assert_equals(value_to_ptr(arr)->body[0], i);
-        Assert_true(value_to_ptr(value_to_ptr(arr)->body[1])->body[0] >= i);
+        Assert_true(array_capacity_of(arr) >= i);
 
         for (int j = 0; j < 10; j++) {
             Assert_equals(gc_array_push(arr, int_to_value(90 + j)), i + j + 1);
             Assert_equals(gc_array_length(arr), i + j + 1);
-            value_t vec = value_to_ptr(arr)->body[1];
-            int len = value_to_ptr(vec)->body[0];
+            int len = array_capacity_of(arr);
             if (i > 0)
-                Assert_equals(*fast_fixedarray_get(vec, 0), int_to_value(70 + i));
+                Assert_equals(*array_vec_slot(arr, 0), int_to_value(70 + i));
             for (int k = 1; k < i; k++)
-                Assert_equals(*fast_fixedarray_get(vec, k), int_to_value(i));
+                Assert_equals(*array_vec_slot(arr, k), int_to_value(i));
 
             Assert_true(len >= i + j + 1);
-            Assert_equals(*fast_fixedarray_get(vec, i + j), int_to_value(90 + j));
+            Assert_equals(*array_vec_slot(arr, i + j), int_to_value(90 + j));
             for (int k = i + j + 1; k < len; k++)
-                Assert_equals(*fast_fixedarray_get(vec, k), VALUE_UNDEF);
+                Assert_equals(*array_vec_slot(arr, k), VALUE_UNDEF);
         }
     }
 
@@ -324,20 +659,18 @@ void test_array_push() {
 
 void test_array_pop() {
     for (int i = 0; i < 16; i++) {
-        int real_len = real_array_length(i);
         value_t arr = gc_new_array(&anyarray_object.clazz, i, int_to_value(i));
         for (int j = 0; j < i; j++)
             gc_array_set(arr, j, int_to_value(100 + j));
         for (int j = 0; j < i; j++) {
             Assert_equals(gc_array_pop(arr), int_to_value(100 + i - j - 1));
             Assert_equals(gc_array_length(arr), i - j - 1);
-            value_t vec = value_to_ptr(arr)->body[1];
-            int len = value_to_ptr(vec)->body[0];
+            int len = array_capacity_of(arr);
             for (int k = 0; k < i - j - 1; k++)
-                Assert_equals(*fast_fixedarray_get(vec, k), int_to_value(100 + k));
+                Assert_equals(*array_vec_slot(arr, k), int_to_value(100 + k));
             Assert_true(len >= i - j - 1);
             for (int k = i - j - 1; k < len; k++)
-                Assert_equals(*fast_fixedarray_get(vec, k), VALUE_UNDEF);
+                Assert_equals(*array_vec_slot(arr, k), VALUE_UNDEF);
         }
         Assert_equals(gc_array_length(arr), 0);
         Assert_equals(gc_array_pop(arr), VALUE_UNDEF);
@@ -347,44 +680,40 @@ void test_array_pop() {
 
 void test_array_unshift() {
     for (int i = 0; i < 16; i++) {
-        int real_len = real_array_length(i);
         value_t arr = gc_new_array(&anyarray_object.clazz, i, int_to_value(i));
         for (int j = 0; j < i; j++)
             gc_array_set(arr, j, int_to_value(100 + j));
         for (int j = 0; j < 10; j++) {
             Assert_equals(gc_array_unshift(arr, int_to_value(90 + j)), i + j + 1);
             Assert_equals(gc_array_length(arr), i + j + 1);
-            value_t vec = value_to_ptr(arr)->body[1];
-            int len = value_to_ptr(vec)->body[0];
+            int len = array_capacity_of(arr);
             for (int k = 0; k < j + 1; k++)
-                Assert_equals(*fast_fixedarray_get(vec, k), int_to_value(90 + j - k));
+                Assert_equals(*gc_array_get(arr, k), int_to_value(90 + j - k));
 
             for (int k = j + 1; k < i + j + 1; k++)
-                Assert_equals(*fast_fixedarray_get(vec, k), int_to_value(100 + k - j - 1));
+                Assert_equals(*gc_array_get(arr, k), int_to_value(100 + k - j - 1));
 
             Assert_true(len >= i + j + 1);
             for (int k = i + j + 1; k < len; k++)
-                Assert_equals(*fast_fixedarray_get(vec, k), VALUE_UNDEF);
+                Assert_equals(*array_vec_slot(arr, k), VALUE_UNDEF);
         }
     }
 }
 
 void test_array_shift() {
     for (int i = 0; i < 16; i++) {
-        int real_len = real_array_length(i);
         value_t arr = gc_new_array(&anyarray_object.clazz, i, int_to_value(i));
         for (int j = 0; j < i; j++)
             gc_array_set(arr, j, int_to_value(100 + j));
         for (int j = 0; j < i; j++) {
             Assert_equals(gc_array_shift(arr), int_to_value(100 + j));
             Assert_equals(gc_array_length(arr), i - j - 1);
-            value_t vec = value_to_ptr(arr)->body[1];
-            int len = value_to_ptr(vec)->body[0];
+            int len = array_capacity_of(arr);
             for (int k = 0; k < i - j - 1; k++)
-                Assert_equals(*fast_fixedarray_get(vec, k), int_to_value(100 + k + j + 1));
+                Assert_equals(*gc_array_get(arr, k), int_to_value(100 + k + j + 1));
             Assert_true(len >= i - j - 1);
             for (int k = i - j - 1; k < len; k++)
-                Assert_equals(*fast_fixedarray_get(vec, k), VALUE_UNDEF);
+                Assert_equals(*array_vec_slot(arr, k), VALUE_UNDEF);
         }
         Assert_equals(gc_array_length(arr), 0);
         Assert_equals(gc_array_shift(arr), VALUE_UNDEF);
@@ -392,6 +721,513 @@ void test_array_shift() {
     }
 }
 
+// an array used as a queue.  push() and shift() wrap around the ring buffer.
+void test_array_queue() {
+    ROOT_SET(root_set, 1)
+    value_t arr = root_set.values[0] = gc_new_array(&anyarray_object.clazz, 0, VALUE_UNDEF);
+    int capacity = array_capacity_of(arr);
+    int next = 0, first = 0;
+    for (int round = 0; round < 100; round++) {
+        while (gc_array_length(arr) < capacity - 2)
+            gc_array_push(arr, int_to_value(next++));
+
+        for (int k = 0; k < 3; k++)
+            Assert_equals(gc_array_shift(arr), int_to_value(first++));
+    }
+
+    while (gc_array_length(arr) < capacity - 2)
+        gc_array_push(arr, int_to_value(next++));
+
+    // the ring buffer has never been reallocated.
+    Assert_equals(array_capacity_of(arr), capacity);
+    Assert_true(value_to_ptr(arr)->body[1] != 0);
+    for (int k = 0; k < gc_array_length(arr); k++)
+        Assert_equals(*gc_array_get(arr, k), int_to_value(first + k));
+
+    // unshift() after the ring buffer wraps around.
+    gc_array_unshift(arr, int_to_value(-1));
+    gc_array_unshift(arr, int_to_value(-2));
+    Assert_equals(*gc_array_get(arr, 0), int_to_value(-2));
+    Assert_equals(*gc_array_get(arr, 2), int_to_value(first));
+    Assert_equals(gc_array_length(arr), capacity);
+    gc_array_push(arr, int_to_value(next));        // this makes the array grow.
+    Assert_true(array_capacity_of(arr) > capacity);
+    Assert_equals(value_to_ptr(arr)->body[1], 0);
+    Assert_equals(*gc_array_get(arr, 1), int_to_value(-1));
+    Assert_equals(*gc_array_get(arr, capacity), int_to_value(next));
+
+    DELETE_ROOT_SET(root_set)
+}
+
+// the capacity grows geometrically and shrinks when the array becomes sparse.
+void test_array_growth() {
+    ROOT_SET(root_set, 1)
+    value_t arr = root_set.values[0] = gc_new_array(&anyarray_object.clazz, 0, VALUE_UNDEF);
+    int reallocations = 0;
+    int capacity = array_capacity_of(arr);
+    for (int i = 0; i < 1000; i++) {
+        gc_array_push(arr, int_to_value(i));
+        if (array_capacity_of(arr) != capacity) {
+            Assert_true(array_capacity_of(arr) >= capacity + capacity / 2);
+            capacity = array_capacity_of(arr);
+            reallocations++;
+        }
+    }
+
+    Assert_true(reallocations < 15);
+    for (int i = 0; i < 1000; i++)
+        Assert_equals(*gc_array_get(arr, i), int_to_value(i));
+
+    for (int i = 999; i >= 10; i--)
+        Assert_equals(gc_array_pop(arr), int_to_value(i));
+
+    Assert_true(array_capacity_of(arr) < ARRAY_MIN_SHRINK);
+    for (int i = 0; i < 10; i++)
+        Assert_equals(*gc_array_get(arr, i), int_to_value(i));
+
+    for (int i = 0; i < 10; i++)
+        Assert_equals(gc_array_shift(arr), int_to_value(i));
+
+    Assert_equals(gc_array_length(arr), 0);
+    DELETE_ROOT_SET(root_set)
+}
+
+static int32_t growable_capacity_of(value_t arr) {
+    pointer_t storage = value_to_ptr(value_to_ptr(arr)->body[2]);
+    return gc_is_instance_of(&class_Uint8Array.clazz, arr) ? storage->body[1] : storage->body[0];
+}
+
+void test_growable_array2() {
+    growable_intarray_pop(test_array_var);
+}
+
+void test_growable_array3() {
+    fixed_intarray_push(test_array_var, 1);
+}
+
+void test_growable_array() {
+    ROOT_SET(root_set, 4)
+    value_t a = root_set.values[0] = gc_new_growable_array(gc_make_intarray(2, 7, 8));
+    value_t f = root_set.values[1] = gc_new_growable_array(gc_new_floatarray(0, 0.0));
+    value_t u = root_set.values[2] = gc_new_growable_array(gc_new_bytearray(false, 0, 0));
+    Assert_true(gc_is_intarray(a));
+    Assert_true(gc_is_instance_of(&intarray_object.clazz, a));
+    Assert_true(gc_is_floatarray(f));
+    Assert_equals(gc_intarray_length(a), 2);
+    Assert_equals(gc_bytearray_length(u), 0);
+
+    int reallocations = 0;
+    int capacity = growable_capacity_of(a);
+    for (int32_t i = 0; i < 300; i++) {
+        Assert_equals(growable_intarray_push(a, i * 3), i + 3);
+        Assert_equals(growable_floatarray_push(f, i * 0.5f), i + 1);
+        Assert_equals(growable_bytearray_push(u, i), i + 1);
+        if (growable_capacity_of(a) != capacity) {
+            Assert_true(growable_capacity_of(a) >= capacity + capacity / 2);
+            capacity = growable_capacity_of(a);
+            reallocations++;
+        }
+    }
+
+    Assert_true(reallocations < 15);
+    Assert_equals(gc_intarray_length(a), 302);
+    Assert_equals(gc_floatarray_length(f), 300);
+    Assert_equals(gc_bytearray_length(u), 300);
+    Assert_equals(get_all_array_length(u), 300);
+    Assert_equals(*gc_intarray_get(a, 1), 8);
+    Assert_equals(*gc_intarray_get(a, 12), 30);
+    Assert_equals(gc_safe_array_get(a, 12), int_to_value(30));
+    Assert_fequals(*gc_floatarray_get(f, 299), 149.5f);
+    Assert_equals(*gc_bytearray_get(u, 260), 260 & 0xff);
+    Assert_equals(gc_intarray_base(a)[2], 0);
+    Assert_fequals(gc_floatarray_base(f)[3], 1.5f);
+    Assert_equals(gc_bytearray_base(u)[299], 299 & 0xff);
+    Assert_equals(gc_fixed_length_or_zero(a, 0), 0);
+    Assert_equals(gc_length_or_zero(a, 0), 302);
+    Assert_equals(gc_length_or_zero(u, 1), 300);
+
+    // bulk operations on a growable array
+    Assert_equals(intarray_sum(a), 7 + 8 + 3 * 299 * 300 / 2);
+    Assert_fequals(floatarray_max(f), 149.5f);
+    value_t b = root_set.values[3] = gc_copy_intarray(a);
+    Assert_equals(gc_fixed_length_or_zero(b, 0), 302);
+    Assert_equals(*gc_intarray_get(b, 301), 897);
+    int32_t len;
+    Assert_equals(gc_bytes_of(u, &len)[255], 255);
+    Assert_equals(len, 300);
+
+    for (int32_t i = 299; i >= 5; i--) {
+        Assert_equals(growable_intarray_pop(a), i * 3);
+        Assert_fequals(growable_floatarray_pop(f), i * 0.5f);
+        Assert_equals(growable_bytearray_pop(u), i & 0xff);
+    }
+
+    Assert_true(growable_capacity_of(a) < ARRAY_MIN_SHRINK);
+    Assert_true(growable_capacity_of(u) < ARRAY_MIN_SHRINK);
+    Assert_equals(gc_intarray_length(a), 7);
+    Assert_equals(*gc_intarray_get(a, 6), 12);
+    Assert_fequals(*gc_floatarray_get(f, 4), 2.0f);
+    Assert_equals(gc_safe_array_set(u, 4, int_to_value(260)), int_to_value(4));
+    Assert_equals(gc_bytearray_length(u), 5);
+
+    test_array_var = gc_new_growable_array(gc_new_intarray(0, 0));
+    Assert_true(try_and_catch(test_growable_array2));
+    test_array_var = b;
+    Assert_true(try_and_catch(test_growable_array3));
+    DELETE_ROOT_SET(root_set)
+}
+
+STATIC_INTARRAY(test_readonly_ints, 4, 10, 20, -30, 40);
+STATIC_FLOATARRAY(test_readonly_floats, 2, 1.5, 2.5);
+
+void test_readonly_array2() {
+    *gc_intarray_lval(test_array_var, 1) = 7;
+}
+
+void test_readonly_array3() {
+    gc_safe_array_set(test_array_var, 0, float_to_value(3.0));
+}
+
+void test_readonly_array4() {
+    ((value_t (*)(value_t, int32_t))gc_method_lookup(test_array_var, 0))(test_array_var, 0);
+}
+
+static value_t test_static_array_caches[STATIC_ARRAYS_NUM + 1];
+
+void test_readonly_array5() {
+    const int32_t elements[] = { 1, 2 };
+    for (int i = 0; i <= STATIC_ARRAYS_NUM; i++)
+        gc_static_intarray(&test_static_array_caches[i], 2, elements);
+}
+
+void test_readonly_array() {
+    ROOT_SET(root_set, 2)
+    value_t a = root_set.values[0] = STATIC_ARRAY_VALUE(test_readonly_ints);
+    value_t f = root_set.values[1] = STATIC_ARRAY_VALUE(test_readonly_floats);
+    Assert_equals(STATIC_ARRAY_VALUE(test_readonly_ints), a);
+    Assert_true(gc_is_intarray(a));
+    Assert_true(gc_is_floatarray(f));
+    gc_run();
+    Assert_equals(gc_intarray_length(a), 4);
+    Assert_equals(*gc_intarray_get(a, 2), -30);
+    Assert_equals(value_to_int(gc_safe_array_get(a, 3)), 40);
+    Assert_fequals(*gc_floatarray_get(f, 1), 2.5);
+    Assert_equals(((int32_t (*)(value_t))gc_method_lookup(a, 5))(a), 40);
+    Assert_equals(gc_length_or_zero(a, 0), 4);
+    Assert_equals(gc_fixed_length_or_zero(a, 0), 4);
+    Assert_equals(gc_writable_length_or_zero(a, 0), 0);
+
+    value_t b = gc_copy_intarray(a);
+    *gc_intarray_lval(b, 1) = 7;
+    Assert_equals(*gc_intarray_get(b, 1), 7);
+    Assert_equals(gc_writable_length_or_zero(b, 0), 4);
+
+    test_array_var = a;
+    Assert_true(try_and_catch(test_readonly_array2));
+    Assert_true(try_and_catch(test_readonly_array4));
+    test_array_var = f;
+    Assert_true(try_and_catch(test_readonly_array3));
+    Assert_equals(*gc_intarray_get(a, 1), 20);
+    Assert_fequals(*gc_floatarray_get(f, 0), 1.5);
+
+    // no room for another constant array.
+    uint32_t num = static_arrays_num, used = static_arrays_used;
+    Assert_true(try_and_catch(test_readonly_array5));
+    Assert_true(test_static_array_caches[STATIC_ARRAYS_NUM - num - 1] != 0);
+    Assert_equals(test_static_array_caches[STATIC_ARRAYS_NUM - num], 0);
+    Assert_true(gc_get_class_of(test_static_array_caches[0]) == &readonly_intarray.clazz);
+    static_arrays_num = num;
+    static_arrays_used = used;
+    DELETE_ROOT_SET(root_set)
+}
+
+void test_hash_tables2() {
+    intintmap_get(test_array_var, 5000);
+}
+
+void test_hash_tables() {
+    ROOT_SET(root_set, 4)
+    value_t m = root_set.values[0] = gc_new_hash_table(&class_IntIntMap.clazz);
+    for (int i = -150; i < 150; i++) {
+        Assert_equals(intintmap_set(m, i * 7, i), m);
+        if (i == 45) {
+            // the elements are being moved from the old table.
+            Assert_true(value_to_ptr(m)->body[HT_OLD_TABLE] != VALUE_UNDEF);
+            Assert_equals(intintmap_get(m, -150 * 7), -150);
+            gc_run();
+        }
+    }
+
+    Assert_equals(*get_obj_int_property(m, HT_SIZE), 300);
+    Assert_equals(intintmap_get(m, 21), 3);
+    Assert_equals(intintmap_get(m, -1050), -150);
+    Assert_true(!intkey_has(m, 22));
+    for (int i = -150; i < 150; i += 2)
+        Assert_true(intkey_delete(m, i * 7));
+
+    Assert_true(!intkey_delete(m, 0));
+    Assert_equals(*get_obj_int_property(m, HT_SIZE), 150);
+    for (int i = -150; i < 150; i++)
+        Assert_equals(intkey_has(m, i * 7), i % 2 != 0);
+
+    intintmap_set(m, 21, 33);
+    Assert_equals(((int32_t (*)(value_t, int32_t))gc_method_lookup(m, 1))(m, 21), 33);
+    Assert_equals(gc_dynamic_method_call(m, 18, 1, int_to_value(21)), int_to_value(33));
+    test_array_var = m;
+    Assert_true(try_and_catch(test_hash_tables2));
+    hash_table_clear(m);
+    Assert_equals(*get_obj_int_property(m, HT_SIZE), 0);
+    Assert_true(!intkey_has(m, 21));
+
+    value_t f = root_set.values[1] = gc_new_hash_table(&class_IntFloatMap.clazz);
+    intfloatmap_set(f, 3, 1.5f);
+    intfloatmap_set(f, -3, -2.25f);
+    Assert_fequals(intfloatmap_get(f, 3), 1.5f);
+    Assert_fequals(value_to_float(gc_dynamic_method_call(f, 18, 1, int_to_value(-3))), -2.25f);
+
+    value_t s = root_set.values[2] = gc_new_hash_table(&class_StringAnyMap.clazz);
+    for (int i = 0; i < 60; i++) {
+        root_set.values[3] = gc_new_String(gc_new_string("key"), int_to_value(i));
+        stringanymap_set(s, root_set.values[3], gc_new_String(gc_new_string("v"), int_to_value(i)));
+    }
+
+    gc_run();
+    Assert_equals(*get_obj_int_property(s, HT_SIZE), 60);
+    value_t key = root_set.values[3] = gc_new_String(gc_new_string("key"), int_to_value(42));
+    Assert_true(strcmp(gc_string_to_cstr(stringanymap_get(s, key)), "v42") == 0);
+    Assert_equals(stringanymap_get(s, gc_new_string("key60")), VALUE_UNDEF);
+    Assert_true(stringkey_delete(s, gc_new_string("key7")));
+    Assert_true(!stringkey_has(s, gc_new_string("key7")));
+    Assert_equals(gc_dynamic_method_call(s, 19, 1, gc_new_string("key8")), VALUE_TRUE);
+
+    value_t set = root_set.values[1] = gc_new_hash_table(&class_StringSet.clazz);
+    stringset_add(set, gc_new_string("a"));
+    stringset_add(set, gc_new_string("a"));
+    gc_dynamic_method_call(set, 12, 1, gc_new_string("b"));
+    Assert_equals(*get_obj_int_property(set, HT_SIZE), 2);
+    Assert_true(stringkey_has(set, gc_new_string("b")));
+    Assert_true(!stringkey_has(set, gc_new_string("c")));
+    DELETE_ROOT_SET(root_set)
+}
+
+void test_array_sort2() {
+    ((value_t (*)(value_t))gc_method_lookup(test_array_var, 10))(test_array_var);
+}
+
+static int test_compare_calls = 0;
+
+// compares the first elements of two integer arrays by their tens digits.
+// It sometimes runs the garbage collector.
+static int32_t test_compare_tens(value_t self, value_t a, value_t b) {
+    if (++test_compare_calls % 64 == 0)
+        gc_run();
+
+    return *gc_intarray_get(a, 0) / 10 - *gc_intarray_get(b, 0) / 10;
+}
+
+static int32_t test_compare_ints(value_t self, value_t a, value_t b) {
+    return value_to_int(a) - value_to_int(b);
+}
+
+void test_array_sort() {
+    ROOT_SET(root_set, 4)
+    value_t a = root_set.values[0] = gc_new_intarray(300, 0);
+    uint32_t seed = 7;
+    for (int i = 0; i < 300; i++) {
+        seed = seed * 1103515245 + 12345;
+        *gc_intarray_get(a, i) = (int32_t)(seed >> 8) % 100;
+    }
+
+    int32_t sum = intarray_sum(a);
+    Assert_equals(intarray_sort(a), a);
+    Assert_equals(intarray_sum(a), sum);
+    for (int i = 1; i < 300; i++)
+        Assert_true(*gc_intarray_get(a, i - 1) <= *gc_intarray_get(a, i));
+
+    int32_t k = intarray_binary_search(a, *gc_intarray_get(a, 150));
+    Assert_equals(*gc_intarray_get(a, k), *gc_intarray_get(a, 150));
+    Assert_equals(intarray_binary_search(a, -1000), -1);
+    Assert_equals(intarray_binary_search(a, 1000), -301);
+    Assert_equals(intarray_index_of(a, *gc_intarray_get(a, 0)), 0);
+    Assert_equals(intarray_index_of(a, 1000), -1);
+    intarray_reverse(a);
+    Assert_true(*gc_intarray_get(a, 0) >= *gc_intarray_get(a, 299));
+
+    // heapsort, which introsort falls back to.
+    int32_heap_sort(intarray_elements(a), 300);
+    for (int i = 1; i < 300; i++)
+        Assert_true(*gc_intarray_get(a, i - 1) <= *gc_intarray_get(a, i));
+
+    value_t f = root_set.values[1] = gc_new_floatarray(40, 0.0);
+    for (int i = 0; i < 40; i++)
+        *gc_floatarray_get(f, i) = i == 7 ? NAN : (float)((i * 17) % 40) - 20.5f;
+
+    floatarray_sort(f);
+    Assert_fequals(*gc_floatarray_get(f, 0), -20.5f);
+    Assert_true(isnan(*gc_floatarray_get(f, 39)));
+    Assert_equals(floatarray_binary_search(f, -19.5f), 1);
+    Assert_equals(floatarray_binary_search(f, -20.0f), -2);
+    Assert_equals(floatarray_index_of(f, NAN), -1);
+
+    value_t u = root_set.values[2] = gc_new_bytearray(false, 100, 0);
+    for (int i = 0; i < 100; i++)
+        *gc_bytearray_get(u, i) = (uint8_t)(i * 77);
+
+    Assert_equals(((value_t (*)(value_t))gc_method_lookup(u, 10))(u), u);
+    for (int i = 1; i < 100; i++)
+        Assert_true(*gc_bytearray_get(u, i - 1) <= *gc_bytearray_get(u, i));
+
+    Assert_equals(bytearray_binary_search(u, *gc_bytearray_get(u, 50)) >= 0, true);
+    Assert_equals(bytearray_index_of(u, 300), -1);
+
+    test_array_var = STATIC_ARRAY_VALUE(test_readonly_ints);
+    Assert_true(try_and_catch(test_array_sort2));
+    Assert_equals(intarray_index_of(test_array_var, -30), 2);
+
+    // an array of objects.  Its first element is not at the beginning of the fixed array.
+    value_t arr = root_set.values[1] = gc_new_array(&anyarray_object.clazz, 0, VALUE_UNDEF);
+    for (int i = 0; i < 10; i++)
+        gc_array_push(arr, VALUE_UNDEF);
+
+    for (int i = 0; i < 100; i++) {
+        root_set.values[2] = gc_new_intarray(1, (i * 37) % 100);
+        gc_array_push(arr, root_set.values[2]);
+    }
+
+    for (int i = 0; i < 10; i++)
+        gc_array_shift(arr);
+
+    value_t cmp = root_set.values[3] = gc_new_function(test_compare_tens, "(aa)i", VALUE_UNDEF);
+    Assert_equals(((value_t (*)(value_t, value_t))gc_method_lookup(arr, 4))(arr, cmp), arr);
+    Assert_true(test_compare_calls > 64);
+    for (int i = 1; i < 100; i++) {
+        int32_t x = *gc_intarray_get(*gc_array_get(arr, i - 1), 0);
+        int32_t y = *gc_intarray_get(*gc_array_get(arr, i), 0);
+        Assert_true(x / 10 <= y / 10);
+        if (x / 10 == y / 10)   // stable sort
+            Assert_equals((x * 73) % 100 < (y * 73) % 100, true);
+    }
+
+    root_set.values[2] = gc_new_intarray(1, 55);
+    int32_t found = gc_array_binary_search(arr, root_set.values[2], cmp);
+    Assert_equals(*gc_intarray_get(*gc_array_get(arr, found), 0) / 10, 5);
+    root_set.values[2] = *gc_array_get(arr, 42);
+    Assert_equals(gc_array_index_of(arr, root_set.values[2]), 42);
+    Assert_equals(gc_array_reverse(arr), arr);
+    Assert_equals(gc_array_index_of(arr, root_set.values[2]), 57);
+
+    arr = root_set.values[1] = gc_new_array(&anyarray_object.clazz, 0, VALUE_UNDEF);
+    for (int i = 0; i < 30; i++) {
+        gc_array_unshift(arr, int_to_value(i % 7));
+        gc_array_push(arr, gc_new_String(gc_new_string("s"), int_to_value(i)));
+    }
+
+    Assert_equals(gc_array_index_of(arr, gc_new_string("s12")), 42);
+    Assert_equals(gc_array_index_of(arr, int_to_value(6)), 2);
+    Assert_equals(gc_dynamic_method_call(arr, 24, 1, gc_new_string("s30")), int_to_value(-1));
+    for (int i = 0; i < 30; i++)
+        gc_array_pop(arr);
+
+    cmp = root_set.values[3] = gc_new_function(test_compare_ints, "(aa)i", VALUE_UNDEF);
+    gc_dynamic_method_call(arr, 22, 1, cmp);
+    for (int i = 1; i < 30; i++)
+        Assert_true(value_to_int(*gc_array_get(arr, i - 1)) <= value_to_int(*gc_array_get(arr, i)));
+
+    Assert_equals(gc_array_binary_search(arr, int_to_value(7), cmp), -31);
+    DELETE_ROOT_SET(root_set)
+}
+
+void test_compact_arrays2() {
+    gc_int16array_get(test_array_var, 3);
+}
+
+void test_compact_arrays() {
+    ROOT_SET(root_set, 4)
+    value_t a = root_set.values[0] = gc_new_int8array(5, 200);
+    value_t b = root_set.values[1] = gc_new_int16array(3, -2);
+    value_t c = root_set.values[2] = gc_new_uint16array(9, 70000);
+    value_t d = root_set.values[3] = gc_new_uint32array(2, 7);
+    Assert_equals(value_to_ptr(a)->body[0], 3);
+    Assert_equals(value_to_ptr(c)->body[0], 6);
+    Assert_equals(get_all_array_length(a), 5);
+    Assert_equals(get_all_array_length(c), 9);
+    Assert_equals(*gc_int8array_get(a, 4), -56);
+    Assert_equals(*gc_int16array_get(b, 2), -2);
+    Assert_equals(*gc_uint16array_get(c, 8), 70000 - 65536);
+    Assert_equals(*gc_uint32array_get(d, 1), 7);
+
+    *gc_int8array_get(a, 0) = 127;
+    *gc_int8array_get(a, 0) += 1;
+    Assert_equals(*gc_int8array_get(a, 0), -128);
+    Assert_equals(value_to_int(gc_safe_array_set(b, 1, int_to_value(40000))), 40000 - 65536);
+    Assert_equals(value_to_int(gc_safe_array_get(b, 1)), 40000 - 65536);
+    gc_safe_array_set(c, 3, int_to_value(-1));
+    Assert_equals(value_to_int(gc_safe_array_get(c, 3)), 65535);
+    Assert_equals(*gc_uint16array_elem(c, gc_uint16array_base(c), 9, 3), 65535);
+    *gc_uint32array_get(d, 0) = -1;
+    Assert_equals(*(uint32_t*)gc_uint32array_base(d), 0xffffffff);
+    Assert_equals(value_to_int(gc_safe_array_get(d, 1)), 7);
+    Assert_equals(value_to_int(get_anyobj_length_property(d, 0)), 2);
+
+    Assert_true(gc_is_instance_of(&class_Int16Array.clazz, b));
+    Assert_true(!gc_is_instance_of(&class_Uint16Array.clazz, b));
+    const char* sig = "'Uint32Array'";
+    Assert_true(is_subtype_of(d, &sig));
+
+    test_array_var = b;
+    Assert_true(try_and_catch(test_compact_arrays2));
+    DELETE_ROOT_SET(root_set)
+}
+
+static int32_t test_method_a(value_t self) { return 10; }
+static int32_t test_method_b(value_t self) { return 20; }
+static int32_t test_method_c(value_t self) { return 30; }
+
+static CLASS_OBJECT(test_class_base, 2) = {
+    .body = { .s = 2, .i = 1, .cn = "Base", .sc = &object_class.clazz, .an = NULL,
+              .pt = { .size = 2, .offset = 0, .unboxed = 1, .prop_names = (const uint16_t[]){ 31, 12 }, .unboxed_types = "i",
+                      .all_size = 2, .all_props = (const struct property_entry[]){ { 12, 1, ' ' }, { 31, 0, 'i' } } },
+              .mt = { .size = 2, .names = (const uint16_t[]){ 40, 21 }, .signatures = (const char* const[]){ "()i", "()i" },
+                      .sorted = (const uint16_t[]){ 1, 0 } },
+              .vtbl = { test_method_a, test_method_b } }};
+
+static CLASS_OBJECT(test_class_derived, 3) = {
+    .body = { .s = 4, .i = 1, .cn = "Derived", .sc = &test_class_base.clazz, .an = NULL,
+              .pt = { .size = 2, .offset = 2, .unboxed = 1, .prop_names = (const uint16_t[]){ 50, 9 }, .unboxed_types = "",
+                      .all_size = 4, .all_props = (const struct property_entry[]){ { 9, 3, ' ' }, { 12, 1, ' ' }, { 31, 0, 'i' }, { 50, 2, ' ' } } },
+              .mt = { .size = 3, .names = (const uint16_t[]){ 40, 21, 33 }, .signatures = (const char* const[]){ "()i", "()i", "()i" },
+                      .sorted = (const uint16_t[]){ 1, 2, 0 } },
+              .vtbl = { test_method_a, test_method_c, test_method_b } }};
+
+void test_sorted_tables() {
+    ROOT_SET(root_set, 1)
+    value_t obj = root_set.values[0] = gc_new_object(&test_class_derived.clazz);
+    *get_obj_int_property(obj, 0) = 7;
+    set_anyobj_property(obj, 50, int_to_value(8));
+    set_anyobj_property(obj, 9, int_to_value(9));
+    set_anyobj_property(obj, 12, int_to_value(10));
+    Assert_equals(get_anyobj_property(obj, 31), int_to_value(7));
+    Assert_equals(get_obj_property(obj, 2), int_to_value(8));
+    Assert_equals(get_obj_property(obj, 3), int_to_value(9));
+    Assert_equals(get_anyobj_property(obj, 12), int_to_value(10));
+
+    Assert_equals(gc_dynamic_method_call(obj, 40, 0), int_to_value(10));
+    Assert_equals(gc_dynamic_method_call(obj, 21, 0), int_to_value(30));
+    Assert_equals(gc_dynamic_method_call(obj, 33, 0), int_to_value(20));
+    DELETE_ROOT_SET(root_set)
+}
+
+static value_t test_no_such_property_obj;
+
+void test_no_such_property2() {
+    get_anyobj_property(test_no_such_property_obj, 13);
+}
+
+void test_no_such_property() {
+    test_no_such_property_obj = gc_new_object(&test_class_derived.clazz);
+    Assert_true(try_and_catch(test_no_such_property2));
+}
+
 void test_runtime_error2() {
     runtime_error("test_runtime_error2() thorws an error");
 }
@@ -410,13 +1246,32 @@ int main() {
     test_minus_any_value();
     test_safe_value_to();
     test_array();
+    test_hoisted_array_elem();
+    test_bulk_operations();
+    test_growable_array();
+    test_compact_arrays();
+    test_readonly_array();
+    test_hash_tables();
+    test_array_sort();
     test_string_literal();
+    test_static_string();
+    test_static_string2();
+    test_string_equality();
+    test_string_rope();
+    test_string_slice();
+    test_bytes_of();
+    test_string_builder();
+    test_number_to_string();
     test_function_object();
     test_is_subtype_of();
     test_array_push();
     test_array_pop();
     test_array_unshift();
     test_array_shift();
+    test_array_queue();
+    test_array_growth();
+    test_sorted_tables();
+    test_no_such_property();
     test_runtime_error();
     if (nerrors > 0) {
         printf("Test failed %d\n", nerrors);
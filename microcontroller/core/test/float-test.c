@@ -87,6 +87,99 @@ void test(float f) {
 }
 
 
+// The reference codec.  float_to_value() and value_to_float() must be
+// bit-exactly equivalent to these functions, which scale a float by ENCODE_MULT.
+value_t reference_float_to_value(float f) {
+    if (isnan(f))
+        return 0x7F000000u | FLOAT_TAG;
+
+    float_or_uint v;
+    v.f = f * ENCODE_MULT.f;
+    if ((v.u & 0x60000000u) || (v.u | 0xE07FFFFFu) == 0xFFFFFFFFu)
+        return (v.u & 0x80000000u) | 0x7E000000u | FLOAT_TAG;
+    else
+        return (v.u & 0x80000000u) | ((v.u & 0x1FFFFFFF) << 2) | FLOAT_TAG;
+}
+
+float reference_value_to_float(value_t v) {
+    if ((v | ~0x7E000000) == 0xFFFFFFFF) {
+        float_or_uint f;
+        f.u = (v & 0x80000000u) | 0x7F800000u | ((v & 0x01FFFFFC) >> 2);
+        return f.f;
+    } else {
+        float_or_uint f = { (v & 0x80000000u) | ((v & 0x7FFFFFFCu) >> 2) };
+        return f.f / ENCODE_MULT.f;
+    }
+}
+
+// compares the codec with the reference.  Every 61th bit pattern is tested.
+// To test all the bit patterns, compile with -DEXHAUSTIVE -O2.
+void test_bit_exactness() {
+#ifdef EXHAUSTIVE
+    uint64_t step = 1;
+#else
+    uint64_t step = 61;
+#endif
+    for (uint64_t i = 0; i < 0x100000000u; i += step) {
+        float_or_uint f = { (uint32_t)i };
+        value_t v = float_to_value(f.f);
+        if (v != reference_float_to_value(f.f)) {
+            printf("float_to_value: 0x%08x  -->  0x%08x\n", f.u, v);
+            exit(1);
+        }
+
+        if ((i & 3) == 1) {
+            float_or_uint g, h;
+            g.f = value_to_float((value_t)i);
+            h.f = reference_value_to_float((value_t)i);
+            if (g.u != h.u && !(isnan(g.f) && isnan(h.f))) {
+                printf("value_to_float: 0x%08x  -->  0x%08x\n", (uint32_t)i, g.u);
+                exit(1);
+            }
+        }
+    }
+}
+
+// compares the bulk conversion with the element-wise one.
+void test_bulk_conversion() {
+    const int32_t n = 1000;
+    float_or_uint src[1000];
+    value_t values[1000];
+    float floats[1000];
+    for (int32_t i = 0; i < n; i++)
+        src[i].u = (uint32_t)(((uint64_t)i << 32) / n) + 519u;
+
+    for (int32_t k = 0; k < 2; k++) {
+        // the second time, every float is a normal number.
+        if (k == 1)
+            for (int32_t i = 0; i < n; i++)
+                src[i].f = (i - n / 2) * 0.37f;
+
+        floats_to_values(values, &src[0].f, n);
+        for (int32_t i = 0; i < n; i++)
+            if (values[i] != float_to_value(src[i].f)) {
+                printf("floats_to_values: 0x%08x  -->  0x%08x\n", src[i].u, values[i]);
+                exit(1);
+            }
+
+        values_to_floats(floats, values, n);
+        for (int32_t i = 0; i < n; i++) {
+            float_or_uint g = { .f = floats[i] }, h = { .f = value_to_float(values[i]) };
+            if (g.u != h.u && !(isnan(g.f) && isnan(h.f))) {
+                printf("values_to_floats: 0x%08x  -->  0x%08x\n", values[i], g.u);
+                exit(1);
+            }
+        }
+    }
+
+    values[0] = int_to_value(-3);
+    values_to_floats(floats, values, 1);
+    if (floats[0] != -3.0f) {
+        printf("values_to_floats: an integer is not converted\n");
+        exit(1);
+    }
+}
+
 int main() {
     printf("normal numbers\n");
     test(1.0);
@@ -174,5 +267,10 @@ int main() {
     }
     printf("random test: pass\n");
 
+    printf("bit-exactness test\n");
+    test_bit_exactness();
+    test_bulk_conversion();
+    printf("bit-exactness test: pass\n");
+
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,97 @@
+// Throughput of number-to-string conversion in c-runtime.c
+// compared with snprintf().
+// To compile,
+// cc -O2 -DLINUX64 number-to-string-bench.c -lm
+
+#include <stdio.h>
+#include <time.h>
+#include "../src/c-runtime.c"
+
+#define N   2000000
+
+static double now() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static int32_t ints[N];
+static float floats[N];
+
+static void report(const char* name, double t0, double t1, size_t total) {
+    printf("%-24s %8.1f ns/number  (%zu chars)\n", name, (t1 - t0) * 1e9 / N, total);
+}
+
+int main() {
+    uint32_t seed = 1;
+    for (int i = 0; i < N; i++) {
+        seed = seed * 1103515245 + 12345;
+        ints[i] = (int32_t)seed >> (seed % 31);
+        floats[i] = value_to_float(float_to_value((float)(int32_t)seed / (float)(1 << (seed % 24))));
+    }
+
+    char buf[NUMBER_STRING_SIZE];
+    size_t total;
+    double t0, t1;
+
+    total = 0;
+    t0 = now();
+    for (int i = 0; i < N; i++)
+        total += snprintf(buf, sizeof(buf), "%d", ints[i]);
+    t1 = now();
+    report("snprintf(\"%d\")", t0, t1, total);
+
+    total = 0;
+    t0 = now();
+    for (int i = 0; i < N; i++)
+        total += gc_int_to_cstring(buf, ints[i]) - buf;
+    t1 = now();
+    report("gc_int_to_cstring", t0, t1, total);
+
+    total = 0;
+    t0 = now();
+    for (int i = 0; i < N; i++)
+        total += snprintf(buf, sizeof(buf), "%f", floats[i]);
+    t1 = now();
+    report("snprintf(\"%f\")", t0, t1, total);
+
+    total = 0;
+    t0 = now();
+    for (int i = 0; i < N; i++)
+        total += gc_float_to_fixed_cstring(buf, floats[i]) - buf;
+    t1 = now();
+    report("gc_float_to_fixed_cstring", t0, t1, total);
+
+    total = 0;
+    t0 = now();
+    for (int i = 0; i < N; i++)
+        total += snprintf(buf, sizeof(buf), "%.9g", floats[i]);
+    t1 = now();
+    report("snprintf(\"%.9g\")", t0, t1, total);
+
+    total = 0;
+    t0 = now();
+    for (int i = 0; i < N; i++)
+        total += gc_float_to_cstring(buf, floats[i]) - buf;
+    t1 = now();
+    report("gc_float_to_cstring", t0, t1, total);
+
+    // string concatenation such as "x" + i
+    gc_initialize();
+    value_t x = gc_new_string("x");
+    ROOT_SET(rootset, 1)
+    rootset.values[0] = x;
+    t0 = now();
+    for (int i = 0; i < N; i++)
+        gc_new_String(x, int_to_value(ints[i] >> 2));
+    t1 = now();
+    report("\"x\" + integer", t0, t1, 0);
+
+    t0 = now();
+    for (int i = 0; i < N; i++)
+        gc_new_String(x, float_to_value(floats[i]));
+    t1 = now();
+    report("\"x\" + float", t0, t1, 0);
+    DELETE_ROOT_SET(rootset)
+    return 0;
+}
@@ -81,27 +81,238 @@ static void test_converter() {
     Assert_str_equals(result_str_func, "Function");
 }
 
+// writes a profile record and converts it into a string.
+static const char* profile_to_str(bs_type_profile* profile, typeint_t* row) {
+    uint8_t buffer[BS_PROFILER_BATCH_SIZE];
+    Assert_true(write_profile_record(7, profile, row));
+    uint32_t len = bs_profiler_read(buffer, sizeof(buffer));
+    for (uint32_t i = 0; i < len; i += record_size(buffer + i))
+        if (buffer[i] == PROFILE_RECORD) {
+            Assert_true(buffer[i + 1] == 7 && i + record_size(buffer + i) == len);
+            return record_to_str(buffer + i);
+        }
+
+    return "";
+}
+
 void test_type_counter() {
-    value_t p1_1 = int_to_value(3);
-    value_t p2_1 = gc_new_string("test");
-    value_t p1_2 = float_to_value(1.2);
-    value_t p2_2 = float_to_value(3.4);
-    typeint_t* type_profile = malloc(TYPE_PROFILE_SIZE);
-    for (int i = 0; i < TYPE_COUNT_THRESHOLD - 2; i++) {
-        get_row_on_threshold(0, type_profile, p1_1, p2_1, VALUE_UNDEF, VALUE_UNDEF);
+    value_t params1[] = { int_to_value(3), gc_new_string("test") };
+    value_t params2[] = { float_to_value(1.2), float_to_value(3.4) };
+    uint16_t call_count = 0;
+    bs_type_profile* type_profile = NULL;
+    type_profile = new_type_profile(&type_profile, &call_count, 2);
+    for (int i = 0; i < config.type_threshold - 1; i++) {
+        typeint_t* r = record_param_types(type_profile, params1);
+        Assert_true(!row_is_dominant(type_profile, r));
+    }
+    typeint_t* r2 = record_param_types(type_profile, params2);
+    Assert_true(r2 != NULL && !row_is_dominant(type_profile, r2));
+    typeint_t* r3 = record_param_types(type_profile, params1);
+    Assert_true(r3 != NULL && row_is_dominant(type_profile, r3));
+    Assert_str_equals(profile_to_str(type_profile, r3), "integer, string");
+    free_type_profile(type_profile);
+}
+
+void test_return_type() {
+    value_t params[] = { int_to_value(3) };
+    uint16_t call_count = 0;
+    bs_type_profile* type_profile = NULL;
+    type_profile = new_type_profile(&type_profile, &call_count, 1);
+    typeint_t* r = record_param_types(type_profile, params);
+    Assert_str_equals(profile_to_str(type_profile, r), "integer");
+    bs_profiler_profile_return(&type_profile, float_to_value(1.5));
+    Assert_str_equals(profile_to_str(type_profile, r), "integer -> float");
+    bs_profiler_profile_return(&type_profile, float_to_value(2.5));
+    Assert_str_equals(profile_to_str(type_profile, r), "integer -> float");
+    bs_profiler_profile_return(&type_profile, gc_new_string("test"));
+    Assert_str_equals(profile_to_str(type_profile, r), "integer -> any");
+    free_type_profile(type_profile);
+}
+
+void test_megamorphic() {
+    value_t params[] = { int_to_value(0), VALUE_UNDEF };
+    uint16_t call_count = 0;
+    bs_type_profile* type_profile = NULL;
+    type_profile = new_type_profile(&type_profile, &call_count, 2);
+    Assert_true(type_profile->capacity == BS_PROFILER_MAX_ROWS);
+    typeint_t* r = NULL;
+
+    // the table overflows.
+    value_t types[] = { int_to_value(1), float_to_value(1.0), VALUE_TRUE, VALUE_UNDEF, gc_new_string("test"),
+                        gc_new_intarray(1, 0), gc_new_floatarray(1, 0.0), gc_new_array(NULL, 1, VALUE_UNDEF),
+                        gc_new_bytearray(false, 1, 0) };
+    for (int i = 0; i < BS_PROFILER_MAX_ROWS; i++) {
+        params[0] = types[i];
+        r = record_param_types(type_profile, params);
+        Assert_true(r != NULL && !is_megamorphic(type_profile, r));
     }
-    typeint_t* r1 = get_row_on_threshold(0, type_profile, p1_1, p2_1, VALUE_UNDEF, VALUE_UNDEF);
-    Assert_true(r1 == NULL);
-    typeint_t* r2 = get_row_on_threshold(0, type_profile, p1_2, p2_2, VALUE_UNDEF, VALUE_UNDEF);
-    Assert_true(r1 == NULL);
-    typeint_t* r3 = get_row_on_threshold(0, type_profile, p1_1, p2_1, VALUE_UNDEF, VALUE_UNDEF);
-    Assert_true(r3 != NULL);
-    Assert_str_equals(row_to_str(r3), "integer, string, undefined, undefined");
+    params[0] = types[BS_PROFILER_MAX_ROWS];
+    r = record_param_types(type_profile, params);
+    Assert_true(r == NULL && is_megamorphic(type_profile, r));
+    free_type_profile(type_profile);
+
+    // no row is dominant.
+    type_profile = new_type_profile(&type_profile, &call_count, 1);
+    for (int i = 0; i < config.max_samples; i++) {
+        params[0] = i % 2 == 0 ? int_to_value(i) : float_to_value(i);
+        r = record_param_types(type_profile, params);
+        Assert_true(!row_is_dominant(type_profile, r));
+    }
+    Assert_true(is_megamorphic(type_profile, r));
+    free_type_profile(type_profile);
+}
+
+void test_records() {
+    bs_profiler_reset();
+    value_t params[] = { gc_new_string("test"), int_to_value(1) };
+    uint16_t call_count = 0;
+    bs_type_profile* type_profile = NULL;
+    type_profile = new_type_profile(&type_profile, &call_count, 2);
+    typeint_t* r = record_param_types(type_profile, params);
+    bs_profiler_profile_return(&type_profile, params[0]);
+    Assert_true(write_profile_record(3, type_profile, r));
+    Assert_true(write_profile_record(4, type_profile, NULL));
+
+    uint8_t buffer[BS_PROFILER_BATCH_SIZE];
+    uint8_t expected[] = { CLASS_RECORD, FIRST_CLASS_ID, 6, 's', 't', 'r', 'i', 'n', 'g',
+                           PROFILE_RECORD, 3, 2, RECORD_RETURN, FIRST_CLASS_ID, 0, FIRST_CLASS_ID,
+                           PROFILE_RECORD, 4, 0, RECORD_MEGAMORPHIC };
+    Assert_true(bs_profiler_read(buffer, sizeof(buffer)) == sizeof(expected));
+    Assert_true(memcmp(buffer, expected, sizeof(expected)) == 0);
+    Assert_str_equals(record_to_str(buffer + 9), "string, integer -> string");
+    Assert_str_equals(record_to_str(buffer + 16), "megamorphic");
+    Assert_true(bs_profiler_read(buffer, sizeof(buffer)) == 0);
+
+    // when the buffer is full, no record is written.
+    int written = 0;
+    while (write_profile_record(5, type_profile, r))
+        written++;
+
+    Assert_true(written == BS_PROFILER_BUFFER_SIZE / 7 && records_free() < 7);
+
+    // whole records are read.
+    uint32_t len = bs_profiler_read(buffer, 10);
+    Assert_true(len == 7 && buffer[0] == PROFILE_RECORD && buffer[1] == 5);
+    Assert_true(write_profile_record(6, type_profile, r));
+    uint32_t total = len;
+    while ((len = bs_profiler_read(buffer, sizeof(buffer))) > 0)
+        total += len;
+
+    Assert_true(total == (written + 1) * 7);
+    free_type_profile(type_profile);
+    bs_profiler_reset();
+}
+
+void test_arena() {
+    bs_profiler_reset();
+    uint32_t dropped = bs_profiler_dropped();
+    uint16_t counts[BS_PROFILER_MAX_PROFILES + 1];
+    bs_type_profile* profiles[BS_PROFILER_MAX_PROFILES + 1];
+    value_t params[] = { int_to_value(1) };
+    for (int i = 0; i < BS_PROFILER_MAX_PROFILES; i++) {
+        counts[i] = 5;
+        profiles[i] = new_type_profile(&profiles[i], &counts[i], 1);
+        Assert_true(profiles[i] != NULL);
+        record_param_types(profiles[i], params);
+    }
+
+    // the arena is full.
+    profiles[BS_PROFILER_MAX_PROFILES] = new_type_profile(&profiles[BS_PROFILER_MAX_PROFILES], &counts[BS_PROFILER_MAX_PROFILES], 1);
+    Assert_true(profiles[BS_PROFILER_MAX_PROFILES] == NULL && bs_profiler_dropped() == dropped + 1);
+
+    // the least recently used profile is recycled.
+    for (int k = 0; k < config.max_samples; k++)
+        for (int i = 1; i < BS_PROFILER_MAX_PROFILES; i++)
+            record_param_types(profiles[i], params);
+
+    bs_type_profile* p0 = profiles[0];
+    profiles[BS_PROFILER_MAX_PROFILES] = new_type_profile(&profiles[BS_PROFILER_MAX_PROFILES], &counts[BS_PROFILER_MAX_PROFILES], 1);
+    Assert_true(profiles[BS_PROFILER_MAX_PROFILES] == p0 && profiles[0] == NULL && counts[0] == 0);
+    Assert_true(p0->samples == 0 && row_is_empty(get_row(p0, 0)));
+    Assert_true(bs_profiler_dropped() == dropped + 1);
+
+    // a freed slot is reused.
+    bs_type_profile* p1 = profiles[1];
+    free_type_profile(p1);
+    bs_type_profile* p2 = NULL;
+    Assert_true(new_type_profile(&p2, &counts[0], 1) == p1);
+    bs_profiler_reset();
+}
+
+void test_hits() {
+    bs_profiler_reset();
+    uint16_t hits = 0;
+    for (int i = 1; i < BS_PROFILER_HITS_INTERVAL; i++)
+        bs_profiler_count_hits(7, 2, &hits);
+
+    Assert_true(hits == BS_PROFILER_HITS_INTERVAL - 1 && records_head == records_tail);
+
+    // fill the buffer so that the hits record is not written.
+    bs_type_profile* type_profile = NULL;
+    uint16_t call_count = 0;
+    value_t params[] = { int_to_value(1) };
+    type_profile = new_type_profile(&type_profile, &call_count, 1);
+    typeint_t* r = record_param_types(type_profile, params);
+    while (write_profile_record(5, type_profile, r))
+        ;
+
+    uint32_t used = records_head - records_tail;
+    while (records_free() >= HITS_RECORD_SIZE)
+        put_record_byte(PROFILE_RECORD);    // padding.  It is never read.
+
+    bs_profiler_count_hits(7, 2, &hits);
+    Assert_true(hits == BS_PROFILER_HITS_INTERVAL);
+
+    records_head = records_tail + used;
+    uint8_t buffer[BS_PROFILER_BATCH_SIZE];
+    while (bs_profiler_read(buffer, sizeof(buffer)) > 0)
+        ;
+
+    // the record is written and then read by flush_records().
+    uint32_t head = records_head;
+    bs_profiler_count_hits(7, 2, &hits);
+    Assert_true(hits == 0 && records_head == head + HITS_RECORD_SIZE && records_tail == records_head);
+    uint8_t expected[] = { HITS_RECORD, 7, 2, (BS_PROFILER_HITS_INTERVAL + 1) & 0xff, (BS_PROFILER_HITS_INTERVAL + 1) >> 8 };
+    for (int i = 0; i < HITS_RECORD_SIZE; i++)
+        Assert_true(records[(head + i) & (BS_PROFILER_BUFFER_SIZE - 1)] == expected[i]);
+    free_type_profile(type_profile);
+    bs_profiler_reset();
+}
+
+void test_profile() {
+    bs_profiler_config c = { .call_threshold = 2, .type_threshold = 3, .max_samples = 10, .dominance = 90, .rows = 2 };
+    bs_profiler_configure(&c);
+    uint16_t call_count = 0;
+    bs_type_profile* type_profile = NULL;
+    value_t params[] = { int_to_value(1), int_to_value(2) };
+    for (int i = 0; i < 2; i++) {
+        bs_profiler_profile(0, &call_count, &type_profile, 2, params);
+        Assert_true(type_profile == NULL);
+    }
+    bs_profiler_profile(0, &call_count, &type_profile, 2, params);
+    Assert_true(type_profile != NULL && type_profile->capacity == 2);
+    bs_profiler_profile(0, &call_count, &type_profile, 2, params);
+    Assert_true(type_profile != NULL);
+    bs_profiler_profile(0, &call_count, &type_profile, 2, params);      // prints "integer, integer"
+    Assert_true(type_profile == NULL && call_count == PROFILE_DONE);
+    bs_profiler_profile(0, &call_count, &type_profile, 2, params);
+    Assert_true(type_profile == NULL && call_count == PROFILE_DONE);
+
+    c.rows = 0;
+    c.type_threshold = 0;
+    bs_profiler_configure(&c);
+    Assert_true(config.rows == BS_PROFILER_MAX_ROWS && config.type_threshold == 1 && config.max_samples == 10);
 }
 
 int main() {
     gc_initialize();
     test_converter();
     test_type_counter();
+    test_return_type();
+    test_megamorphic();
+    test_records();
+    test_arena();
+    test_hits();
+    test_profile();
     puts("done");
 }
\ No newline at end of file
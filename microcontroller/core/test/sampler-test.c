@@ -0,0 +1,109 @@
+// Test code
+// To cmpile,
+// cc sampler-test.c
+
+#include <stdio.h>
+#include <stdbool.h>
+
+#define BS_SAMPLER_BUFFER_SIZE  8
+#include "../src/sampler.c"
+
+#define Assert_true(v)     assert_true(v, __LINE__)
+
+static void assert_true(bool value, int line) {
+    if (!value)
+        printf("*** ERROR line %d\n", line);
+}
+
+#define Assert_equals(a, b)     assert_equals(a, b, __LINE__)
+
+static void assert_equals(uint64_t a, uint64_t b, int line) {
+    if (a != b)
+        printf("*** ERROR line %d: %llu, %llu\n", line, (unsigned long long)a, (unsigned long long)b);
+}
+
+static void test_record_and_read() {
+    uintptr_t buffer[BS_SAMPLER_BUFFER_SIZE];
+    bs_sampler_reset();
+    Assert_equals(bs_sampler_read(buffer, BS_SAMPLER_BUFFER_SIZE), 0);
+
+    bs_sampler_record(100);
+    bs_sampler_record(101);
+    bs_sampler_record(102);
+    Assert_equals(bs_sampler_read(buffer, 2), 2);
+    Assert_equals(buffer[0], 100);
+    Assert_equals(buffer[1], 101);
+    Assert_equals(bs_sampler_read(buffer, BS_SAMPLER_BUFFER_SIZE), 1);
+    Assert_equals(buffer[0], 102);
+    Assert_equals(bs_sampler_read(buffer, BS_SAMPLER_BUFFER_SIZE), 0);
+    Assert_equals(bs_sampler_dropped(), 0);
+}
+
+// the indexes go around the buffer several times.
+static void test_wraparound() {
+    uintptr_t buffer[BS_SAMPLER_BUFFER_SIZE];
+    bs_sampler_reset();
+    uintptr_t pc = 0;
+    for (int i = 0; i < BS_SAMPLER_BUFFER_SIZE * 3; i++) {
+        for (int k = 0; k < 5; k++)
+            bs_sampler_record(pc + k);
+
+        Assert_equals(bs_sampler_read(buffer, BS_SAMPLER_BUFFER_SIZE), 5);
+        for (int k = 0; k < 5; k++)
+            Assert_equals(buffer[k], pc + k);
+
+        pc += 5;
+    }
+
+    Assert_true(sampler_head > BS_SAMPLER_BUFFER_SIZE * 2);
+    Assert_equals(bs_sampler_dropped(), 0);
+
+    // the 32bit indexes overflow.
+    sampler_head = sampler_tail = 0xfffffffe;
+    for (int k = 0; k < BS_SAMPLER_BUFFER_SIZE; k++)
+        bs_sampler_record(200 + k);
+
+    Assert_equals(sampler_head, BS_SAMPLER_BUFFER_SIZE - 2);
+    bs_sampler_record(300);
+    Assert_equals(bs_sampler_dropped(), 1);
+    Assert_equals(bs_sampler_read(buffer, BS_SAMPLER_BUFFER_SIZE), BS_SAMPLER_BUFFER_SIZE);
+    for (int k = 0; k < BS_SAMPLER_BUFFER_SIZE; k++)
+        Assert_equals(buffer[k], 200 + k);
+}
+
+// the samples recorded when the buffer is full are dropped.
+static void test_overflow() {
+    uintptr_t buffer[BS_SAMPLER_BUFFER_SIZE];
+    bs_sampler_reset();
+    for (int k = 0; k < BS_SAMPLER_BUFFER_SIZE + 3; k++)
+        bs_sampler_record(k);
+
+    Assert_equals(bs_sampler_dropped(), 3);
+    Assert_equals(bs_sampler_read(buffer, 4), 4);
+    Assert_equals(buffer[3], 3);
+
+    // there is room for 4 samples.
+    for (int k = 0; k < 6; k++)
+        bs_sampler_record(100 + k);
+
+    Assert_equals(bs_sampler_dropped(), 5);
+    Assert_equals(bs_sampler_read(buffer, BS_SAMPLER_BUFFER_SIZE), BS_SAMPLER_BUFFER_SIZE);
+    Assert_equals(buffer[0], 4);
+    Assert_equals(buffer[3], 7);
+    Assert_equals(buffer[4], 100);
+    Assert_equals(buffer[7], 103);
+    Assert_equals(bs_sampler_read(buffer, BS_SAMPLER_BUFFER_SIZE), 0);
+
+    bs_sampler_reset();
+    Assert_equals(bs_sampler_dropped(), 0);
+    bs_sampler_record(9);
+    Assert_equals(bs_sampler_read(buffer, BS_SAMPLER_BUFFER_SIZE), 1);
+    Assert_equals(buffer[0], 9);
+}
+
+int main() {
+    test_record_and_read();
+    test_wraparound();
+    test_overflow();
+    puts("done");
+}
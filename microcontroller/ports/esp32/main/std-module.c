@@ -18,9 +18,9 @@ void clear_buff() {
 
 void write_message_to_buff(value_t message) {
     if (is_int_value(message)) 
-        sprintf(buff, "%d\n", (int) value_to_int(message));
+        strcpy(gc_int_to_cstring(buff, value_to_int(message)), "\n");
     else if (is_float_value(message))
-        sprintf(buff, "%f\n", value_to_float(message));
+        strcpy(gc_float_to_fixed_cstring(buff, value_to_float(message)), "\n");
     else if (message == VALUE_NULL || message == VALUE_UNDEF)
         sprintf(buff, "undefined\n");
     else if (message == VALUE_TRUE)
@@ -45,13 +45,13 @@ float PORT_TEXT_SECTION mth_0_Time(value_t self);
 void PORT_TEXT_SECTION mth_1_Time(value_t self, int32_t _ms);
 extern CLASS_OBJECT(object_class, 1);
 ROOT_SET_DECL(global_rootset0, 2);
-static const uint16_t mnames_Console[] = { 8, 9, };
+static const uint16_t mnames_Console[] = { 26, 27, };
 static const char* const msigs_Console[] = { "(s)v", "(s)v", };
 static const uint16_t plist_Console[] = {  };
 PORT_DATA_SECTION CLASS_OBJECT(class_Console, 2) = {
     .body = { .s = 0, .i = 0, .cn = "Console", .sc = &object_class.clazz , .an = (void*)0, .pt = { .size = 0, .offset = 0,
     .unboxed = 0, .prop_names = plist_Console, .unboxed_types = "" }, .mt = { .size = 2, .names = mnames_Console, .signatures = msigs_Console }, .vtbl = { mth_0_Console, mth_1_Console,  }}};
-static const uint16_t mnames_Time[] = { 10, 11, };
+static const uint16_t mnames_Time[] = { 28, 29, };
 static const char* const msigs_Time[] = { "()f", "(i)v", };
 static const uint16_t plist_Time[] = {  };
 PORT_DATA_SECTION CLASS_OBJECT(class_Time, 2) = {
@@ -35,6 +35,11 @@ void bs_comm_send_loadtime(float time) {
     comm_send(H_PROTOCOL_LOADTIME, timestr);
 }
 
+// samples is "name:count,name:count,...".
+void bs_comm_send_samples(char* samples) {
+    comm_send(H_PROTOCOL_SAMPLES, samples);
+}
+
 static void parse_line(char* line, host_protocol_t* protocol, char* payload) {
     char protocol_char[PROTO_SIZE];
     protocol_char[0] = line[0];
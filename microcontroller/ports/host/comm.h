@@ -18,6 +18,7 @@ typedef enum {
     H_PROTOCOL_ERROR = 4,
     H_PROTOCOL_EXECTIME = 5,
     H_PROTOCOL_LOADTIME = 6,
+    H_PROTOCOL_SAMPLES = 7,
 
     H_PROTOCOL_MAX
 } host_protocol_t;
@@ -26,6 +27,7 @@ void bs_comm_send_log(char* message);
 void bs_comm_send_error(char* message);
 void bs_comm_send_exectime(float time);
 void bs_comm_send_loadtime(float time);
+void bs_comm_send_samples(char* samples);
 char* bs_comm_wait_receive(void (*on_load)(char* filename), void (*on_call)(char* funcname));
 
 
@@ -1,5 +1,9 @@
 // Copyright (C) 2024- Shigeru Chiba.  All rights reserved.
 
+#ifdef __linux__
+#define _GNU_SOURCE     // for REG_RIP
+#endif
+
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
@@ -9,6 +13,9 @@
 #ifndef _WIN32
 #include <dlfcn.h>
 #include <time.h>
+#include <signal.h>
+#include <sys/time.h>
+#include "../../core/include/sampler.h"
 #else
 #include <windows.h>
 #include <io.h>
@@ -42,6 +49,123 @@ static float get_time_ms() {
 #endif
 }
 
+#ifndef _WIN32
+
+/*
+  Sampling profiler.  When the environment variable BS_SAMPLING_INTERVAL is set to
+  a sampling interval in microseconds, SIGPROF interrupts the program and the program
+  counter is recorded.  After each call, the samples are sent as "name:count,..."
+  where name is the name of the function found by dladdr().  "(other functions)" counts
+  the samples in the functions found after MAX_SAMPLED_FUNCTIONS functions, and
+  "(dropped)" counts the samples lost since the ring buffer was full.
+*/
+
+#define MAX_SAMPLED_FUNCTIONS   256
+
+static long sampling_interval = 0;      // 0 if sampling is off
+
+static void on_sigprof(int sig, siginfo_t* info, void* context) {
+    ucontext_t* uc = (ucontext_t*)context;
+#if defined(__linux__) && defined(__x86_64__)
+    bs_sampler_record((uintptr_t)uc->uc_mcontext.gregs[REG_RIP]);
+#elif defined(__linux__) && defined(__aarch64__)
+    bs_sampler_record((uintptr_t)uc->uc_mcontext.pc);
+#elif defined(__APPLE__) && defined(__x86_64__)
+    bs_sampler_record((uintptr_t)uc->uc_mcontext->__ss.__rip);
+#elif defined(__APPLE__) && defined(__aarch64__)
+    bs_sampler_record((uintptr_t)uc->uc_mcontext->__ss.__pc);
+#endif
+}
+
+static void init_sampling() {
+    char* interval = getenv("BS_SAMPLING_INTERVAL");
+    if (interval == NULL || (sampling_interval = atol(interval)) <= 0)
+        return;
+
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_sigaction = on_sigprof;
+    action.sa_flags = SA_SIGINFO | SA_RESTART;
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGPROF, &action, NULL);
+}
+
+static void set_sampling_timer(long interval) {
+    struct itimerval timer;
+    timer.it_interval.tv_sec = timer.it_value.tv_sec = interval / 1000000;
+    timer.it_interval.tv_usec = timer.it_value.tv_usec = interval % 1000000;
+    setitimer(ITIMER_PROF, &timer, NULL);
+}
+
+static void start_sampling() {
+    if (sampling_interval > 0)
+        set_sampling_timer(sampling_interval);
+}
+
+static void stop_sampling() {
+    if (sampling_interval <= 0)
+        return;
+
+    set_sampling_timer(0);
+    struct { const char* name; uint32_t count; } functions[MAX_SAMPLED_FUNCTIONS];
+    uint32_t num_functions = 0;
+    uint32_t others = 0;
+    uint32_t dropped = bs_sampler_dropped();
+    uintptr_t pcs[64];
+    uint32_t n;
+    while ((n = bs_sampler_read(pcs, sizeof(pcs) / sizeof(pcs[0]))) > 0)
+        for (uint32_t i = 0; i < n; i++) {
+            Dl_info info;
+            const char* name = dladdr((void*)pcs[i], &info) && info.dli_sname != NULL ? info.dli_sname : "??";
+            uint32_t k = 0;
+            while (k < num_functions && strcmp(functions[k].name, name) != 0)
+                k++;
+
+            if (k < num_functions)
+                functions[k].count++;
+            else if (num_functions < MAX_SAMPLED_FUNCTIONS) {
+                functions[num_functions].name = name;
+                functions[num_functions++].count = 1;
+            }
+            else
+                others++;
+        }
+
+    bs_sampler_reset();
+    char payload[MAX_PAYLOAD_SIZE];
+    int len = 0;
+    for (uint32_t k = 0; k < num_functions + 2; k++) {
+        char entry[MAX_PAYLOAD_SIZE];
+        if (k < num_functions)
+            snprintf(entry, sizeof(entry), "%.200s:%u", functions[k].name, (unsigned)functions[k].count);
+        else if (k == num_functions && others > 0)
+            snprintf(entry, sizeof(entry), "(other functions):%u", (unsigned)others);
+        else if (k == num_functions + 1 && dropped > 0)
+            snprintf(entry, sizeof(entry), "(dropped):%u", (unsigned)dropped);
+        else
+            continue;
+
+        int entry_len = strlen(entry);
+        if (len > 0 && len + 1 + entry_len >= MAX_PAYLOAD_SIZE) {
+            bs_comm_send_samples(payload);
+            len = 0;
+        }
+
+        len += snprintf(payload + len, sizeof(payload) - len, len == 0 ? "%s" : ",%s", entry);
+    }
+
+    if (len > 0)
+        bs_comm_send_samples(payload);
+}
+
+#else
+
+static void init_sampling() {}
+static void start_sampling() {}
+static void stop_sampling() {}
+
+#endif
+
 static void load(char* filename) {
     float start_time = get_time_ms();
 #ifndef _WIN32
@@ -73,7 +197,9 @@ static void call(char* funcname) {
         //return 1;
     } else {
         float start_time = get_time_ms();
+        start_sampling();
         int r2 = try_and_catch(fptr);
+        stop_sampling();
         bs_comm_send_exectime(get_time_ms() - start_time);
         //return r2;
     }
@@ -85,6 +211,7 @@ int main() {
     _setmode(_fileno(stdout), _O_BINARY);
 #endif
 
+    init_sampling();
     gc_initialize();
     bluescript_main0_();
 
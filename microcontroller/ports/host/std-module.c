@@ -21,10 +21,14 @@ void send_message(const char* format, ...) {
 
 void print_message(value_t m) { 
     static char buffer[256];
-    if (is_int_value(m))
-        send_message("%d\n", value_to_int(m));
-    else if (is_float_value(m))
-        send_message("%f\n", value_to_float(m));
+    if (is_int_value(m)) {
+        strcpy(gc_int_to_cstring(buffer, value_to_int(m)), "\n");
+        bs_comm_send_log(buffer);
+    }
+    else if (is_float_value(m)) {
+        strcpy(gc_float_to_fixed_cstring(buffer, value_to_float(m)), "\n");
+        bs_comm_send_log(buffer);
+    }
     else if (m == VALUE_NULL || m == VALUE_UNDEF)
         send_message("undefined\n");
     else if (m == VALUE_TRUE)
@@ -73,13 +77,13 @@ float mth_0_Time(value_t self);
 extern CLASS_OBJECT(object_class, 1);
 void bluescript_main0_();
 ROOT_SET_DECL(global_rootset0, 2);
-static const uint16_t mnames_Console[] = { 8, 9, };
+static const uint16_t mnames_Console[] = { 26, 27, };
 static const char* const msigs_Console[] = { "(a)v", "(a)v", };
 static const uint16_t plist_Console[] = {  };
 CLASS_OBJECT(class_Console, 2) = {
     .body = { .s = 0, .i = 0, .cn = "Console", .sc = &object_class.clazz , .an = (void*)0, .pt = { .size = 0, .offset = 0,
     .unboxed = 0, .prop_names = plist_Console, .unboxed_types = "" }, .mt = { .size = 2, .names = mnames_Console, .signatures = msigs_Console }, .vtbl = { mth_0_Console, mth_1_Console,  }}};
-static const uint16_t mnames_Time[] = { 10, };
+static const uint16_t mnames_Time[] = { 28, };
 static const char* const msigs_Time[] = { "()f", };
 static const uint16_t plist_Time[] = {  };
 CLASS_OBJECT(class_Time, 1) = {